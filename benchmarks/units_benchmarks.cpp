@@ -0,0 +1,376 @@
+/*
+Copyright (c) 2019,
+Lawrence Livermore National Security, LLC;
+See the top-level NOTICE for additional details. All rights reserved.
+SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#include "units/units.hpp"
+#include "xml/tinyxml2.h"
+
+#include <benchmark/benchmark.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace units;
+
+namespace {
+// the corpora used to drive the benchmarks, all loaded from the test files
+enum class corpus { ucum_codes, ucum_tests, udunits, fuzz };
+
+// the unit column of the example UCUM codes
+std::vector<std::string> loadUcumCodes()
+{
+    std::vector<std::string> codes;
+    std::ifstream file(BENCHMARK_FILE_FOLDER "/example_ucum_codes.csv");
+    std::string line;
+    while (std::getline(file, line)) {
+        auto c1 = line.find_first_of(',');
+        auto c2 = line.find_first_of(',', c1 + 1);
+        if (c1 != std::string::npos && c2 != std::string::npos) {
+            codes.push_back(line.substr(c1 + 1, c2 - c1 - 1));
+        }
+    }
+    return codes;
+}
+
+// all the unit strings in the UCUM functional tests
+std::vector<std::string> loadUcumTestUnits()
+{
+    std::vector<std::string> units;
+    tinyxml2::XMLDocument doc;
+    if (doc.LoadFile(BENCHMARK_FILE_FOLDER "/UcumFunctionalTests.xml") != tinyxml2::XML_SUCCESS) {
+        return units;
+    }
+    auto root = doc.FirstChildElement("ucumTests");
+    for (auto cs = root->FirstChildElement("validation")->FirstChildElement("case"); cs != nullptr;
+         cs = cs->NextSiblingElement("case")) {
+        units.emplace_back(cs->Attribute("unit"));
+    }
+    for (auto cs = root->FirstChildElement("conversion")->FirstChildElement("case"); cs != nullptr;
+         cs = cs->NextSiblingElement("case")) {
+        units.emplace_back(cs->Attribute("srcUnit"));
+        units.emplace_back(cs->Attribute("dstUnit"));
+    }
+    return units;
+}
+
+// the value and source unit of each UCUM conversion test as a measurement string
+std::vector<std::string> loadUcumMeasurements()
+{
+    std::vector<std::string> measurements;
+    tinyxml2::XMLDocument doc;
+    if (doc.LoadFile(BENCHMARK_FILE_FOLDER "/UcumFunctionalTests.xml") != tinyxml2::XML_SUCCESS) {
+        return measurements;
+    }
+    for (auto cs = doc.FirstChildElement("ucumTests")
+                       ->FirstChildElement("conversion")
+                       ->FirstChildElement("case");
+         cs != nullptr;
+         cs = cs->NextSiblingElement("case")) {
+        measurements.push_back(
+            std::string(cs->Attribute("value")) + ' ' + cs->Attribute("srcUnit"));
+    }
+    return measurements;
+}
+
+// the unit pairs of the UCUM conversion tests
+std::vector<std::pair<precise_unit, precise_unit>> loadUcumConversions()
+{
+    std::vector<std::pair<precise_unit, precise_unit>> conversions;
+    tinyxml2::XMLDocument doc;
+    if (doc.LoadFile(BENCHMARK_FILE_FOLDER "/UcumFunctionalTests.xml") != tinyxml2::XML_SUCCESS) {
+        return conversions;
+    }
+    for (auto cs = doc.FirstChildElement("ucumTests")
+                       ->FirstChildElement("conversion")
+                       ->FirstChildElement("case");
+         cs != nullptr;
+         cs = cs->NextSiblingElement("case")) {
+        conversions.emplace_back(
+            unit_from_string(cs->Attribute("srcUnit")),
+            unit_from_string(cs->Attribute("dstUnit")));
+    }
+    return conversions;
+}
+
+// collect the definitions, names, and symbols in a udunits xml element
+void collectUdunitsStrings(const tinyxml2::XMLElement* element, std::vector<std::string>& strings)
+{
+    for (auto child = element->FirstChildElement(); child != nullptr;
+         child = child->NextSiblingElement()) {
+        std::string name = child->Name();
+        if (name == "def" || name == "singular" || name == "plural" || name == "symbol") {
+            if (child->GetText() != nullptr) {
+                strings.emplace_back(child->GetText());
+            }
+        } else {
+            collectUdunitsStrings(child, strings);
+        }
+    }
+}
+
+std::vector<std::string> loadUdunitsStrings()
+{
+    std::vector<std::string> strings;
+    for (const char* file : {BENCHMARK_FILE_FOLDER "/UDUNITS2/udunits2-accepted.xml",
+                             BENCHMARK_FILE_FOLDER "/UDUNITS2/udunits2-common.xml",
+                             BENCHMARK_FILE_FOLDER "/UDUNITS2/udunits2-derived.xml"}) {
+        tinyxml2::XMLDocument doc;
+        if (doc.LoadFile(file) == tinyxml2::XML_SUCCESS) {
+            collectUdunitsStrings(doc.FirstChildElement("unit-system"), strings);
+        }
+    }
+    return strings;
+}
+
+// the inputs that have caused problems in fuzz testing
+std::vector<std::string> loadFuzzInputs()
+{
+    std::vector<std::string> inputs;
+    // the files of each type are numbered from 1,  read them until one is missing
+    for (const char* type : {"crash", "oom", "slow", "timeout", "rtrip_fail"}) {
+        for (int ii = 1;; ++ii) {
+            std::string fileName(BENCHMARK_FILE_FOLDER "/fuzz_issues/");
+            fileName.append(type);
+            fileName += std::to_string(ii);
+            std::ifstream file(fileName, std::ios::in | std::ios::binary);
+            if (!file) {
+                break;
+            }
+            inputs.emplace_back(
+                std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+    }
+    return inputs;
+}
+
+const std::vector<std::string>& corpusStrings(corpus source)
+{
+    static const std::vector<std::string> ucumCodes = loadUcumCodes();
+    static const std::vector<std::string> ucumTests = loadUcumTestUnits();
+    static const std::vector<std::string> udunits = loadUdunitsStrings();
+    static const std::vector<std::string> fuzz = loadFuzzInputs();
+    switch (source) {
+        case corpus::ucum_codes:
+            return ucumCodes;
+        case corpus::ucum_tests:
+            return ucumTests;
+        case corpus::udunits:
+            return udunits;
+        case corpus::fuzz:
+        default:
+            return fuzz;
+    }
+}
+
+// the valid units produced by a corpus
+std::vector<precise_unit> corpusUnits(corpus source)
+{
+    std::vector<precise_unit> units;
+    for (const auto& str : corpusStrings(source)) {
+        auto unit = unit_from_string(str);
+        if (is_valid(unit)) {
+            units.push_back(unit);
+        }
+    }
+    return units;
+}
+
+// all codes of one and two characters for the code based standards
+std::vector<std::string> unitCodes()
+{
+    static const std::string codeChars{"0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+    std::vector<std::string> codes;
+    for (auto c1 : codeChars) {
+        codes.emplace_back(1, c1);
+        for (auto c2 : codeChars) {
+            codes.push_back(std::string{c1, c2});
+        }
+    }
+    return codes;
+}
+
+// the commodity annotations and descriptive words in the UCUM examples
+std::vector<std::string> commodityStrings()
+{
+    std::vector<std::string> commodities;
+    std::ifstream file(BENCHMARK_FILE_FOLDER "/example_ucum_codes.csv");
+    std::string line;
+    while (std::getline(file, line)) {
+        auto bstart = line.find_first_of('{');
+        while (bstart != std::string::npos) {
+            auto bend = line.find_first_of('}', bstart);
+            if (bend == std::string::npos) {
+                break;
+            }
+            commodities.push_back(line.substr(bstart + 1, bend - bstart - 1));
+            bstart = line.find_first_of('{', bend);
+        }
+        auto desc = line.find_last_of(',');
+        if (desc != std::string::npos) {
+            auto wend = line.find_first_of(' ', desc + 1);
+            commodities.push_back(line.substr(desc + 1, wend - desc - 1));
+        }
+    }
+    return commodities;
+}
+
+void setCorpusCounters(benchmark::State& state, size_t count)
+{
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count));
+}
+} // namespace
+
+static void BM_unit_from_string(benchmark::State& state, corpus source, uint32_t flags)
+{
+    const auto& strings = corpusStrings(source);
+    for (auto _ : state) {
+        for (const auto& str : strings) {
+            benchmark::DoNotOptimize(unit_from_string(str, flags));
+        }
+    }
+    setCorpusCounters(state, strings.size());
+}
+BENCHMARK_CAPTURE(BM_unit_from_string, ucum_codes, corpus::ucum_codes, 0U);
+BENCHMARK_CAPTURE(BM_unit_from_string, ucum_tests, corpus::ucum_tests, 0U);
+BENCHMARK_CAPTURE(BM_unit_from_string, udunits, corpus::udunits, 0U);
+BENCHMARK_CAPTURE(BM_unit_from_string, fuzz, corpus::fuzz, 0U);
+BENCHMARK_CAPTURE(
+    BM_unit_from_string,
+    ucum_codes_case_insensitive,
+    corpus::ucum_codes,
+    static_cast<uint32_t>(case_insensitive));
+BENCHMARK_CAPTURE(
+    BM_unit_from_string,
+    ucum_tests_case_insensitive,
+    corpus::ucum_tests,
+    static_cast<uint32_t>(case_insensitive));
+BENCHMARK_CAPTURE(
+    BM_unit_from_string,
+    udunits_case_insensitive,
+    corpus::udunits,
+    static_cast<uint32_t>(case_insensitive));
+BENCHMARK_CAPTURE(
+    BM_unit_from_string,
+    fuzz_case_insensitive,
+    corpus::fuzz,
+    static_cast<uint32_t>(case_insensitive));
+
+static void BM_to_string(benchmark::State& state, corpus source)
+{
+    auto units = corpusUnits(source);
+    for (auto _ : state) {
+        for (const auto& unit : units) {
+            benchmark::DoNotOptimize(to_string(unit));
+        }
+    }
+    setCorpusCounters(state, units.size());
+}
+BENCHMARK_CAPTURE(BM_to_string, ucum_codes, corpus::ucum_codes);
+BENCHMARK_CAPTURE(BM_to_string, ucum_tests, corpus::ucum_tests);
+BENCHMARK_CAPTURE(BM_to_string, udunits, corpus::udunits);
+
+static void BM_measurement_from_string(benchmark::State& state, corpus source)
+{
+    // the UCUM examples mostly have leading numbers, the conversion tests are written as measurements
+    auto strings =
+        (source == corpus::ucum_tests) ? loadUcumMeasurements() : corpusStrings(source);
+    for (auto _ : state) {
+        for (const auto& str : strings) {
+            benchmark::DoNotOptimize(measurement_from_string(str));
+        }
+    }
+    setCorpusCounters(state, strings.size());
+}
+BENCHMARK_CAPTURE(BM_measurement_from_string, ucum_codes, corpus::ucum_codes);
+BENCHMARK_CAPTURE(BM_measurement_from_string, ucum_tests, corpus::ucum_tests);
+
+static void
+    BM_convert(benchmark::State& state, std::vector<std::pair<precise_unit, precise_unit>> pairs)
+{
+    double value{1.0};
+    for (auto _ : state) {
+        for (const auto& pair : pairs) {
+            benchmark::DoNotOptimize(convert(value, pair.first, pair.second));
+        }
+        value += 1.0;
+    }
+    setCorpusCounters(state, pairs.size());
+}
+BENCHMARK_CAPTURE(
+    BM_convert,
+    multiplier,
+    std::vector<std::pair<precise_unit, precise_unit>>{
+        {precise::ft, precise::m},
+        {precise::lb, precise::kg},
+        {precise::mile / precise::hr, precise::m / precise::s},
+        {precise::gal, precise::L},
+        {precise::kWh, precise::J}});
+BENCHMARK_CAPTURE(
+    BM_convert,
+    temperature,
+    std::vector<std::pair<precise_unit, precise_unit>>{
+        {precise::degF, precise::degC},
+        {precise::degC, precise::K},
+        {precise::K, precise::degF},
+        {precise::degC, precise::degF}});
+BENCHMARK_CAPTURE(
+    BM_convert,
+    equation,
+    std::vector<std::pair<precise_unit, precise_unit>>{
+        {precise::log::dB * precise::mW, precise::W},
+        {precise::W, precise::log::dB * precise::mW},
+        {precise::log::neper, precise::log::bel}});
+BENCHMARK_CAPTURE(
+    BM_convert,
+    per_unit,
+    std::vector<std::pair<precise_unit, precise_unit>>{
+        {precise::puMW, precise::puV * precise::A},
+        {precise::pu * precise::ohm, precise::pu * precise::S},
+        {precise::puV, precise::pu}});
+BENCHMARK_CAPTURE(
+    BM_convert,
+    counting,
+    std::vector<std::pair<precise_unit, precise_unit>>{
+        {precise::mol, precise::count},
+        {precise::count, precise::mol},
+        {precise::rad, precise::count}});
+BENCHMARK_CAPTURE(
+    BM_convert,
+    inverse,
+    std::vector<std::pair<precise_unit, precise_unit>>{
+        {precise::Hz, precise::s},
+        {precise::s, precise::Hz},
+        {precise::m.inv(), precise::ft}});
+BENCHMARK_CAPTURE(BM_convert, ucum_tests, loadUcumConversions());
+
+static void BM_code_standard(benchmark::State& state, precise_unit (*conversion)(std::string))
+{
+    auto codes = unitCodes();
+    for (auto _ : state) {
+        for (const auto& code : codes) {
+            benchmark::DoNotOptimize(conversion(code));
+        }
+    }
+    setCorpusCounters(state, codes.size());
+}
+BENCHMARK_CAPTURE(BM_code_standard, x12_unit, &x12_unit);
+BENCHMARK_CAPTURE(BM_code_standard, r20_unit, &r20_unit);
+
+static void BM_getCommodity(benchmark::State& state)
+{
+    auto commodities = commodityStrings();
+    for (auto _ : state) {
+        for (const auto& commodity : commodities) {
+            benchmark::DoNotOptimize(getCommodity(commodity));
+        }
+    }
+    setCorpusCounters(state, commodities.size());
+}
+BENCHMARK(BM_getCommodity);
+
+BENCHMARK_MAIN();
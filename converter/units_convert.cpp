@@ -0,0 +1,367 @@
+/*
+Copyright (c) 2019,
+Lawrence Livermore National Security, LLC;
+See the top-level NOTICE for additional details. All rights reserved.
+SPDX-License-Identifier: BSD-3-Clause
+*/
+/** @file
+command line tool to convert a column of measurements in a delimited text file to a single unit
+*/
+#include "units/measurement_reader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace units;
+
+static void printUsage()
+{
+    std::cerr
+        << "usage: units_convert [options] <file> <unit>\n"
+           "convert every row of a column of measurements in <file> to <unit>, use - to read "
+           "from stdin\n"
+           "the converted values are written one per row,  rows which can't be converted are "
+           "written as nan\n"
+           "rows are counted from 0 after the header rows,  blank rows are skipped\n"
+           "options:\n"
+           "  --column N          the column with a value and unit in each cell (default 0)\n"
+           "  --value-column N    the column of the values\n"
+           "  --unit-column N     the column of the units of the values\n"
+           "  --from UNIT         the unit of every value if there is no unit column\n"
+           "  --delimiter C       the character separating the columns (default ,)\n"
+           "  --header N          the number of header rows to skip (default 0)\n"
+           "  --threads N         the number of threads to use (default all cores)\n"
+           "  --chunk-bytes N     the approximate size of the text converted as one chunk\n"
+           "  --output FILE       write the converted values to FILE instead of stdout\n"
+           "  --no-output         only report the statistics\n"
+           "  --max-errors N      the number of unconvertible rows to list (default 10)\n";
+}
+
+namespace {
+/// the converted values of a chunk of rows
+struct convertedChunk {
+    std::string text; //!< the formatted values
+    std::vector<size_t> failed; //!< the rows which could not be converted
+    size_t rows{0};
+};
+
+/// the settings of the tool
+struct converterOptions {
+    measurement_reader_options reader;
+    std::string file;
+    std::string target;
+    std::string from;
+    std::string output;
+    bool writeOutput{true};
+    size_t maxErrors{10};
+};
+} // namespace
+
+// convert and format the measurements of a chunk
+static convertedChunk convertChunk(
+    size_t first_row,
+    const std::vector<precision_measurement>& measurements,
+    const precise_unit& source,
+    const precise_unit& target,
+    bool format)
+{
+    convertedChunk result;
+    result.rows = measurements.size();
+    if (format) {
+        result.text.reserve(measurements.size() * 16);
+    }
+    char buffer[32];
+    for (size_t ii = 0; ii < measurements.size(); ++ii) {
+        const auto& meas = measurements[ii];
+        const auto& units =
+            (is_valid(source) && meas.units() == precise::one) ? source : meas.units();
+        double value = cached_convert(meas.value(), units, target);
+        if (std::isnan(value)) {
+            result.failed.push_back(first_row + ii);
+        }
+        if (format) {
+            int length = std::snprintf(buffer, sizeof(buffer), "%.12g\n", value);
+            result.text.append(buffer, static_cast<size_t>(length));
+        }
+    }
+    return result;
+}
+
+namespace {
+/** converts chunks on a fixed set of threads
+@details the results are handed back in the order the chunks were added*/
+class chunkConverter {
+  public:
+    chunkConverter(
+        size_t threads,
+        const precise_unit& source,
+        const precise_unit& target,
+        bool format) :
+        sourceUnit(source), targetUnit(target), formatValues(format)
+    {
+        for (size_t ii = 0; ii < threads; ++ii) {
+            workers.emplace_back([this]() { work(); });
+        }
+    }
+    ~chunkConverter()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stop = true;
+        }
+        available.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    chunkConverter(const chunkConverter&) = delete;
+    chunkConverter& operator=(const chunkConverter&) = delete;
+
+    /// queue a chunk for conversion
+    void add(size_t first_row, const std::vector<precision_measurement>& measurements)
+    {
+        auto chunk = std::make_shared<task>();
+        chunk->firstRow = first_row;
+        chunk->measurements = measurements;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            inOrder.push_back(chunk);
+            waiting.push_back(std::move(chunk));
+        }
+        available.notify_one();
+    }
+    /// the number of chunks whose results have not been taken,  only called from the thread adding chunks
+    size_t pending() const { return inOrder.size(); }
+    /// wait for the oldest chunk and take its result,  an exception from the conversion is rethrown
+    convertedChunk next()
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        auto chunk = inOrder.front();
+        inOrder.pop_front();
+        finished.wait(guard, [&chunk]() { return chunk->done; });
+        if (chunk->error) {
+            std::rethrow_exception(chunk->error);
+        }
+        return std::move(chunk->result);
+    }
+
+  private:
+    struct task {
+        size_t firstRow{0};
+        std::vector<precision_measurement> measurements;
+        convertedChunk result;
+        std::exception_ptr error;
+        bool done{false};
+    };
+    void work()
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        while (true) {
+            available.wait(guard, [this]() { return stop || !waiting.empty(); });
+            if (waiting.empty()) {
+                return;
+            }
+            auto chunk = std::move(waiting.front());
+            waiting.pop_front();
+            guard.unlock();
+            try {
+                chunk->result = convertChunk(
+                    chunk->firstRow, chunk->measurements, sourceUnit, targetUnit, formatValues);
+            }
+            catch (...) {
+                chunk->error = std::current_exception();
+            }
+            chunk->measurements.clear();
+            chunk->measurements.shrink_to_fit();
+            guard.lock();
+            chunk->done = true;
+            finished.notify_all();
+        }
+    }
+
+    const precise_unit sourceUnit;
+    const precise_unit targetUnit;
+    const bool formatValues;
+    std::mutex lock;
+    std::condition_variable available;
+    std::condition_variable finished;
+    std::deque<std::shared_ptr<task>> inOrder;
+    std::deque<std::shared_ptr<task>> waiting;
+    bool stop{false};
+    std::vector<std::thread> workers;
+};
+} // namespace
+
+static bool readArguments(int argc, char* argv[], converterOptions& options)
+{
+    std::vector<std::string> positional;
+    for (int ii = 1; ii < argc; ++ii) {
+        std::string arg = argv[ii];
+        if (arg == "--no-output") {
+            options.writeOutput = false;
+            continue;
+        }
+        if (arg == "--help" || arg == "-h") {
+            return false;
+        }
+        if (arg.size() < 2 || arg.compare(0, 2, "--") != 0) {
+            positional.push_back(arg);
+            continue;
+        }
+        if (ii + 1 >= argc) {
+            std::cerr << "missing value for " << arg << '\n';
+            return false;
+        }
+        std::string value = argv[++ii];
+        if (arg == "--column") {
+            options.reader.measurement_column = std::atoi(value.c_str());
+        } else if (arg == "--value-column") {
+            options.reader.value_column = std::atoi(value.c_str());
+        } else if (arg == "--unit-column") {
+            options.reader.unit_column = std::atoi(value.c_str());
+        } else if (arg == "--from") {
+            options.from = value;
+        } else if (arg == "--delimiter") {
+            options.reader.delimiter = (value == "\\t") ? '\t' : value[0];
+        } else if (arg == "--header") {
+            options.reader.header_rows = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--threads") {
+            options.reader.threads = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--chunk-bytes") {
+            options.reader.chunk_bytes = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--output") {
+            options.output = value;
+        } else if (arg == "--max-errors") {
+            options.maxErrors = std::strtoull(value.c_str(), nullptr, 10);
+        } else {
+            std::cerr << "unrecognized option " << arg << '\n';
+            return false;
+        }
+    }
+    if (positional.size() != 2) {
+        return false;
+    }
+    options.file = positional[0];
+    options.target = positional[1];
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    converterOptions options;
+    if (!readArguments(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+    auto target = unit_from_string(options.target);
+    if (!is_valid(target)) {
+        std::cerr << "unable to interpret \"" << options.target << "\" as a unit\n";
+        return 1;
+    }
+    precise_unit source = precise::invalid;
+    if (!options.from.empty()) {
+        source = unit_from_string(options.from);
+        if (!is_valid(source)) {
+            std::cerr << "unable to interpret \"" << options.from << "\" as a unit\n";
+            return 1;
+        }
+    }
+
+    // files mostly repeat a few units so the resolved conversions are reused across rows
+    enableConversionCache();
+
+    FILE* out = nullptr;
+    if (options.writeOutput) {
+        out = (options.output.empty()) ? stdout : std::fopen(options.output.c_str(), "wb");
+        if (out == nullptr) {
+            std::cerr << "unable to open " << options.output << '\n';
+            return 1;
+        }
+    }
+
+    size_t threads = (options.reader.threads == 0) ? std::thread::hardware_concurrency() :
+                                                     options.reader.threads;
+    if (threads == 0) {
+        threads = 1;
+    }
+    size_t rows{0};
+    size_t failures{0};
+    std::vector<size_t> failedRows;
+    // the chunks are converted on a fixed set of threads and written in order,  a few at a time
+    chunkConverter converter(threads, source, target, out != nullptr);
+    auto finishChunk = [&]() {
+        auto result = converter.next();
+        if (out != nullptr) {
+            std::fwrite(result.text.data(), 1, result.text.size(), out);
+        }
+        rows += result.rows;
+        failures += result.failed.size();
+        for (auto row : result.failed) {
+            if (failedRows.size() >= options.maxErrors) {
+                break;
+            }
+            failedRows.push_back(row);
+        }
+    };
+    auto handler = [&](size_t first_row, const std::vector<precision_measurement>& chunk) {
+        converter.add(first_row, chunk);
+        if (converter.pending() > threads) {
+            finishChunk();
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    size_t bytes{0};
+    if (options.file == "-") {
+        std::string text{std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>()};
+        bytes = text.size();
+        read_measurements(text.data(), text.size(), options.reader, handler);
+    } else {
+        if (!read_measurement_file(options.file, options.reader, handler, bytes)) {
+            std::cerr << "unable to read " << options.file << '\n';
+            return 1;
+        }
+    }
+    while (converter.pending() > 0) {
+        finishChunk();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (out != nullptr && out != stdout) {
+        std::fclose(out);
+    } else if (out != nullptr) {
+        std::fflush(out);
+    }
+
+    double seconds = (std::max)(elapsed.count(), 1e-9);
+    std::fprintf(
+        stderr,
+        "converted %zu of %zu rows in %.3f s (%.0f rows/s, %.1f MB/s)\n",
+        rows - failures,
+        rows,
+        seconds,
+        static_cast<double>(rows) / seconds,
+        static_cast<double>(bytes) / seconds / 1e6);
+    if (failures > 0) {
+        std::fprintf(stderr, "%zu rows could not be converted", failures);
+        const char* separator = ":";
+        for (auto row : failedRows) {
+            std::fprintf(stderr, "%s %zu", separator, row);
+            separator = ",";
+        }
+        std::fprintf(stderr, "%s\n", (failedRows.size() < failures) ? " ..." : "");
+    }
+    return 0;
+}
@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+# ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+# Copyright (c) 2019,
+# Lawrence Livermore National Security, LLC;
+# See the top-level NOTICE for additional details. All rights reserved.
+# SPDX-License-Identifier: BSD-3-Clause
+# ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+"""Generate units/base_unit_index.hpp from the base_unit_vals table in units/units.cpp.
+
+The index is a hash and displace perfect hash of the unit strings.  Each string hashes to a bucket and
+each bucket stores the displacement that sends all of its strings to distinct slots, so a lookup is one
+hash, one slot read, and one string comparison.  Duplicate strings are dropped so the first
+definition wins.  Run this script after changing the table, or with --check to verify the header is
+up to date.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+BUCKET_COUNT = 512
+SLOT_COUNT = 4096
+MASK64 = (1 << 64) - 1
+
+SIMPLE_ESCAPES = {
+    "n": 0x0A,
+    "t": 0x09,
+    "r": 0x0D,
+    "a": 0x07,
+    "b": 0x08,
+    "f": 0x0C,
+    "v": 0x0B,
+    "\\": 0x5C,
+    "'": 0x27,
+    '"': 0x22,
+    "?": 0x3F,
+}
+
+
+def fnv1a(data, value=14695981039346656037):
+    for byte in data:
+        value = ((value ^ byte) * 1099511628211) & MASK64
+    return value
+
+
+def bucket(value):
+    return value & (BUCKET_COUNT - 1)
+
+
+def slot(value, disp):
+    return ((value >> 16) + disp * (((value >> 40) << 1) | 1)) & (SLOT_COUNT - 1)
+
+
+def decode_literal(body):
+    """decode the body of a narrow or u8 string literal into its bytes"""
+    result = bytearray()
+    ii = 0
+    while ii < len(body):
+        char = body[ii]
+        if char != "\\":
+            result += char.encode("utf-8")
+            ii += 1
+            continue
+        code = body[ii + 1]
+        if code == "x":
+            match = re.match(r"[0-9a-fA-F]+", body[ii + 2 :])
+            result.append(int(match.group(0), 16))
+            ii += 2 + len(match.group(0))
+        elif code in "uU":
+            digits = 4 if code == "u" else 8
+            result += chr(int(body[ii + 2 : ii + 2 + digits], 16)).encode("utf-8")
+            ii += 2 + digits
+        elif code in "01234567":
+            match = re.match(r"[0-7]{1,3}", body[ii + 1 :])
+            result.append(int(match.group(0), 8))
+            ii += 1 + len(match.group(0))
+        else:
+            result.append(SIMPLE_ESCAPES[code])
+            ii += 2
+    return bytes(result)
+
+
+def read_table(source):
+    """extract the key strings of the base_unit_vals table in order"""
+    start = re.search(r"base_unit_vals\[\]\s*\{", source)
+    if start is None:
+        raise RuntimeError("unable to find the base_unit_vals table")
+    pos = start.end()
+    depth = 1
+    keys = []
+    key = None
+    while depth > 0:
+        char = source[pos]
+        if source.startswith("//", pos):
+            pos = source.index("\n", pos)
+        elif source.startswith("/*", pos):
+            pos = source.index("*/", pos) + 2
+        elif char.isspace():
+            pos += 1
+        elif char == '"' or source.startswith('u8"', pos):
+            pos = source.index('"', pos) + 1
+            end = pos
+            while source[end] != '"':
+                end += 2 if source[end] == "\\" else 1
+            if key is not None:
+                key += decode_literal(source[pos:end])
+            pos = end + 1
+        else:
+            if key is not None:
+                keys.append(key)
+                key = None
+            if char == "{":
+                depth += 1
+                if depth == 2:
+                    key = b""
+            elif char == "}":
+                depth -= 1
+            pos += 1
+    return keys
+
+
+def generate_index(keys):
+    hashes = [fnv1a(key) for key in keys]
+    members = [[] for _ in range(BUCKET_COUNT)]
+    seen = set()
+    for ii, key in enumerate(keys):
+        if key not in seen:
+            seen.add(key)
+            members[bucket(hashes[ii])].append(ii)
+    slots = [0] * SLOT_COUNT
+    displacement = [0] * BUCKET_COUNT
+    # place the largest buckets first while the slot table is empty
+    for size in range(max(len(entries) for entries in members), 0, -1):
+        for bb, entries in enumerate(members):
+            if len(entries) != size:
+                continue
+            disp = 0
+            while True:
+                targets = [slot(hashes[entry], disp) for entry in entries]
+                if len(set(targets)) == size and all(slots[sl] == 0 for sl in targets):
+                    break
+                disp += 1
+            displacement[bb] = disp
+            for entry, sl in zip(entries, targets):
+                slots[sl] = entry + 1
+    table_hash = 14695981039346656037
+    for key in keys:
+        table_hash = fnv1a(key + b"\0", table_hash)
+    return slots, displacement, table_hash
+
+
+def format_array(type_name, name, values):
+    lines = ["    constexpr std::array<{}, {}> {}{{{{".format(type_name, len(values), name)]
+    line = "       "
+    for value in values:
+        item = " {},".format(value)
+        if len(line) + len(item) > 100:
+            lines.append(line)
+            line = "       "
+        line += item
+    lines.append(line)
+    lines.append("    }};")
+    return "\n".join(lines)
+
+
+def generate_header(keys):
+    slots, displacement, table_hash = generate_index(keys)
+    lengths = [len(key) for key in keys]
+    parts = [
+        """/*
+Copyright (c) 2019,
+Lawrence Livermore National Security, LLC;
+See the top-level NOTICE for additional details. All rights reserved.
+SPDX-License-Identifier: BSD-3-Clause
+*/
+// generated by scripts/generate_base_unit_index.py from the base_unit_vals table in units.cpp,
+// rerun the script after changing the table
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace units {
+namespace base_unit_index {
+    /// the number of entries in the table
+    constexpr size_t count{%d};
+    constexpr size_t bucketCount{%d};
+    constexpr size_t slotCount{%d};
+    /// length of the longest string in the table
+    constexpr size_t maxLength{%d};
+    /// FNV-1a hash of all the strings in the table with their null terminators
+    constexpr uint64_t tableHash{%dULL};
+"""
+        % (len(keys), BUCKET_COUNT, SLOT_COUNT, max(lengths), table_hash),
+        "    /// displacement for each bucket",
+        format_array("uint16_t", "displacement", displacement),
+        "    /// entry index+1 for each slot (0 is an empty slot)",
+        format_array("uint16_t", "slots", slots),
+        "    /// length of each string in the table",
+        format_array("uint16_t", "lengths", lengths),
+        "} // namespace base_unit_index\n} // namespace units\n",
+    ]
+    return "\n".join(parts)
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--check", action="store_true", help="verify the header is up to date")
+    args = parser.parse_args()
+    with open(os.path.join(root, "units", "units.cpp"), encoding="utf-8") as source:
+        header = generate_header(read_table(source.read()))
+    output = os.path.join(root, "units", "base_unit_index.hpp")
+    if args.check:
+        with open(output, encoding="utf-8") as current:
+            if current.read() != header:
+                print("units/base_unit_index.hpp is out of date, run " + sys.argv[0])
+                return 1
+        return 0
+    with open(output, "w", encoding="utf-8", newline="\n") as current:
+        current.write(header)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
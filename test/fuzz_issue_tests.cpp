@@ -80,7 +80,7 @@ TEST_P(slowProblems, slowFiles)
     EXPECT_NO_THROW(unit_from_string(cdata));
 }
 
-INSTANTIATE_TEST_SUITE_P(slowFiles, slowProblems, ::testing::Range(1, 40));
+INSTANTIATE_TEST_SUITE_P(slowFiles, slowProblems, ::testing::Range(1, 41));
 
 class oomProblems : public ::testing::TestWithParam<int> {
 };
@@ -94,6 +94,141 @@ TEST_P(oomProblems, oomFiles)
 
 INSTANTIATE_TEST_SUITE_P(oomFiles, oomProblems, ::testing::Range(1, 65));
 
+TEST_P(oomProblems, oomFilesBudget)
+{
+    auto cdata = loadFailureFile("oom", GetParam());
+    ASSERT_FALSE(cdata.empty());
+    auto unlimited = unit_from_string(cdata);
+    parse_budget budget;
+    budget.max_steps = 20;
+    budget.max_probes = 200;
+    setParseBudget(budget);
+    auto u1 = unit_from_string(cdata);
+    if (parseBudgetExceeded()) {
+        EXPECT_FALSE(is_valid(u1));
+        // the cut off is deterministic
+        EXPECT_FALSE(is_valid(unit_from_string(cdata)));
+        EXPECT_TRUE(parseBudgetExceeded());
+    } else if (is_valid(unlimited)) {
+        EXPECT_EQ(u1, unlimited);
+    }
+    clearParseBudget();
+}
+
+TEST(fuzzFailures, codeReplacementsOnePass)
+{
+    for (const char* type : {"crash", "oom", "slow", "timeout", "rtrip_fail"}) {
+        for (int index = 1;; ++index) {
+            auto cdata = loadFailureFile(type, index);
+            if (cdata.empty()) {
+                break;
+            }
+            EXPECT_TRUE(detail::testing::testCodeReplacements(cdata)) << type << index;
+        }
+    }
+}
+
+TEST(fuzzFailures, slowFilesWork)
+{
+    // the conversion passes are bounded by the length of the string so none of the strings that were
+    // slow for the fuzzer take much work
+    enableParseInstrumentation();
+    for (const char* type : {"slow", "oom", "timeout"}) {
+        for (int index = 1;; ++index) {
+            auto cdata = loadFailureFile(type, index);
+            if (cdata.empty()) {
+                break;
+            }
+            for (std::uint32_t flags : {std::uint32_t{0}, std::uint32_t{case_insensitive}}) {
+                unit_from_string(cdata, flags);
+                auto trace = getLastParseTrace();
+                // the passes allowed for the length of the string and the ones turned away after that
+                EXPECT_LE(trace.calls, 64U * (cdata.size() + 1)) << type << index;
+                EXPECT_LE(trace.probes, 128U * (cdata.size() + 1)) << type << index;
+            }
+        }
+    }
+    disableParseInstrumentation();
+    clearParseInstrumentation();
+}
+
+TEST(fuzzFailures, passLimitReported)
+{
+    // the passes for the length of the string are limited without a parse budget
+    auto cdata = loadFailureFile("slow", 40);
+    ASSERT_FALSE(cdata.empty());
+    EXPECT_FALSE(is_valid(unit_from_string(cdata)));
+    EXPECT_TRUE(parseBudgetExceeded());
+    EXPECT_TRUE(is_valid(unit_from_string("m/s")));
+    EXPECT_FALSE(parseBudgetExceeded());
+}
+
+TEST(fuzzFailures, parseBudget)
+{
+    auto cdata = loadFailureFile("oom", 61);
+    ASSERT_FALSE(cdata.empty());
+    parse_budget budget;
+    budget.max_probes = 100;
+    setParseBudget(budget);
+    EXPECT_EQ(getParseBudget().max_probes, 100U);
+    EXPECT_FALSE(is_valid(unit_from_string(cdata)));
+    EXPECT_TRUE(parseBudgetExceeded());
+    // simple strings are well within the budget
+    EXPECT_EQ(unit_from_string("kg/m"), precise::kg / precise::m);
+    EXPECT_FALSE(parseBudgetExceeded());
+
+    budget.max_probes = 0;
+    budget.max_nanoseconds = 1;
+    setParseBudget(budget);
+    EXPECT_FALSE(is_valid(unit_from_string(cdata)));
+    EXPECT_TRUE(parseBudgetExceeded());
+    clearParseBudget();
+    EXPECT_EQ(getParseBudget().max_nanoseconds, 0U);
+}
+
+TEST(fuzzFailures, parseBudgetCache)
+{
+    enableUnitStringCache();
+    parse_budget budget;
+    budget.max_probes = 2;
+    setParseBudget(budget);
+    EXPECT_FALSE(is_valid(unit_from_string("cubic furlong")));
+    EXPECT_TRUE(parseBudgetExceeded());
+    clearParseBudget();
+    // the result cut off by the budget is not cached
+    EXPECT_EQ(unit_from_string("cubic furlong"), precise::us::furlong.pow(3));
+    EXPECT_FALSE(parseBudgetExceeded());
+    disableUnitStringCache();
+}
+
+TEST(fuzzFailures, parseBudgetPerCall)
+{
+    auto cdata = loadFailureFile("oom", 61);
+    ASSERT_FALSE(cdata.empty());
+    parse_budget budget;
+    budget.max_probes = 100;
+    EXPECT_FALSE(is_valid(unit_from_string(cdata, budget)));
+    EXPECT_TRUE(parseBudgetExceeded());
+    // the process wide budget is not changed
+    EXPECT_EQ(getParseBudget().max_probes, 0U);
+    EXPECT_EQ(unit_from_string("kg/m", budget), precise::kg / precise::m);
+    EXPECT_FALSE(parseBudgetExceeded());
+
+    // a per call budget replaces the process wide one
+    parse_budget tight;
+    tight.max_probes = 2;
+    setParseBudget(tight);
+    EXPECT_FALSE(is_valid(unit_from_string("cubic furlong")));
+    EXPECT_EQ(unit_from_string("cubic furlong", parse_budget{}), precise::us::furlong.pow(3));
+    EXPECT_FALSE(parseBudgetExceeded());
+    EXPECT_EQ(
+        measurement_from_string("3 cubic furlong", parse_budget{}).units(),
+        precise::us::furlong.pow(3));
+    clearParseBudget();
+    EXPECT_FALSE(is_valid(measurement_from_string("3 cubic furlong", tight).units()));
+    EXPECT_TRUE(parseBudgetExceeded());
+}
+
 class roundTripString : public ::testing::TestWithParam<std::string> {
 };
 
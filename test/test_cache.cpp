@@ -0,0 +1,297 @@
+/*
+Copyright (c) 2019,
+Lawrence Livermore National Security, LLC;
+See the top-level NOTICE for additional details. All rights reserved.
+SPDX-License-Identifier: BSD-3-Clause
+*/
+#include "units/units.hpp"
+
+#include "test.hpp"
+
+#include <cmath>
+#include <string>
+#include <utility>
+#include <thread>
+#include <vector>
+
+using namespace units;
+
+TEST(unitStringCache, hits)
+{
+    enableUnitStringCache(64);
+    auto u1 = unit_from_string("kg.m2/(s3.A)");
+    auto u2 = unit_from_string("kg.m2/(s3.A)");
+    EXPECT_EQ(u1, u2);
+    EXPECT_EQ(u1, precise::V);
+    auto stats = getUnitStringCacheStatistics();
+    EXPECT_EQ(stats.hits, 1U);
+    EXPECT_EQ(stats.misses, 1U);
+    EXPECT_EQ(stats.size, 1U);
+    EXPECT_GE(stats.capacity, 64U);
+    disableUnitStringCache();
+    stats = getUnitStringCacheStatistics();
+    EXPECT_EQ(stats.size, 0U);
+    EXPECT_EQ(stats.capacity, 0U);
+}
+
+TEST(unitStringCache, flags)
+{
+    enableUnitStringCache(64);
+    EXPECT_EQ(unit_from_string("MM[HG]", case_insensitive), precise::pressure::mmHg);
+    EXPECT_EQ(unit_from_string("MM[HG]"), unit_from_string("MM[HG]"));
+    auto stats = getUnitStringCacheStatistics();
+    EXPECT_EQ(stats.size, 2U);
+    EXPECT_EQ(unit_from_string("MM[HG]", case_insensitive), precise::pressure::mmHg);
+    disableUnitStringCache();
+}
+
+TEST(unitStringCache, userDefinedUnits)
+{
+    enableUnitStringCache(64);
+    EXPECT_FALSE(is_valid(unit_from_string("clucks/A")));
+    precise_unit clucks(19.3, precise::m * precise::A);
+    addUserDefinedUnit("clucks", clucks);
+    EXPECT_EQ(unit_from_string("clucks/A"), precise_unit(19.3, precise::m));
+    clearUserDefinedUnits();
+    EXPECT_FALSE(is_valid(unit_from_string("clucks/A")));
+    disableUnitStringCache();
+}
+
+TEST(unitStringCache, customCommodities)
+{
+    enableUnitStringCache(64);
+    auto u1 = unit_from_string("kg{zzcomm}");
+    EXPECT_EQ(u1.commodity(), getCommodity("zzcomm"));
+    clearCustomCommodities();
+    addCustomCommodity("zzcomm", 1234);
+    auto u2 = unit_from_string("kg{zzcomm}");
+    EXPECT_EQ(u2.commodity(), 1234U);
+    clearCustomCommodities();
+    disableUnitStringCache();
+}
+
+TEST(unitStringCache, bounded)
+{
+    enableUnitStringCache(32);
+    for (int ii = 0; ii < 500; ++ii) {
+        auto ustr = std::to_string(ii) + "m/s";
+        EXPECT_EQ(unit_from_string(ustr), precise_unit(ii, precise::m / precise::s));
+    }
+    // the recently used entries should remain
+    EXPECT_EQ(unit_from_string("499m/s"), precise_unit(499.0, precise::m / precise::s));
+    auto stats = getUnitStringCacheStatistics();
+    EXPECT_LE(stats.size, stats.capacity);
+    EXPECT_GT(stats.evictions, 0U);
+    EXPECT_EQ(stats.hits, 1U);
+    disableUnitStringCache();
+}
+
+TEST(unitStringCache, threads)
+{
+    enableUnitStringCache(128);
+    const std::vector<std::string> ustrings{
+        "kg.m2/(s3.A)", "m/s", "N*m", "mmHg", "kWh", "ft^2", "lb/in^2", "mol/L"};
+    std::vector<precise_unit> expected;
+    for (const auto& ustr : ustrings) {
+        expected.push_back(unit_from_string(ustr));
+    }
+    std::vector<int> errors(4, 0);
+    std::vector<std::thread> threads;
+    for (int tt = 0; tt < 4; ++tt) {
+        threads.emplace_back([&, tt]() {
+            for (int ii = 0; ii < 2000; ++ii) {
+                auto index = static_cast<size_t>(ii + tt) % ustrings.size();
+                if (unit_from_string(ustrings[index]) != expected[index]) {
+                    ++errors[tt];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto err : errors) {
+        EXPECT_EQ(err, 0);
+    }
+    auto stats = getUnitStringCacheStatistics();
+    EXPECT_EQ(stats.misses, ustrings.size());
+    EXPECT_EQ(stats.hits, 8000U);
+    disableUnitStringCache();
+}
+
+TEST(unitFormatCache, hits)
+{
+    enableUnitFormatCache(64);
+    auto str = to_string(precise::V);
+    EXPECT_EQ(to_string(precise::V), str);
+    EXPECT_EQ(to_string(precision_measurement(5.0, precise::V)), "5 " + str);
+    auto stats = getUnitFormatCacheStatistics();
+    EXPECT_EQ(stats.hits, 2U);
+    EXPECT_EQ(stats.misses, 1U);
+    EXPECT_EQ(stats.size, 1U);
+    // units which compare equal but have different bits are separate entries
+    EXPECT_EQ(to_string(precise_unit(1.0 + 1e-15, precise::V)), str);
+    EXPECT_EQ(getUnitFormatCacheStatistics().size, 2U);
+    disableUnitFormatCache();
+    stats = getUnitFormatCacheStatistics();
+    EXPECT_EQ(stats.size, 0U);
+    EXPECT_EQ(stats.capacity, 0U);
+}
+
+TEST(unitFormatCache, userDefinedUnits)
+{
+    enableUnitFormatCache(64);
+    precise_unit clucks(19.3, precise::m * precise::A);
+    auto str = to_string(clucks);
+    EXPECT_NE(str, "clucks");
+    addUserDefinedUnit("clucks", clucks);
+    EXPECT_EQ(to_string(clucks), "clucks");
+    clearUserDefinedUnits();
+    EXPECT_EQ(to_string(clucks), str);
+    disableUnitFormatCache();
+}
+
+TEST(unitFormatCache, customCommodities)
+{
+    enableUnitFormatCache(64);
+    precise_unit ukg(1.0, precise::kg, 1234);
+    auto str = to_string(ukg);
+    EXPECT_EQ(to_string(ukg), str);
+    addCustomCommodity("zzcomm", 1234);
+    EXPECT_EQ(to_string(ukg), "kg{zzcomm}");
+    clearCustomCommodities();
+    EXPECT_EQ(to_string(ukg), str);
+    // the names of unrecognized commodity strings are not cached
+    auto uc = unit_from_string("kg{yycomm}");
+    EXPECT_EQ(to_string(uc), "kg{yycomm}");
+    auto stats = getUnitFormatCacheStatistics();
+    EXPECT_EQ(stats.size, 1U);
+    disableUnitFormatCache();
+}
+
+TEST(unitFormatCache, threads)
+{
+    enableUnitFormatCache(128);
+    const std::vector<precise_unit> units{
+        precise::V, precise::m / precise::s, precise::N * precise::m, precise::pressure::mmHg,
+        precise::kWh, precise::ft.pow(2), precise::lb / precise::in.pow(2), precise::mol / precise::L};
+    std::vector<std::string> expected;
+    for (const auto& un : units) {
+        expected.push_back(to_string(un));
+    }
+    std::vector<int> errors(4, 0);
+    std::vector<std::thread> threads;
+    for (int tt = 0; tt < 4; ++tt) {
+        threads.emplace_back([&, tt]() {
+            for (int ii = 0; ii < 2000; ++ii) {
+                auto index = static_cast<size_t>(ii + tt) % units.size();
+                if (to_string(units[index]) != expected[index]) {
+                    ++errors[tt];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto err : errors) {
+        EXPECT_EQ(err, 0);
+    }
+    auto stats = getUnitFormatCacheStatistics();
+    EXPECT_EQ(stats.misses, units.size());
+    EXPECT_EQ(stats.hits, 8000U);
+    disableUnitFormatCache();
+}
+
+TEST(conversionCache, matchesConvert)
+{
+    enableConversionCache(64);
+    const std::vector<std::pair<precise_unit, precise_unit>> pairs{
+        {precise::ft, precise::m},
+        {precise::degF, precise::degC},
+        {precise::kWh, precise::MJ},
+        {precise::log::dB * precise::mW, precise::W},
+        {precise::m / precise::s, precise::kg}};
+    for (int pass = 0; pass < 2; ++pass) {
+        for (const auto& pr : pairs) {
+            auto expected = convert(37.5, pr.first, pr.second);
+            auto val = cached_convert(37.5, pr.first, pr.second);
+            if (std::isnan(expected)) {
+                EXPECT_TRUE(std::isnan(val));
+            } else {
+                EXPECT_EQ(val, expected);
+            }
+        }
+    }
+    auto stats = getConversionCacheStatistics();
+    EXPECT_EQ(stats.misses, pairs.size());
+    EXPECT_EQ(stats.hits, pairs.size());
+    EXPECT_EQ(stats.size, pairs.size());
+    EXPECT_EQ(stats.capacity, 64U);
+    // units which compare equal but have different bits are separate entries
+    EXPECT_EQ(
+        cached_convert(2.0, precise_unit(1.0 + 1e-15, precise::ft), precise::m),
+        convert(2.0, precise_unit(1.0 + 1e-15, precise::ft), precise::m));
+    EXPECT_EQ(getConversionCacheStatistics().size, pairs.size() + 1);
+    clearConversionCache();
+    EXPECT_EQ(getConversionCacheStatistics().size, 0U);
+    EXPECT_EQ(cached_convert(1.0, precise::ft, precise::m), convert(1.0, precise::ft, precise::m));
+    disableConversionCache();
+    stats = getConversionCacheStatistics();
+    EXPECT_EQ(stats.size, 0U);
+    EXPECT_EQ(stats.capacity, 0U);
+    // without the cache the conversions are still made
+    EXPECT_EQ(cached_convert(1.0, precise::ft, precise::m), convert(1.0, precise::ft, precise::m));
+}
+
+TEST(conversionCache, bounded)
+{
+    enableConversionCache(16);
+    for (int ii = 1; ii <= 500; ++ii) {
+        precise_unit start(ii, precise::m);
+        EXPECT_EQ(cached_convert(3.0, start, precise::ft), convert(3.0, start, precise::ft));
+    }
+    auto stats = getConversionCacheStatistics();
+    EXPECT_LE(stats.size, stats.capacity);
+    EXPECT_GT(stats.evictions, 0U);
+    EXPECT_EQ(stats.misses, 500U);
+    disableConversionCache();
+}
+
+TEST(conversionCache, threads)
+{
+    enableConversionCache(128);
+    const std::vector<precise_unit> units{
+        precise::V, precise::m / precise::s, precise::N * precise::m, precise::pressure::mmHg,
+        precise::kWh, precise::ft.pow(2), precise::lb / precise::in.pow(2), precise::degF};
+    std::vector<precise_unit> targets;
+    std::vector<double> expected;
+    for (const auto& un : units) {
+        targets.emplace_back(un.base_units());
+        expected.push_back(convert(12.5, un, targets.back()));
+        // fill the cache so the counts below do not depend on which thread misses first
+        cached_converter(un, targets.back());
+    }
+    std::vector<int> errors(4, 0);
+    std::vector<std::thread> threads;
+    for (int tt = 0; tt < 4; ++tt) {
+        threads.emplace_back([&, tt]() {
+            for (int ii = 0; ii < 2000; ++ii) {
+                auto index = static_cast<size_t>(ii + tt) % units.size();
+                if (cached_convert(12.5, units[index], targets[index]) != expected[index]) {
+                    ++errors[tt];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto err : errors) {
+        EXPECT_EQ(err, 0);
+    }
+    auto stats = getConversionCacheStatistics();
+    EXPECT_EQ(stats.misses, units.size());
+    EXPECT_EQ(stats.hits, 8000U);
+    disableConversionCache();
+}
@@ -7,7 +7,11 @@ SPDX-License-Identifier: BSD-3-Clause
 #include "test.hpp"
 #include "units/units.hpp"
 
+#include <atomic>
+#include <string>
+#include <thread>
 #include <type_traits>
+#include <vector>
 
 /*
 unsigned int getCommodity(std::string comm);
@@ -178,3 +182,97 @@ TEST(commodities, unusual_from_string)
     EXPECT_EQ(punit.commodity(), 0u);
     EXPECT_TRUE(precise::custom::is_custom_unit(punit.base_units()));
 }
+
+TEST(commodities, boundedNames)
+{
+    context ctx;
+    ctx.setCommodityNameCapacity(16);
+    for (int ii = 0; ii < 200; ++ii) {
+        getCommodity("zorkcommodity" + std::to_string(ii), ctx);
+    }
+    auto stats = ctx.getCommodityStatistics();
+    EXPECT_EQ(stats.capacity, 16U);
+    EXPECT_LE(stats.names, 16U);
+    EXPECT_GE(stats.evictions, 184U);
+    EXPECT_GT(stats.memory, 0U);
+
+    auto code = getCommodity("zorkcommodity199", ctx);
+    EXPECT_EQ(getCommodityName(code, ctx), "zorkcommodity199");
+    // an evicted name is shown by its code,  which still converts back to the same code
+    auto oldCode = getCommodity("zorkcommodity0", ctx);
+    for (int ii = 200; ii < 400; ++ii) {
+        getCommodity("zorkcommodity" + std::to_string(ii), ctx);
+    }
+    EXPECT_EQ(getCommodity(getCommodityName(oldCode, ctx), ctx), oldCode);
+}
+
+TEST(commodities, longNames)
+{
+    context ctx;
+    auto before = ctx.getCommodityStatistics();
+    std::string longName(100, 'z');
+    auto code = getCommodity(longName, ctx);
+    EXPECT_EQ(getCommodityName(code, ctx), longName);
+    auto stats = ctx.getCommodityStatistics();
+    EXPECT_EQ(stats.rejected, 0U);
+    EXPECT_EQ(stats.names, 1U);
+    // the first name creates the table,  a second long name only adds its own string
+    getCommodity(std::string(200, 'y'), ctx);
+    EXPECT_GE(ctx.getCommodityStatistics().memory, stats.memory + 200U);
+    EXPECT_GE(stats.memory, before.memory + 100U);
+
+    auto unit = unit_from_string("kg{" + longName + "}", ctx);
+    EXPECT_EQ(unit.commodity(), code);
+    EXPECT_EQ(to_string(unit, ctx), "kg{" + longName + "}");
+}
+
+TEST(commodities, longNameEviction)
+{
+    context ctx;
+    ctx.setCommodityNameCapacity(4);
+    for (int ii = 0; ii < 100; ++ii) {
+        getCommodity(std::string(100, 'z') + std::to_string(ii), ctx);
+    }
+    auto stats = ctx.getCommodityStatistics();
+    EXPECT_LE(stats.names, 4U);
+    // only the names that are still stored count in the memory
+    EXPECT_LT(stats.memory, 4096U);
+    auto name = std::string(100, 'z') + "99";
+    EXPECT_EQ(getCommodityName(getCommodity(name, ctx), ctx), name);
+}
+
+TEST(commodities, noNames)
+{
+    context ctx;
+    ctx.setCommodityNameCapacity(0);
+    auto code = getCommodity("zorkcommodity", ctx);
+    EXPECT_EQ(getCommodityName(code, ctx), "CXCOMM[" + std::to_string(code) + "]");
+    ctx.addCustomCommodity("zorkcustom", 4567);
+    EXPECT_EQ(getCommodity("zorkcustom", ctx), 4567U);
+    EXPECT_EQ(ctx.getCommodityStatistics().custom, 1U);
+}
+
+TEST(commodities, concurrentNames)
+{
+    context ctx;
+    ctx.setCommodityNameCapacity(64);
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int tt = 0; tt < 4; ++tt) {
+        threads.emplace_back([&ctx, &failures, tt]() {
+            for (int ii = 0; ii < 500; ++ii) {
+                auto name = "zorkcommodity" + std::to_string(tt * 1000 + ii);
+                auto code = getCommodity(name, ctx);
+                auto stored = getCommodityName(code, ctx);
+                if (stored != name && getCommodity(stored, ctx) != code) {
+                    ++failures;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(failures.load(), 0);
+    EXPECT_LE(ctx.getCommodityStatistics().names, 64U);
+}
@@ -8,6 +8,9 @@ SPDX-License-Identifier: BSD-3-Clause
 #include "test.hpp"
 #include "units/units.hpp"
 
+#include <cmath>
+#include <vector>
+
 static const double neg_forty_C = -40.0;
 static const double neg_forty_C_in_F = -40.0;
 static const double neg_forty_C_in_K = 233.15;
@@ -446,3 +449,161 @@ TEST(quickConvert, const_constexpr)
         quick_convert(2.0, precise::in, precise::cm) == 2.0 * 2.54,
         "results of quick_convert 2 not correct");
 }
+
+// check a converter produces exactly the result of convert, including the sign of zero
+static bool sameResult(double converted, double expected)
+{
+    if (std::isnan(expected)) {
+        return std::isnan(converted);
+    }
+    return converted == expected && std::signbit(converted) == std::signbit(expected);
+}
+
+static const std::vector<units::precise_unit> converterUnits{
+    units::precise::m,
+    units::precise::ft,
+    units::precise::km / units::precise::hr,
+    units::precise::one,
+    units::precise::percent,
+    units::precise::defunit,
+    units::precise::degC,
+    units::precise::degF,
+    units::precise::K,
+    units::precise::temperature::degR,
+    units::precise::J,
+    units::precise::energy::eV,
+    units::precise::rad,
+    units::precise::deg,
+    units::precise::count,
+    units::precise::mol,
+    units::precise::rad / units::precise::s,
+    units::precise::Hz,
+    units::precise::rpm,
+    units::precise::m / units::precise::s,
+    units::precise::s / units::precise::m,
+    units::precise::log::dB,
+    units::precise::log::dB * units::precise::mW,
+    units::precise::log::neper,
+    units::precise::log::bel * units::precise::W,
+    units::precise::mW,
+    units::precise::pu,
+    units::precise::puMW,
+    units::precise::puV,
+    units::precise::puHz,
+    units::precise::puOhm,
+    units::precise::pu * units::precise::A,
+    units::precise::special::mach,
+    units::precise::MW,
+    units::precise::kV,
+    units::precise::ohm,
+    units::precise::A,
+    units::precise::S,
+    units::precise::lb,
+};
+
+static const std::vector<double> converterValues{
+    0.0, -0.0, 1.0, -1.0, 2.5, -40.0, 1e-300, 6.02e23, 1e300, 100.0, std::nan(""), 1.0 / 0.0};
+
+TEST(unitConverter, matchesConvert)
+{
+    using namespace units;
+    for (const auto& start : converterUnits) {
+        for (const auto& result : converterUnits) {
+            unit_converter conv(start, result);
+            unit_converter convf(unit_cast(start), unit_cast(result));
+            unit_converter convpu(start, result, 230.0);
+            unit_converter convpow(start, result, 100.0, 138.0);
+            for (auto val : converterValues) {
+                EXPECT_TRUE(sameResult(conv(val), convert(val, start, result)))
+                    << to_string(start) << "->" << to_string(result) << " " << val;
+                EXPECT_TRUE(sameResult(
+                    convf(val), convert(val, unit_cast(start), unit_cast(result))))
+                    << to_string(start) << "->" << to_string(result) << " " << val;
+                EXPECT_TRUE(sameResult(convpu(val), convert(val, start, result, 230.0)))
+                    << to_string(start) << "->" << to_string(result) << " " << val;
+                EXPECT_TRUE(
+                    sameResult(convpow(val), convert(val, start, result, 100.0, 138.0)))
+                    << to_string(start) << "->" << to_string(result) << " " << val;
+            }
+        }
+    }
+}
+
+TEST(unitConverter, kinds)
+{
+    using namespace units;
+    using kind = unit_converter::kind;
+    EXPECT_EQ(unit_converter(precise::ft, precise::m).conversion_kind(), kind::linear);
+    EXPECT_EQ(unit_converter(precise::degF, precise::degC).conversion_kind(), kind::temperature);
+    EXPECT_EQ(
+        unit_converter(precise::log::dB * precise::mW, precise::mW).conversion_kind(),
+        kind::equation);
+    EXPECT_EQ(unit_converter(precise::s, precise::Hz).conversion_kind(), kind::inverse);
+    EXPECT_EQ(
+        unit_converter(precise::rad / precise::s, precise::Hz).conversion_kind(), kind::counting);
+    EXPECT_EQ(
+        unit_converter(precise::MW, precise::puOhm, 100.0, 138.0).conversion_kind(), kind::general);
+
+    unit_converter invalid(precise::m, precise::kg);
+    EXPECT_FALSE(invalid.is_valid());
+    EXPECT_TRUE(std::isnan(invalid(1.0)));
+    EXPECT_FALSE(unit_converter().is_valid());
+
+    unit_converter temp(precise::degC, precise::degF);
+    EXPECT_DOUBLE_EQ(temp(hundred_C), hundred_C_in_F);
+    EXPECT_DOUBLE_EQ(temp(neg_forty_C), neg_forty_C_in_F);
+}
+
+TEST(arrayConversions, matchScalar)
+{
+    using namespace units;
+    std::vector<double> values;
+    for (int ii = 0; ii < 53; ++ii) {
+        values.push_back((ii - 20) * 3.7 + ii * 1e-3);
+    }
+    values.push_back(-0.0);
+    values.push_back(std::nan(""));
+    std::vector<float> fvalues(values.begin(), values.end());
+    auto original = getSimdLevel();
+    for (int level = 0; level <= static_cast<int>(original); ++level) {
+        EXPECT_EQ(setSimdLevel(static_cast<simd_level>(level)), static_cast<simd_level>(level));
+        for (const auto& start : converterUnits) {
+            for (const auto& result : converterUnits) {
+                std::vector<double> out(values.size());
+                convert(values.data(), out.data(), values.size(), start, result);
+                std::vector<float> fout(fvalues.size());
+                convert(fvalues.data(), fout.data(), fvalues.size(), start, result);
+                for (size_t ii = 0; ii < values.size(); ++ii) {
+                    EXPECT_TRUE(sameResult(out[ii], convert(values[ii], start, result)))
+                        << to_string(start) << "->" << to_string(result) << " " << values[ii]
+                        << " level " << level;
+                    auto expected = static_cast<float>(
+                        convert(static_cast<double>(fvalues[ii]), start, result));
+                    EXPECT_TRUE(sameResult(fout[ii], expected))
+                        << to_string(start) << "->" << to_string(result) << " " << fvalues[ii]
+                        << " level " << level;
+                }
+            }
+        }
+    }
+    setSimdLevel(original);
+    EXPECT_EQ(getSimdLevel(), original);
+}
+
+TEST(arrayConversions, inPlace)
+{
+    using namespace units;
+    std::vector<double> values{32.0, 212.0, -40.0, 98.6, 0.0};
+    convert(values.data(), values.data(), values.size(), precise::degF, precise::degC);
+    EXPECT_DOUBLE_EQ(values[0], 0.0);
+    EXPECT_DOUBLE_EQ(values[1], 100.0);
+    EXPECT_DOUBLE_EQ(values[2], -40.0);
+    EXPECT_NEAR(values[3], 37.0, 1e-12);
+
+    unit_converter conv(precise::ft, precise::m);
+    std::vector<float> lengths(100, 1.0F);
+    conv.convert(lengths.data(), lengths.data(), lengths.size());
+    for (auto len : lengths) {
+        EXPECT_EQ(len, static_cast<float>(0.3048));
+    }
+}
@@ -80,6 +80,23 @@ TEST_P(converterApp, fileConversions)
     }
 }
 
+TEST_P(converterApp, tokenSequence)
+{
+    // the single pass conversion of operator sequences matches splitting at the last operator
+    std::string testFile = TEST_FILE_FOLDER "/test_conversions/";
+    testFile.append(GetParam());
+    testFile.append("_conversions.txt");
+    loadFile(testFile);
+    for (auto& convcode : unit_conv) {
+        for (const auto& name : {convcode.name, convcode.short_name}) {
+            EXPECT_EQ(
+                units::unit_from_string(name),
+                units::unit_from_string(name, units::skip_token_sequence))
+                << name;
+        }
+    }
+}
+
 static const std::vector<std::string> testFiles{
     "energy",
     "distance",
@@ -0,0 +1,55 @@
+/*
+Copyright (c) 2019,
+Lawrence Livermore National Security, LLC;
+See the top-level NOTICE for additional details. All rights reserved.
+SPDX-License-Identifier: BSD-3-Clause
+*/
+
+// this file is compiled for the build machine with floating point contraction so the compiler can fuse the
+// multiplies and adds of the conversions into fused multiply adds
+#include "test.hpp"
+#include "units/units.hpp"
+
+#include <cmath>
+#include <vector>
+
+static bool sameResult(double converted, double expected)
+{
+    if (std::isnan(expected)) {
+        return std::isnan(converted);
+    }
+    return converted == expected && std::signbit(converted) == std::signbit(expected);
+}
+
+static const std::vector<units::precise_unit> temperatureUnits{
+    units::precise::K,
+    units::precise::degC,
+    units::precise::degF,
+    units::precise::temperature::degR,
+    units::precise::temperature::reaumur,
+    units::precise::milli * units::precise::K,
+    units::precise::milli * units::precise::degC,
+    units::precise::kilo * units::precise::degC,
+};
+
+TEST(unitConverterNative, temperatureMatchesConvert)
+{
+    using namespace units;
+    std::vector<double> values{0.0, -0.0, std::nan(""), 1.0 / 0.0};
+    for (int ii = 0; ii < 200; ++ii) {
+        values.push_back((ii - 100) * 1.37 + ii * 1e-3);
+    }
+    for (const auto& start : temperatureUnits) {
+        for (const auto& result : temperatureUnits) {
+            unit_converter conv(start, result);
+            unit_converter convf(unit_cast(start), unit_cast(result));
+            for (auto val : values) {
+                EXPECT_TRUE(sameResult(conv(val), convert(val, start, result)))
+                    << to_string(start) << "->" << to_string(result) << " " << val;
+                EXPECT_TRUE(sameResult(
+                    convf(val), convert(val, unit_cast(start), unit_cast(result))))
+                    << to_string(start) << "->" << to_string(result) << " " << val;
+            }
+        }
+    }
+}
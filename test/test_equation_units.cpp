@@ -8,6 +8,9 @@ SPDX-License-Identifier: BSD-3-Clause
 #include "test.hpp"
 #include "units/units.hpp"
 
+#include <cmath>
+#include <vector>
+
 using namespace units;
 
 TEST(logUnits, nonEquality)
@@ -436,3 +439,109 @@ TEST(otherUnits, unknownEQ)
 
     EXPECT_EQ(convert(1.927, eq18 * precise::W, eq19 * precise::W), 1.927);
 }
+
+// all the equation types along with the power versions of the types that depend on it
+static std::vector<precise_unit> equationUnits()
+{
+    std::vector<precise_unit> eqUnits;
+    for (int eqtype = 0; eqtype < 32; ++eqtype) {
+        eqUnits.push_back(precise_unit(precise::custom::equation_unit(eqtype)));
+        eqUnits.push_back(precise_unit(precise::custom::equation_unit(eqtype)) * precise::W);
+    }
+    return eqUnits;
+}
+
+static bool identical(double val1, double val2)
+{
+    return (std::isnan(val1) && std::isnan(val2)) ||
+        (val1 == val2 && std::signbit(val1) == std::signbit(val2));
+}
+
+// the fast conversions are within a few ulp of the scalar functions
+static bool close(double val, double expected)
+{
+    if (std::isnan(expected) || std::isinf(expected) || expected == 0.0) {
+        return identical(val, expected);
+    }
+    return std::fabs(val - expected) <= 4e-16 * std::fabs(expected) + 1e-300;
+}
+
+TEST(equationArrays, exactAndFast)
+{
+    std::vector<double> levels{-350.0, -30.0, -2.5, -0.0, 0.0, 1e-3, 0.5, 3.0, 7.25, 20.0,
+                               60.0,   150.0, 310.0, std::nan(""), 1.0 / 0.0, -1.0 / 0.0};
+    std::vector<double> linear{0.0,  -0.0, -1.0, 1e-310, 1e-30, 0.01, 0.7,          1.0, 2.0,
+                               55.0, 1e7, 1e300, 1.0 / 0.0, -1.0 / 0.0, std::nan("")};
+    auto original = getSimdLevel();
+    for (int level = 0; level <= static_cast<int>(original); ++level) {
+        setSimdLevel(static_cast<simd_level>(level));
+        for (const auto& eqUnit : equationUnits()) {
+            auto base = eqUnit.base_units();
+            std::vector<double> out(levels.size());
+            precise::equations::convert_equnit_to_value(
+                levels.data(), out.data(), levels.size(), base, equation_accuracy::exact);
+            for (size_t ii = 0; ii < levels.size(); ++ii) {
+                double expected = precise::equations::convert_equnit_to_value(levels[ii], base);
+                EXPECT_TRUE(identical(out[ii], expected))
+                    << precise::custom::eq_type(base) << " " << levels[ii];
+            }
+            precise::equations::convert_equnit_to_value(
+                levels.data(), out.data(), levels.size(), base);
+            for (size_t ii = 0; ii < levels.size(); ++ii) {
+                double expected = precise::equations::convert_equnit_to_value(levels[ii], base);
+                EXPECT_TRUE(close(out[ii], expected))
+                    << precise::custom::eq_type(base) << " " << levels[ii] << " " << out[ii]
+                    << " " << expected;
+            }
+
+            out.resize(linear.size());
+            precise::equations::convert_value_to_equnit(
+                linear.data(), out.data(), linear.size(), base, equation_accuracy::exact);
+            for (size_t ii = 0; ii < linear.size(); ++ii) {
+                double expected = precise::equations::convert_value_to_equnit(linear[ii], base);
+                EXPECT_TRUE(identical(out[ii], expected))
+                    << precise::custom::eq_type(base) << " " << linear[ii];
+            }
+            precise::equations::convert_value_to_equnit(
+                linear.data(), out.data(), linear.size(), base);
+            for (size_t ii = 0; ii < linear.size(); ++ii) {
+                double expected = precise::equations::convert_value_to_equnit(linear[ii], base);
+                EXPECT_TRUE(close(out[ii], expected))
+                    << precise::custom::eq_type(base) << " " << linear[ii] << " " << out[ii]
+                    << " " << expected;
+            }
+        }
+    }
+    setSimdLevel(original);
+}
+
+TEST(equationArrays, converter)
+{
+    std::vector<double> values;
+    for (int ii = 0; ii < 101; ++ii) {
+        values.push_back(-40.0 + ii * 0.9);
+    }
+    std::vector<float> fvalues(values.begin(), values.end());
+    const precise_unit dBm = precise::log::dB * precise::mW;
+    unit_converter conv(dBm, precise::W);
+    std::vector<double> out(values.size());
+    std::vector<float> fout(values.size());
+    conv.convert(values.data(), out.data(), values.size());
+    conv.convert(fvalues.data(), fout.data(), fvalues.size());
+    for (size_t ii = 0; ii < values.size(); ++ii) {
+        EXPECT_TRUE(identical(out[ii], convert(values[ii], dBm, precise::W)));
+        EXPECT_EQ(
+            fout[ii],
+            static_cast<float>(convert(static_cast<double>(fvalues[ii]), dBm, precise::W)));
+    }
+    conv.convert(values.data(), out.data(), values.size(), equation_accuracy::fast);
+    for (size_t ii = 0; ii < values.size(); ++ii) {
+        EXPECT_TRUE(close(out[ii], convert(values[ii], dBm, precise::W)));
+    }
+    unit_converter back(precise::W, precise::log::neper * precise::W);
+    back.convert(out.data(), out.data(), out.size(), equation_accuracy::fast);
+    for (size_t ii = 0; ii < values.size(); ++ii) {
+        EXPECT_NEAR(
+            out[ii], convert(values[ii], dBm, precise::log::neper * precise::W), 1e-12);
+    }
+}
@@ -0,0 +1,165 @@
+/*
+Copyright (c) 2019,
+Lawrence Livermore National Security, LLC;
+See the top-level NOTICE for additional details. All rights reserved.
+SPDX-License-Identifier: BSD-3-Clause
+*/
+#include "test.hpp"
+#include "units/measurement_reader.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace units;
+
+// read all the measurements of some text checking the chunks arrive in order
+static std::vector<precision_measurement>
+    readAll(const std::string& text, const measurement_reader_options& options)
+{
+    std::vector<precision_measurement> measurements;
+    auto rows = read_measurements(
+        text.data(),
+        text.size(),
+        options,
+        [&measurements](size_t first_row, const std::vector<precision_measurement>& chunk) {
+            EXPECT_EQ(first_row, measurements.size());
+            measurements.insert(measurements.end(), chunk.begin(), chunk.end());
+        });
+    EXPECT_EQ(rows, measurements.size());
+    return measurements;
+}
+
+TEST(measurementReader, measurementCells)
+{
+    measurement_reader_options options;
+    options.measurement_column = 1;
+    options.header_rows = 1;
+    auto measurements =
+        readAll("id,mass\n1,12.5 kg\r\n2, 3e2 g \n\n3,\"7 lb\"\n4,2.5\n5,four\n", options);
+    ASSERT_EQ(measurements.size(), 5U);
+    EXPECT_EQ(measurements[0], precision_measurement(12.5, precise::kg));
+    EXPECT_EQ(measurements[1], precision_measurement(300.0, precise::g));
+    EXPECT_EQ(measurements[2], precision_measurement(7.0, precise::lb));
+    EXPECT_EQ(measurements[3], precision_measurement(2.5, precise::one));
+    EXPECT_FALSE(is_valid(measurements[4].units()));
+}
+
+TEST(measurementReader, valueAndUnitColumns)
+{
+    measurement_reader_options options;
+    options.delimiter = ';';
+    options.value_column = 2;
+    options.unit_column = 0;
+    auto measurements = readAll("m;x;1.25\nft/s;y;-0.5e-3\n\"\"\"\";z;4\nkg;w\n", options);
+    ASSERT_EQ(measurements.size(), 4U);
+    EXPECT_EQ(measurements[0], precision_measurement(1.25, precise::m));
+    EXPECT_EQ(measurements[1], precision_measurement(-0.5e-3, precise::ft / precise::s));
+    EXPECT_EQ(measurements[2], precision_measurement(4.0, precise::angle::arcsec));
+    EXPECT_TRUE(std::isnan(measurements[3].value()));
+}
+
+TEST(measurementReader, numbers)
+{
+    measurement_reader_options options;
+    options.value_column = 0;
+    auto measurements = readAll(
+        "0.1\n123456789012345678\n1e300\n-0\n.5\n7.\n0.000000000000000000000000001\n", options);
+    ASSERT_EQ(measurements.size(), 7U);
+    EXPECT_EQ(measurements[0].value(), 0.1);
+    EXPECT_EQ(measurements[1].value(), 123456789012345678.0);
+    EXPECT_EQ(measurements[2].value(), 1e300);
+    EXPECT_EQ(measurements[3].value(), 0.0);
+    EXPECT_EQ(measurements[4].value(), 0.5);
+    EXPECT_EQ(measurements[5].value(), 7.0);
+    EXPECT_DOUBLE_EQ(measurements[6].value(), 1e-27);
+}
+
+TEST(measurementReader, chunksInOrder)
+{
+    static const std::vector<std::string> unitStrings{"m", "kg", "ft", "lb", "s", "N*m"};
+    std::string text;
+    for (int ii = 0; ii < 20000; ++ii) {
+        text += std::to_string(ii) + ' ' + unitStrings[ii % unitStrings.size()] + '\n';
+    }
+    measurement_reader_options options;
+    options.chunk_bytes = 1000;
+    options.threads = 4;
+    auto measurements = readAll(text, options);
+    ASSERT_EQ(measurements.size(), 20000U);
+    for (int ii = 0; ii < 20000; ++ii) {
+        EXPECT_EQ(measurements[ii].value(), static_cast<double>(ii));
+        EXPECT_EQ(
+            measurements[ii].units(), unit_from_string(unitStrings[ii % unitStrings.size()]));
+    }
+}
+
+TEST(measurementReader, handlerThrows)
+{
+    std::string text;
+    for (int ii = 0; ii < 20000; ++ii) {
+        text += std::to_string(ii) + " m\n";
+    }
+    measurement_reader_options options;
+    options.chunk_bytes = 1000;
+    options.threads = 4;
+    size_t calls{0};
+    auto handler = [&calls](size_t first_row, const std::vector<precision_measurement>&) {
+        ++calls;
+        if (first_row > 5000) {
+            throw std::runtime_error("handler failure");
+        }
+    };
+    EXPECT_THROW(read_measurements(text.data(), text.size(), options, handler), std::runtime_error);
+    EXPECT_GT(calls, 1U);
+    // the reader can be used again after an exception
+    EXPECT_EQ(readAll(text, options).size(), 20000U);
+}
+
+TEST(measurementReader, file)
+{
+    const char* fileName = "measurement_reader_test.csv";
+    {
+        std::ofstream out(fileName);
+        out << "value,unit\n";
+        for (int ii = 0; ii < 1000; ++ii) {
+            out << ii << ",mm\n";
+        }
+    }
+    measurement_reader_options options;
+    options.value_column = 0;
+    options.unit_column = 1;
+    options.header_rows = 1;
+    double total{0.0};
+    size_t count{0};
+    EXPECT_TRUE(read_measurement_file(
+        fileName,
+        options,
+        [&](size_t /*first_row*/, const std::vector<precision_measurement>& chunk) {
+            for (const auto& meas : chunk) {
+                total += meas.value_as(precise::m);
+                ++count;
+            }
+        }));
+    EXPECT_EQ(count, 1000U);
+    EXPECT_NEAR(total, 499.5, 1e-9);
+
+    size_t bytes{1};
+    EXPECT_TRUE(read_measurement_file(
+        fileName, options, [](size_t, const std::vector<precision_measurement>&) {}, bytes));
+    // the header and 10 rows of 5 bytes,  90 of 6,  900 of 7
+    EXPECT_EQ(bytes, 11U + 10U * 5U + 90U * 6U + 900U * 7U);
+    std::remove(fileName);
+
+    EXPECT_FALSE(read_measurement_file(
+        "missing_file.csv", options, [](size_t, const std::vector<precision_measurement>&) {}));
+    EXPECT_FALSE(read_measurement_file(
+        "missing_file.csv",
+        options,
+        [](size_t, const std::vector<precision_measurement>&) {},
+        bytes));
+    EXPECT_EQ(bytes, 0U);
+}
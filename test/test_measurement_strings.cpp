@@ -7,7 +7,14 @@ SPDX-License-Identifier: BSD-3-Clause
 #include "test.hpp"
 #include "units/units.hpp"
 
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
 #include <type_traits>
+#include <vector>
 
 using namespace units;
 TEST(MeasurementStrings, basic)
@@ -51,3 +58,64 @@ TEST(MeasurementToString, simple)
     measurement_f meas_f2(45.0f, m);
     EXPECT_EQ(to_string(meas_f2), "45 m");
 }
+
+// format a value into a buffer and return the text
+template<typename X>
+static std::string formatted(X value, size_t size = 64)
+{
+    std::vector<char> buffer(size);
+    char* end = format_to(buffer.data(), buffer.data() + buffer.size(), value);
+    return (end == nullptr) ? std::string("overflow") : std::string(buffer.data(), end);
+}
+
+TEST(MeasurementFormat, numbers)
+{
+    EXPECT_EQ(formatted(45.0), "45");
+    EXPECT_EQ(formatted(0.1), "0.1");
+    EXPECT_EQ(formatted(-2.5), "-2.5");
+    EXPECT_EQ(formatted(0.0), "0");
+    EXPECT_EQ(formatted(-0.0), "-0");
+    EXPECT_EQ(formatted(0.0003), "0.0003");
+    EXPECT_EQ(formatted(1.5e-7), "1.5e-7");
+    EXPECT_EQ(formatted(6.02214076e23), "6.02214076e23");
+    EXPECT_EQ(formatted(5e-324), "5e-324");
+    EXPECT_EQ(formatted(1.7976931348623157e308), "1.7976931348623157e308");
+    EXPECT_EQ(formatted(0.1f), "0.1");
+    EXPECT_EQ(formatted(1.0f / 3.0f), "0.33333334");
+    EXPECT_EQ(formatted(std::numeric_limits<double>::infinity()), "inf");
+    EXPECT_EQ(formatted(-std::numeric_limits<double>::infinity()), "-inf");
+    EXPECT_EQ(formatted(std::numeric_limits<double>::quiet_NaN()), "nan");
+    EXPECT_EQ(formatted(123.456, 7), "123.456");
+    EXPECT_EQ(formatted(123.456, 6), "overflow");
+}
+
+TEST(MeasurementFormat, roundTrip)
+{
+    std::mt19937_64 gen(12345);
+    for (int ii = 0; ii < 100000; ++ii) {
+        auto bits = gen();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        if (!std::isfinite(value)) {
+            continue;
+        }
+        auto str = formatted(value);
+        EXPECT_EQ(std::strtod(str.c_str(), nullptr), value) << str;
+    }
+}
+
+TEST(MeasurementFormat, measurements)
+{
+    EXPECT_EQ(formatted(precision_measurement(45.0, precise::m)), "45 m");
+    EXPECT_EQ(formatted(precision_measurement(0.1, precise::kg / precise::m.pow(3))), "0.1 g/L");
+    EXPECT_EQ(formatted(45.0 * m), "45 m");
+    EXPECT_EQ(formatted(measurement_f(2.5f, V)), "2.5 V");
+    EXPECT_EQ(formatted(precision_measurement(45.0, precise::m), 3), "overflow");
+
+    enableUnitFormatCache(16);
+    auto meas = precision_measurement(9.81, precise::m / precise::s.pow(2));
+    EXPECT_EQ(formatted(meas), "9.81 " + to_string(meas.units()));
+    EXPECT_EQ(formatted(meas), "9.81 " + to_string(meas.units()));
+    EXPECT_GE(getUnitFormatCacheStatistics().hits, 2U);
+    disableUnitFormatCache();
+}
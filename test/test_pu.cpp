@@ -8,6 +8,10 @@ SPDX-License-Identifier: BSD-3-Clause
 #include "test.hpp"
 #include "units/units.hpp"
 
+#include <cmath>
+#include <utility>
+#include <vector>
+
 using namespace units;
 
 TEST(PU, basic)
@@ -112,3 +116,133 @@ TEST(PU, conversions)
 
     EXPECT_NEAR(convert(0.2, puOhm, puMW, 100.0), 5.0, 0.0001);
 }
+
+static bool sameBatchResult(double v1, double v2)
+{
+    return (std::isnan(v1) && std::isnan(v2)) || v1 == v2;
+}
+
+TEST(PU, batchConversions)
+{
+    const std::vector<std::pair<precise_unit, precise_unit>> pairs{
+        {precise::puMW, precise::MW},
+        {precise::MW, precise::puMW},
+        {precise::kilo * precise::V, precise::pu},
+        {precise::pu, precise::MW},
+        {precise::pu, precise::ohm},
+        {precise::kW, precise::puA},
+        {precise::puOhm, precise::S},
+        {precise::pu * precise::m, precise::pu * precise::m},
+        {precise::pu * precise::m, precise::pu * precise::mm},
+        {precise::puMW, precise::puA},
+        {precise::puV, precise::ft},
+        {precise::ohm, precise::defunit},
+        {precise::in, precise::cm},
+        {precise::puMW, precise::kilo * precise::pu * precise::W}};
+    const std::vector<double> values{4.5, -0.2, 0.0, 1.0, 136.0, 1e-7, 2.5e6};
+    const std::vector<double> powers{100.0, 50.0, 0.5, 100.0, 25.0, 1000.0, 1.0};
+    const std::vector<double> voltages{138.0, 13.8, 0.48, 765.0, 80000.0, 69.0, 4.16};
+    std::vector<double> results(values.size());
+    const auto level = getSimdLevel();
+    for (auto simd : {simd_level::scalar, simd_level::avx2, simd_level::avx512}) {
+        setSimdLevel(simd);
+        for (const auto& pr : pairs) {
+            convert(
+                values.data(),
+                results.data(),
+                values.size(),
+                pr.first,
+                pr.second,
+                powers.data(),
+                voltages.data());
+            for (size_t ii = 0; ii < values.size(); ++ii) {
+                EXPECT_TRUE(sameBatchResult(
+                    results[ii],
+                    convert(values[ii], pr.first, pr.second, powers[ii], voltages[ii])))
+                    << to_string(pr.first) << " to " << to_string(pr.second) << " at " << ii;
+            }
+            convert(
+                values.data(),
+                results.data(),
+                values.size(),
+                unit_cast(pr.first),
+                unit_cast(pr.second),
+                100.0,
+                voltages.data());
+            for (size_t ii = 0; ii < values.size(); ++ii) {
+                EXPECT_TRUE(sameBatchResult(
+                    results[ii],
+                    convert(
+                        values[ii],
+                        unit_cast(pr.first),
+                        unit_cast(pr.second),
+                        100.0,
+                        voltages[ii])))
+                    << to_string(pr.first) << " to " << to_string(pr.second) << " at " << ii;
+            }
+        }
+    }
+    setSimdLevel(level);
+}
+
+TEST(PU, batchMissingBases)
+{
+    const std::vector<std::pair<precise_unit, precise_unit>> pairs{
+        {precise::puV, precise::puV},
+        {precise::puOhm, precise::puOhm},
+        {precise::puMW, precise::puMW},
+        {precise::puA, precise::puA},
+        {precise::kilo * precise::puV, precise::puV},
+        {precise::puMW, precise::kilo * precise::pu * precise::W},
+        {precise::puV, precise::kV},
+        {precise::puOhm, precise::ohm}};
+    const double nan = std::nan("");
+    const std::vector<double> values{2.0, 2.0, 0.5, -1.5, 3.0, 4.0, 1.0};
+    const std::vector<double> powers{100.0, nan, 0.0, 100.0, 0.0, nan, 25.0};
+    const std::vector<double> voltages{nan, 138.0, 0.0, 0.0, 13.8, nan, 69.0};
+    std::vector<double> results(values.size());
+    for (const auto& pr : pairs) {
+        per_unit_converter conv(pr.first, pr.second, powers.data(), voltages.data(), values.size());
+        conv.convert(values.data(), results.data());
+        for (size_t ii = 0; ii < values.size(); ++ii) {
+            EXPECT_TRUE(sameBatchResult(
+                results[ii], convert(values[ii], pr.first, pr.second, powers[ii], voltages[ii])))
+                << to_string(pr.first) << " to " << to_string(pr.second) << " at " << ii;
+        }
+        // in place
+        auto inPlace = values;
+        conv.convert(inPlace.data(), inPlace.data());
+        for (size_t ii = 0; ii < values.size(); ++ii) {
+            EXPECT_TRUE(sameBatchResult(inPlace[ii], results[ii]))
+                << to_string(pr.first) << " to " << to_string(pr.second) << " at " << ii;
+        }
+    }
+    per_unit_converter conv(precise::puV, precise::puV, 100.0, voltages.data(), 1);
+    double result{0.0};
+    const double value{2.0};
+    conv.convert(&value, &result);
+    EXPECT_TRUE(std::isnan(result));
+    EXPECT_TRUE(std::isnan(convert(2.0, precise::puV, precise::puV, 100.0, nan)));
+}
+
+TEST(PU, batchThreads)
+{
+    const size_t buses{100000};
+    std::vector<double> values(buses);
+    std::vector<double> voltages(buses);
+    for (size_t ii = 0; ii < buses; ++ii) {
+        values[ii] = 0.9 + static_cast<double>(ii % 200) * 0.001;
+        voltages[ii] = 12.47 + static_cast<double>(ii % 37) * 3.1;
+    }
+    per_unit_converter conv(precise::puV, precise::kV, 100.0, voltages.data(), buses);
+    EXPECT_EQ(conv.size(), buses);
+    std::vector<double> single(buses);
+    std::vector<double> threaded(buses);
+    conv.convert(values.data(), single.data());
+    conv.convert(values.data(), threaded.data(), 4);
+    EXPECT_EQ(single, threaded);
+    EXPECT_EQ(single[17], convert(values[17], precise::puV, precise::kV, 100.0, voltages[17]));
+    // in place with every processor
+    conv.convert(values.data(), values.data(), 0);
+    EXPECT_EQ(values, single);
+}
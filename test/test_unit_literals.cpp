@@ -0,0 +1,57 @@
+/*
+Copyright (c) 2019,
+Lawrence Livermore National Security, LLC;
+See the top-level NOTICE for additional details. All rights reserved.
+SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#include "test.hpp"
+#include "units/unit_literals.hpp"
+#include "units/units.hpp"
+
+using namespace units;
+using namespace units::literals;
+
+TEST(unitLiterals, compileTime)
+{
+    constexpr precise_unit force = "kg.m/s2"_punit;
+    static_assert(force.has_same_base(precise::N), "literal is not evaluated at compile time");
+    EXPECT_EQ(force, precise::N);
+
+    constexpr unit speed = "km/h"_unit;
+    static_assert(speed.has_same_base(m / s), "literal is not evaluated at compile time");
+    EXPECT_EQ(speed, km / hr);
+}
+
+TEST(unitLiterals, matchStringConversion)
+{
+    EXPECT_EQ("mmol/L"_punit, unit_from_string("mmol/L"));
+    EXPECT_EQ("kg.m2/(s3.A)"_punit, unit_from_string("kg.m2/(s3.A)"));
+    EXPECT_EQ("/s"_punit, unit_from_string("/s"));
+    EXPECT_EQ("10.cm3"_punit, unit_from_string("10.cm3"));
+    EXPECT_EQ("m-1"_punit, unit_from_string("m-1"));
+    EXPECT_EQ("ug/dL"_punit, unit_from_string("ug/dL"));
+    EXPECT_EQ("daL"_punit, unit_from_string("daL"));
+    EXPECT_EQ("mW.h"_punit, unit_from_string("mW.h"));
+    EXPECT_EQ("GBq/min"_punit, unit_from_string("GBq/min"));
+}
+
+TEST(unitLiterals, precedence)
+{
+    // unit symbols are matched before prefixed units
+    EXPECT_EQ("cd"_punit, precise::cd);
+    EXPECT_EQ("Pa"_punit, precise::Pa);
+    EXPECT_EQ("min"_punit, precise::min);
+    EXPECT_EQ("Tm"_punit, precise_unit(1e12, precise::m));
+}
+
+TEST(unitLiterals, malformed)
+{
+    // malformed literals are a compile error in a constant expression and invalid otherwise
+    EXPECT_FALSE(is_valid("kg.m/s^2"_punit));
+    EXPECT_FALSE(is_valid("kmin"_punit));
+    EXPECT_FALSE(is_valid("(m.s"_punit));
+    EXPECT_FALSE(is_valid("m/"_punit));
+    EXPECT_FALSE(is_valid(""_punit));
+    EXPECT_FALSE(is_valid("m s"_unit));
+}
@@ -8,6 +8,11 @@ SPDX-License-Identifier: BSD-3-Clause
 
 #include "test.hpp"
 
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
 using namespace units;
 TEST(unitStrings, Simple)
 {
@@ -215,6 +220,32 @@ TEST(stringToUnits, Div)
     EXPECT_EQ(precise::m, unit_from_string("m*m/m*m/m"));
 }
 
+TEST(stringToUnits, tokenSequence)
+{
+    EXPECT_EQ(precise::V, unit_from_string("kg*m2/s3/A"));
+    EXPECT_EQ(precise::V, unit_from_string("kg*m^2/s^3/A"));
+    EXPECT_EQ(precise::m / precise::s.pow(2) * precise::kg, unit_from_string("m/s^2*kg"));
+    EXPECT_EQ(precise::ft * precise::lb / precise::s, unit_from_string("[ft_i]*[lb_av]/s"));
+    EXPECT_EQ(precise::W * precise::m.pow(-2), unit_from_string("W/m^2"));
+    EXPECT_EQ(precise::kg / precise::m.pow(3), unit_from_string("kilograms/meter3"));
+    EXPECT_EQ(precise::N * precise::s / precise::m, unit_from_string("N*s/m*m^-1*m"));
+    EXPECT_FALSE(is_valid(unit_from_string("m*not_a_unit_name/s")));
+}
+
+TEST(stringToUnits, codeReplacements)
+{
+    EXPECT_EQ(precise::m.pow(2), unit_from_string("sq.metre"));
+    EXPECT_EQ(precise::L / precise::m.pow(3), unit_from_string("litre/cu.metre"));
+    EXPECT_EQ(precise::A * precise::s, unit_from_string("ampere-second"));
+    EXPECT_EQ(precise::m.pow(2), unit_from_string("m\xb2"));
+    EXPECT_EQ(precise::m / precise::s.pow(2), unit_from_string("m\xb7s-\xb2"));
+    // overlapping patterns are resolved in table order
+    EXPECT_EQ(unit_from_string("Britishthermalunits/degrees"), unit_from_string("BTU/deg"));
+    // a replacement that forms another pattern is replaced again
+    EXPECT_EQ(precise::N / precise::m.pow(2), unit_from_string("N/sq.*metre"));
+    EXPECT_EQ(precise::m.pow(3) / precise::s, unit_from_string("cu.metre/s"));
+}
+
 TEST(stringToUnits, SIprefix)
 {
     EXPECT_EQ(precise_unit(1e18, precise::W), unit_from_string("EW"));
@@ -347,6 +378,52 @@ TEST(stringToUnits, interestingUnits)
     EXPECT_EQ(unit, precise_unit(1e21, precise::m));
 }
 
+TEST(stringToUnits, caseInsensitiveIndex)
+{
+    EXPECT_EQ(unit_from_string("ACRE_BR", case_insensitive), unit_from_string("acre_br"));
+    EXPECT_EQ(unit_from_string("BOARDFEET_I", case_insensitive), unit_from_string("boardfeet_i"));
+    EXPECT_EQ(unit_from_string("Tablespoon_US", case_insensitive), precise::us::tbsp);
+    // UCUM prefixes take precedence over other units with the same case insensitive form
+    EXPECT_EQ(unit_from_string("FL", case_insensitive), precise_unit(1e-15, precise::L));
+    EXPECT_EQ(unit_from_string("NS", case_insensitive), precise_unit(1e-9, precise::s));
+    EXPECT_EQ(unit_from_string("PA", case_insensitive), precise_unit(1e-12, precise::A));
+}
+
+TEST(stringToUnits, caseInsensitiveIndexRegressions)
+{
+    // strings the regular conversion already matches are not overridden by the index
+    EXPECT_EQ(unit_from_string("$/gals", case_insensitive), unit_from_string("$/gal"));
+    EXPECT_EQ(unit_from_string("GALS", case_insensitive), precise::us::gallon);
+    EXPECT_EQ(unit_from_string("ABH", case_insensitive), precise_unit(1e9, precise::Wb));
+    // short keys do not turn into factors of a product
+    EXPECT_FALSE(is_valid(unit_from_string("E", case_insensitive)));
+    EXPECT_FALSE(is_valid(unit_from_string("GLE", case_insensitive)));
+    EXPECT_FALSE(is_valid(unit_from_string("ANGLE", case_insensitive)));
+    // new matches are only made for strings with upper case characters
+    EXPECT_FALSE(is_valid(unit_from_string("acre_br", case_insensitive)));
+    EXPECT_FALSE(is_valid(measurement_from_string("3 acre_br", case_insensitive).units()));
+    // strings the steps resolve are not changed by the index
+    EXPECT_EQ(to_string(unit_from_string("{CELLS}S", case_insensitive)), "s{cell}");
+}
+
+TEST(stringToUnits, caseInsensitiveIndexTokens)
+{
+    // the index matches the tokens of a larger string
+    EXPECT_EQ(
+        unit_from_string("ACRE_BR/S", case_insensitive), unit_from_string("acre_br") / precise::s);
+    EXPECT_EQ(
+        unit_from_string("M2/ACRE_BR", case_insensitive),
+        precise::m.pow(2) / unit_from_string("acre_br"));
+    EXPECT_EQ(
+        measurement_from_string("3 ACRE_BR", case_insensitive),
+        precision_measurement(3.0, unit_from_string("acre_br")));
+    // other flags can be combined with case insensitive matching
+    EXPECT_EQ(
+        unit_from_string("ACRE_BR", case_insensitive | single_slash), unit_from_string("acre_br"));
+    EXPECT_FALSE(
+        is_valid(unit_from_string("ACRE_BR", case_insensitive | skip_case_insensitive_index)));
+}
+
 TEST(stringToUnits, customUnitforms)
 {
     auto unit = unit_from_string("{APS'U}");
@@ -534,6 +611,70 @@ TEST(fileops, UnicodeFile)
     EXPECT_EQ(uni, precise::kg * precise::micro);
 }
 
+TEST(fileops, codeReplacementsOnePass)
+{
+    std::vector<std::string> edgeCases{"N/sq.*metre",
+                                       "Britishthermalunits/degrees",
+                                       "\\\xb2sq.--US",
+                                       "m-\xb2\xb2",
+                                       "10-10^+sq.cu.",
+                                       u8"kg\u0301\u0301\u00b2-\u00b3"};
+    for (const auto& test : edgeCases) {
+        EXPECT_TRUE(detail::testing::testCodeReplacements(test)) << test;
+    }
+    for (const char* file : {TEST_FILE_FOLDER "/test_units_unicode.txt",
+                             TEST_FILE_FOLDER "/test_units_unicode_u8.txt",
+                             TEST_FILE_FOLDER "/example_ucum_codes.csv",
+                             TEST_FILE_FOLDER "/UDUNITS2/udunits2-accepted.xml",
+                             TEST_FILE_FOLDER "/UDUNITS2/udunits2-common.xml",
+                             TEST_FILE_FOLDER "/UDUNITS2/udunits2-derived.xml"}) {
+        std::ifstream input(file);
+        ASSERT_TRUE(input) << file;
+        std::string line;
+        while (std::getline(input, line)) {
+            EXPECT_TRUE(detail::testing::testCodeReplacements(line)) << line;
+            // the fields on their own
+            std::istringstream fields(line);
+            std::string field;
+            while (std::getline(fields, field, ',')) {
+                EXPECT_TRUE(detail::testing::testCodeReplacements(field)) << field;
+            }
+        }
+    }
+}
+
+TEST(fileops, tokenSequenceCorpora)
+{
+    // the single pass conversion of operator sequences matches splitting at the last operator
+    std::vector<std::string> sequences{"kg*m/s^2",
+                                       "m/s/s",
+                                       "N*m2/kg2",
+                                       "kg/m3*s",
+                                       "mW/cm2/sr",
+                                       "[lb_av]/[ft_i]/s",
+                                       "lb/ft2/s",
+                                       "J/kg/K/mol"};
+    for (const auto& test : sequences) {
+        EXPECT_EQ(unit_from_string(test), unit_from_string(test, skip_token_sequence)) << test;
+    }
+    std::ifstream input(TEST_FILE_FOLDER "/example_ucum_codes.csv");
+    ASSERT_TRUE(input);
+    std::string line;
+    while (std::getline(input, line)) {
+        std::istringstream fields(line);
+        std::string field;
+        while (std::getline(fields, field, ',')) {
+            auto unit = unit_from_string(field);
+            auto split = unit_from_string(field, skip_token_sequence);
+            if (is_error(unit)) {
+                EXPECT_TRUE(is_error(split)) << field;
+            } else {
+                EXPECT_EQ(unit, split) << field;
+            }
+        }
+    }
+}
+
 TEST(stringToUnits, invalid)
 {
     auto u1 = unit_from_string("{(test}");
@@ -605,6 +746,165 @@ TEST(userDefinedUnits, clearDefs)
     EXPECT_NE(to_string(clucks), "clucks");
 }
 
+TEST(userDefinedUnits, batch)
+{
+    precise_unit clucks(19.3, precise::m * precise::A);
+    precise_unit blargs(4.2, precise::kg / precise::s);
+    addUserDefinedUnits({{"clucks", clucks}, {"blargs", blargs}});
+
+    EXPECT_EQ(unit_from_string("clucks/A"), precise_unit(19.3, precise::m));
+    EXPECT_EQ(unit_from_string("blargs*s"), precise_unit(4.2, precise::kg));
+    EXPECT_EQ(to_string(blargs), "blargs");
+    clearUserDefinedUnits();
+    EXPECT_FALSE(is_valid(unit_from_string("blargs")));
+}
+
+TEST(userDefinedUnits, toStringNames)
+{
+    precise_unit clucks(19.3, precise::m * precise::A);
+    precise_unit blargs(4.2, precise::kg / precise::s);
+    addUserDefinedUnit("clucks", clucks);
+    addUserDefinedUnit("blargs", blargs);
+    // the latest definition of a unit gives its name
+    addUserDefinedUnit("clucks2", clucks);
+
+    EXPECT_EQ(to_string(clucks), "clucks2");
+    EXPECT_EQ(to_string(clucks / precise::s), "clucks2/s");
+    EXPECT_EQ(to_string(blargs.inv()), "1/blargs");
+    EXPECT_EQ(to_string(precise::kg), "kg");
+    clearUserDefinedUnits();
+    EXPECT_EQ(to_string(clucks / precise::s).find("clucks"), std::string::npos);
+}
+
+TEST(userDefinedUnits, concurrentRegistration)
+{
+    std::atomic<bool> done{false};
+    std::atomic<int> failures{0};
+    std::vector<std::thread> readers;
+    for (int tt = 0; tt < 3; ++tt) {
+        readers.emplace_back([&]() {
+            while (!done.load()) {
+                if (unit_from_string("kg*m/s^2") != precise::N) {
+                    ++failures;
+                }
+                auto unit = unit_from_string("zork7/m");
+                if (is_valid(unit) && unit != precise_unit(7.0, precise::one)) {
+                    ++failures;
+                }
+            }
+        });
+    }
+    for (int ii = 0; ii < 40; ++ii) {
+        addUserDefinedUnit("zork" + std::to_string(ii), precise_unit(ii, precise::m));
+    }
+    done.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(failures.load(), 0);
+    EXPECT_EQ(unit_from_string("zork7/m"), precise_unit(7.0, precise::one));
+    clearUserDefinedUnits();
+}
+
+TEST(userDefinedUnits, partition)
+{
+    precise_unit clucks(19.3, precise::m * precise::A);
+    addUserDefinedUnit("clucks", clucks);
+
+    EXPECT_EQ(unit_from_string("cluckskg"), clucks * precise::kg);
+    EXPECT_EQ(unit_from_string("kgclucks"), precise::kg * clucks);
+
+    clearUserDefinedUnits();
+    EXPECT_FALSE(is_valid(unit_from_string("cluckskg")));
+}
+
+TEST(unitContext, userUnits)
+{
+    precise_unit clucks(19.3, precise::m * precise::A);
+    context ctx;
+    ctx.addUserDefinedUnit("clucks", clucks);
+
+    EXPECT_EQ(unit_from_string("clucks", ctx), clucks);
+    EXPECT_EQ(unit_from_string("cluckskg", ctx), clucks * precise::kg);
+    EXPECT_EQ(to_string(clucks, ctx), "clucks");
+    EXPECT_FALSE(is_valid(unit_from_string("clucks")));
+    EXPECT_NE(to_string(clucks), "clucks");
+
+    ctx.disableUserDefinedUnits();
+    ctx.addUserDefinedUnit("blarg", precise::m);
+    EXPECT_FALSE(is_valid(unit_from_string("blarg", ctx)));
+    ctx.enableUserDefinedUnits();
+    ctx.clearUserDefinedUnits();
+    EXPECT_FALSE(is_valid(unit_from_string("clucks", ctx)));
+}
+
+TEST(unitContext, commodities)
+{
+    context ctx;
+    ctx.addCustomCommodity("zorkstuff", 4567);
+    EXPECT_EQ(getCommodity("zorkstuff", ctx), 4567U);
+    EXPECT_EQ(getCommodityName(4567, ctx), "zorkstuff");
+    EXPECT_NE(getCommodity("zorkstuff"), 4567U);
+    EXPECT_EQ(unit_from_string("kg{zorkstuff}", ctx).commodity(), 4567U);
+
+    ctx.clearCustomCommodities();
+    EXPECT_NE(getCommodity("zorkstuff", ctx), 4567U);
+}
+
+TEST(unitContext, cache)
+{
+    context ctx;
+    ctx.enableUnitStringCache(64);
+    EXPECT_EQ(unit_from_string("kg*m/s^2", ctx), precise::N);
+    EXPECT_EQ(unit_from_string("kg*m/s^2", ctx), precise::N);
+    auto stats = ctx.getUnitStringCacheStatistics();
+    EXPECT_EQ(stats.hits, 1U);
+    EXPECT_EQ(stats.misses, 1U);
+    EXPECT_EQ(getUnitStringCacheStatistics().size, 0U);
+    ctx.disableUnitStringCache();
+    EXPECT_EQ(ctx.getUnitStringCacheStatistics().capacity, 0U);
+}
+
+TEST(unitContext, scope)
+{
+    context outer;
+    context inner;
+    outer.addUserDefinedUnit("zorkout", precise::m);
+    inner.addUserDefinedUnit("zorkin", precise::s);
+    {
+        context::scope active(outer);
+        EXPECT_EQ(context::current(), &outer);
+        EXPECT_EQ(unit_from_string("zorkout"), precise::m);
+        EXPECT_EQ(unit_from_string("zorkin", inner), precise::s);
+        EXPECT_FALSE(is_valid(unit_from_string("zorkin")));
+        EXPECT_EQ(unit_from_string("zorkout"), precise::m);
+    }
+    EXPECT_EQ(context::current(), nullptr);
+    EXPECT_FALSE(is_valid(unit_from_string("zorkout")));
+}
+
+TEST(unitContext, parallelTenants)
+{
+    std::atomic<int> failures{0};
+    std::vector<std::thread> tenants;
+    for (int tt = 0; tt < 4; ++tt) {
+        tenants.emplace_back([&failures, tt]() {
+            context ctx;
+            precise_unit tenantUnit(tt + 2.0, precise::m);
+            ctx.addUserDefinedUnit("zorkunit", tenantUnit);
+            for (int ii = 0; ii < 200; ++ii) {
+                if (unit_from_string("zorkunit/s", ctx) != tenantUnit / precise::s) {
+                    ++failures;
+                }
+            }
+        });
+    }
+    for (auto& tenant : tenants) {
+        tenant.join();
+    }
+    EXPECT_EQ(failures.load(), 0);
+}
+
 TEST(defaultUnits, unitTypes)
 {
     EXPECT_EQ(default_unit("impedance quantity"), precise::ohm);
@@ -708,3 +1008,130 @@ TEST(defaultUnits, singleCharacter)
     EXPECT_EQ(precise::cd, default_unit("J"));
     EXPECT_EQ(precise::K, default_unit("\xC8"));
 }
+
+TEST(stringBatch, duplicates)
+{
+    std::vector<std::string> ustrings{"m/s", "kg", "m/s", "N*m", "kg", "m/s", "bad_unit_string", ""};
+    auto units = unit_from_string_batch(ustrings);
+    ASSERT_EQ(units.size(), ustrings.size());
+    for (size_t ii = 0; ii < ustrings.size(); ++ii) {
+        auto expected = unit_from_string(ustrings[ii]);
+        if (is_valid(expected)) {
+            EXPECT_EQ(units[ii], expected) << ustrings[ii];
+        } else {
+            EXPECT_FALSE(is_valid(units[ii])) << ustrings[ii];
+        }
+    }
+}
+
+TEST(stringBatch, manyDistinct)
+{
+    std::vector<std::string> ustrings;
+    for (int ii = 0; ii < 3000; ++ii) {
+        ustrings.push_back(std::to_string(ii % 1000) + ((ii % 2 == 0) ? "kg{zzbatch}/s" : "ft^2"));
+    }
+    std::vector<precise_unit> units(ustrings.size());
+    unit_from_string_batch(ustrings.data(), units.data(), ustrings.size());
+    for (size_t ii = 0; ii < ustrings.size(); ++ii) {
+        EXPECT_EQ(units[ii], unit_from_string(ustrings[ii])) << ustrings[ii];
+    }
+    EXPECT_EQ(units[2].commodity(), getCommodity("zzbatch"));
+}
+
+TEST(stringBatch, buffer)
+{
+    // cells of a delimited buffer referenced in place without null terminators
+    const char* buffer = "m/s,kg,m/s,N*m,kg,bad_unit_string";
+    std::vector<const char*> cells;
+    std::vector<size_t> lengths;
+    const char* start = buffer;
+    for (const char* pos = buffer;; ++pos) {
+        if (*pos == ',' || *pos == '\0') {
+            cells.push_back(start);
+            lengths.push_back(static_cast<size_t>(pos - start));
+            if (*pos == '\0') {
+                break;
+            }
+            start = pos + 1;
+        }
+    }
+    std::vector<precise_unit> units(cells.size());
+    unit_from_string_batch(cells.data(), lengths.data(), units.data(), cells.size());
+    EXPECT_EQ(units[0], precise::m / precise::s);
+    EXPECT_EQ(units[1], precise::kg);
+    EXPECT_EQ(units[2], precise::m / precise::s);
+    EXPECT_EQ(units[3], precise::N * precise::m);
+    EXPECT_EQ(units[4], precise::kg);
+    EXPECT_FALSE(is_valid(units[5]));
+}
+
+TEST(parseInstrumentation, stages)
+{
+    enableParseInstrumentation();
+    EXPECT_EQ(unit_from_string("kg"), precise::kg);
+    auto trace = getLastParseTrace();
+    EXPECT_EQ(trace.unit_string, "kg");
+    EXPECT_EQ(trace.stage, parse_stage::quick_match);
+    EXPECT_EQ(trace.max_depth, 1U);
+    EXPECT_GE(trace.probes, 1U);
+
+    EXPECT_EQ(unit_from_string("lb*ft/s^3"), precise::lb * precise::ft / precise::s.pow(3));
+    EXPECT_EQ(getLastParseTrace().stage, parse_stage::operator_split);
+    EXPECT_EQ(unit_from_string("kilofurlong"), precise_unit(1000.0, precise::us::furlong));
+    EXPECT_EQ(getLastParseTrace().stage, parse_stage::word_prefix);
+    EXPECT_EQ(unit_from_string("squaremeter"), precise::m.pow(2));
+    trace = getLastParseTrace();
+    EXPECT_EQ(trace.stage, parse_stage::word_modifiers);
+    EXPECT_EQ(trace.max_depth, 2U);
+    EXPECT_FALSE(is_valid(unit_from_string("not_a_unit_name")));
+    EXPECT_EQ(getLastParseTrace().stage, parse_stage::unmatched);
+    disableParseInstrumentation();
+
+    auto stats = getParseStatistics();
+    EXPECT_EQ(stats.calls, 5U);
+    ASSERT_EQ(stats.stages.size(), parse_stage_count);
+    EXPECT_EQ(stats.stages[static_cast<size_t>(parse_stage::quick_match)].count, 1U);
+    EXPECT_EQ(stats.stages[static_cast<size_t>(parse_stage::unmatched)].count, 1U);
+    // calls are not recorded while the instrumentation is disabled
+    unit_from_string("m");
+    EXPECT_EQ(getParseStatistics().calls, 5U);
+    clearParseInstrumentation();
+    EXPECT_EQ(getParseStatistics().calls, 0U);
+}
+
+TEST(parseInstrumentation, nestedStages)
+{
+    enableParseInstrumentation();
+    // the case insensitive index resolves the whole string
+    EXPECT_TRUE(is_valid(unit_from_string("ACRE_BR", case_insensitive)));
+    EXPECT_EQ(getLastParseTrace().stage, parse_stage::alternate_spelling);
+    // the index resolves a token of the split,  the stage is still the split
+    EXPECT_TRUE(is_valid(unit_from_string("$/ACRE_BR", case_insensitive)));
+    EXPECT_EQ(getLastParseTrace().stage, parse_stage::operator_split);
+    // a stage that is tried but fails is not recorded
+    EXPECT_FALSE(is_valid(unit_from_string("Q3")));
+    EXPECT_EQ(getLastParseTrace().stage, parse_stage::unmatched);
+    disableParseInstrumentation();
+    clearParseInstrumentation();
+
+    EXPECT_STREQ(parseStageName(parse_stage::partitioning), "partitioning");
+    EXPECT_STREQ(parseStageName(static_cast<parse_stage>(parse_stage_count)), "unknown");
+}
+
+TEST(parseInstrumentation, report)
+{
+    enableParseInstrumentation(2);
+    unit_from_string("m");
+    unit_from_string("N*m/s");
+    unit_from_string("not_a_unit_name");
+    disableParseInstrumentation();
+    auto stats = getParseStatistics();
+    ASSERT_EQ(stats.slowest.size(), 2U);
+    EXPECT_GE(stats.slowest[0].nanoseconds, stats.slowest[1].nanoseconds);
+
+    auto report = parseInstrumentationReport();
+    EXPECT_NE(report.find("unit_from_string calls: 3"), std::string::npos);
+    EXPECT_NE(report.find(parseStageName(parse_stage::unmatched)), std::string::npos);
+    EXPECT_NE(report.find(stats.slowest[0].unit_string), std::string::npos);
+    clearParseInstrumentation();
+}
@@ -0,0 +1,1148 @@
+/*
+Copyright (c) 2019,
+Lawrence Livermore National Security, LLC;
+See the top-level NOTICE for additional details. All rights reserved.
+SPDX-License-Identifier: BSD-3-Clause
+*/
+#include "units.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define UNITS_X86_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#else
+#define UNITS_X86_SIMD 0
+#endif
+
+#if UNITS_X86_SIMD && (defined(__GNUC__) || defined(__clang__))
+#define UNITS_TARGET(isa) __attribute__((target(isa)))
+#else
+#define UNITS_TARGET(isa)
+#endif
+
+namespace units {
+/** the arithmetic forms of the conversions the kernels handle
+@details the kernels use the coefficients of a unit_converter in the same order as unit_converter::convert, a
+multiplication or division by 1.0 is exact so the scale form drops those steps from the linear form*/
+enum class kernel_form : uint8_t {
+    scale,  //!< val*c1/c2
+    linear,  //!< val*c0*c1/c2/c3
+    affine,  //!< ((val-c0)*c1/c2+c3-c4)*c5/c6+c7
+    inverse,  //!< c2/(val*c1)
+};
+
+namespace scalar_kernels {
+    template<typename IN, typename OUT>
+    void convert(kernel_form form, const double* c, const IN* values, OUT* results, size_t size)
+    {
+        switch (form) {
+            case kernel_form::scale:
+                for (size_t ii = 0; ii < size; ++ii) {
+                    results[ii] = static_cast<OUT>(static_cast<double>(values[ii]) * c[1] / c[2]);
+                }
+                break;
+            case kernel_form::linear:
+                for (size_t ii = 0; ii < size; ++ii) {
+                    results[ii] = static_cast<OUT>(
+                        static_cast<double>(values[ii]) * c[0] * c[1] / c[2] / c[3]);
+                }
+                break;
+            case kernel_form::affine:
+                for (size_t ii = 0; ii < size; ++ii) {
+                    double val = (static_cast<double>(values[ii]) - c[0]) * c[1] / c[2] + c[3];
+                    results[ii] = static_cast<OUT>((val - c[4]) * c[5] / c[6] + c[7]);
+                }
+                break;
+            case kernel_form::inverse:
+                for (size_t ii = 0; ii < size; ++ii) {
+                    results[ii] = static_cast<OUT>(c[2] / (static_cast<double>(values[ii]) * c[1]));
+                }
+                break;
+        }
+    }
+}  // namespace scalar_kernels
+
+#if UNITS_X86_SIMD
+/* Each instruction set has its own copy of the kernel since the target attribute has to be on every function
+that uses the intrinsics. Only add, sub, mul and div are used, which round exactly as the scalar operations do,
+and there is no multiply followed directly by an add that a compiler could fuse. */
+namespace sse2_kernels {
+    static inline __m128d load(const double* ptr) { return _mm_loadu_pd(ptr); }
+    static inline __m128d load(const float* ptr)
+    {
+        return _mm_cvtps_pd(
+            _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr))));
+    }
+    static inline void store(double* ptr, __m128d val) { _mm_storeu_pd(ptr, val); }
+    static inline void store(float* ptr, __m128d val)
+    {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(ptr), _mm_castps_si128(_mm_cvtpd_ps(val)));
+    }
+
+    template<typename IN, typename OUT>
+    void convert(kernel_form form, const double* c, const IN* values, OUT* results, size_t size)
+    {
+        constexpr size_t width = 2;
+        const size_t vcount = size - size % width;
+        const __m128d c0 = _mm_set1_pd(c[0]);
+        const __m128d c1 = _mm_set1_pd(c[1]);
+        const __m128d c2 = _mm_set1_pd(c[2]);
+        const __m128d c3 = _mm_set1_pd(c[3]);
+        switch (form) {
+            case kernel_form::scale:
+                for (size_t ii = 0; ii < vcount; ii += width) {
+                    store(results + ii, _mm_div_pd(_mm_mul_pd(load(values + ii), c1), c2));
+                }
+                break;
+            case kernel_form::linear:
+                for (size_t ii = 0; ii < vcount; ii += width) {
+                    __m128d val = _mm_mul_pd(_mm_mul_pd(load(values + ii), c0), c1);
+                    store(results + ii, _mm_div_pd(_mm_div_pd(val, c2), c3));
+                }
+                break;
+            case kernel_form::affine: {
+                const __m128d c4 = _mm_set1_pd(c[4]);
+                const __m128d c5 = _mm_set1_pd(c[5]);
+                const __m128d c6 = _mm_set1_pd(c[6]);
+                const __m128d c7 = _mm_set1_pd(c[7]);
+                for (size_t ii = 0; ii < vcount; ii += width) {
+                    __m128d val = _mm_mul_pd(_mm_sub_pd(load(values + ii), c0), c1);
+                    val = _mm_sub_pd(_mm_add_pd(_mm_div_pd(val, c2), c3), c4);
+                    store(results + ii, _mm_add_pd(_mm_div_pd(_mm_mul_pd(val, c5), c6), c7));
+                }
+            } break;
+            case kernel_form::inverse:
+                for (size_t ii = 0; ii < vcount; ii += width) {
+                    store(results + ii, _mm_div_pd(c2, _mm_mul_pd(load(values + ii), c1)));
+                }
+                break;
+        }
+        scalar_kernels::convert(form, c, values + vcount, results + vcount, size - vcount);
+    }
+}  // namespace sse2_kernels
+
+namespace avx2_kernels {
+    UNITS_TARGET("avx2") static inline __m256d load(const double* ptr)
+    {
+        return _mm256_loadu_pd(ptr);
+    }
+    UNITS_TARGET("avx2") static inline __m256d load(const float* ptr)
+    {
+        return _mm256_cvtps_pd(_mm_loadu_ps(ptr));
+    }
+    UNITS_TARGET("avx2") static inline void store(double* ptr, __m256d val)
+    {
+        _mm256_storeu_pd(ptr, val);
+    }
+    UNITS_TARGET("avx2") static inline void store(float* ptr, __m256d val)
+    {
+        _mm_storeu_ps(ptr, _mm256_cvtpd_ps(val));
+    }
+
+    template<typename IN, typename OUT>
+    UNITS_TARGET("avx2")
+    void convert(kernel_form form, const double* c, const IN* values, OUT* results, size_t size)
+    {
+        constexpr size_t width = 4;
+        const size_t vcount = size - size % width;
+        const __m256d c0 = _mm256_set1_pd(c[0]);
+        const __m256d c1 = _mm256_set1_pd(c[1]);
+        const __m256d c2 = _mm256_set1_pd(c[2]);
+        const __m256d c3 = _mm256_set1_pd(c[3]);
+        switch (form) {
+            case kernel_form::scale:
+                for (size_t ii = 0; ii < vcount; ii += width) {
+                    store(results + ii, _mm256_div_pd(_mm256_mul_pd(load(values + ii), c1), c2));
+                }
+                break;
+            case kernel_form::linear:
+                for (size_t ii = 0; ii < vcount; ii += width) {
+                    __m256d val = _mm256_mul_pd(_mm256_mul_pd(load(values + ii), c0), c1);
+                    store(results + ii, _mm256_div_pd(_mm256_div_pd(val, c2), c3));
+                }
+                break;
+            case kernel_form::affine: {
+                const __m256d c4 = _mm256_set1_pd(c[4]);
+                const __m256d c5 = _mm256_set1_pd(c[5]);
+                const __m256d c6 = _mm256_set1_pd(c[6]);
+                const __m256d c7 = _mm256_set1_pd(c[7]);
+                for (size_t ii = 0; ii < vcount; ii += width) {
+                    __m256d val = _mm256_mul_pd(_mm256_sub_pd(load(values + ii), c0), c1);
+                    val = _mm256_sub_pd(_mm256_add_pd(_mm256_div_pd(val, c2), c3), c4);
+                    store(
+                        results + ii, _mm256_add_pd(_mm256_div_pd(_mm256_mul_pd(val, c5), c6), c7));
+                }
+            } break;
+            case kernel_form::inverse:
+                for (size_t ii = 0; ii < vcount; ii += width) {
+                    store(results + ii, _mm256_div_pd(c2, _mm256_mul_pd(load(values + ii), c1)));
+                }
+                break;
+        }
+        scalar_kernels::convert(form, c, values + vcount, results + vcount, size - vcount);
+    }
+}  // namespace avx2_kernels
+
+namespace avx512_kernels {
+    UNITS_TARGET("avx512f") static inline __m512d load(const double* ptr)
+    {
+        return _mm512_loadu_pd(ptr);
+    }
+    UNITS_TARGET("avx512f") static inline __m512d load(const float* ptr)
+    {
+        return _mm512_cvtps_pd(_mm256_loadu_ps(ptr));
+    }
+    UNITS_TARGET("avx512f") static inline void store(double* ptr, __m512d val)
+    {
+        _mm512_storeu_pd(ptr, val);
+    }
+    UNITS_TARGET("avx512f") static inline void store(float* ptr, __m512d val)
+    {
+        _mm256_storeu_ps(ptr, _mm512_cvtpd_ps(val));
+    }
+
+    template<typename IN, typename OUT>
+    UNITS_TARGET("avx512f")
+    void convert(kernel_form form, const double* c, const IN* values, OUT* results, size_t size)
+    {
+        constexpr size_t width = 8;
+        const size_t vcount = size - size % width;
+        const __m512d c0 = _mm512_set1_pd(c[0]);
+        const __m512d c1 = _mm512_set1_pd(c[1]);
+        const __m512d c2 = _mm512_set1_pd(c[2]);
+        const __m512d c3 = _mm512_set1_pd(c[3]);
+        switch (form) {
+            case kernel_form::scale:
+                for (size_t ii = 0; ii < vcount; ii += width) {
+                    store(results + ii, _mm512_div_pd(_mm512_mul_pd(load(values + ii), c1), c2));
+                }
+                break;
+            case kernel_form::linear:
+                for (size_t ii = 0; ii < vcount; ii += width) {
+                    __m512d val = _mm512_mul_pd(_mm512_mul_pd(load(values + ii), c0), c1);
+                    store(results + ii, _mm512_div_pd(_mm512_div_pd(val, c2), c3));
+                }
+                break;
+            case kernel_form::affine: {
+                const __m512d c4 = _mm512_set1_pd(c[4]);
+                const __m512d c5 = _mm512_set1_pd(c[5]);
+                const __m512d c6 = _mm512_set1_pd(c[6]);
+                const __m512d c7 = _mm512_set1_pd(c[7]);
+                for (size_t ii = 0; ii < vcount; ii += width) {
+                    __m512d val = _mm512_mul_pd(_mm512_sub_pd(load(values + ii), c0), c1);
+                    val = _mm512_sub_pd(_mm512_add_pd(_mm512_div_pd(val, c2), c3), c4);
+                    store(
+                        results + ii, _mm512_add_pd(_mm512_div_pd(_mm512_mul_pd(val, c5), c6), c7));
+                }
+            } break;
+            case kernel_form::inverse:
+                for (size_t ii = 0; ii < vcount; ii += width) {
+                    store(results + ii, _mm512_div_pd(c2, _mm512_mul_pd(load(values + ii), c1)));
+                }
+                break;
+        }
+        scalar_kernels::convert(form, c, values + vcount, results + vcount, size - vcount);
+    }
+}  // namespace avx512_kernels
+
+/// the best instruction set supported by the processor and operating system
+static simd_level detectSimdLevel()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return simd_level::sse2;
+    }
+    __cpuid(info, 1);
+    // osxsave and avx
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) {
+        return simd_level::sse2;
+    }
+    auto xcr0 = _xgetbv(0);
+    if ((xcr0 & 0x6) != 0x6) {
+        return simd_level::sse2;
+    }
+    __cpuidex(info, 7, 0);
+    if ((info[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6) {
+        return simd_level::avx512;
+    }
+    return ((info[1] & (1 << 5)) != 0) ? simd_level::avx2 : simd_level::sse2;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return simd_level::avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return simd_level::avx2;
+    }
+    return simd_level::sse2;
+#endif
+}
+#else
+static simd_level detectSimdLevel()
+{
+    return simd_level::scalar;
+}
+#endif
+
+static simd_level supportedSimdLevel()
+{
+    static const simd_level supported = detectSimdLevel();
+    return supported;
+}
+
+static std::atomic<simd_level>& activeSimdLevel()
+{
+    static std::atomic<simd_level> level{supportedSimdLevel()};
+    return level;
+}
+
+simd_level getSimdLevel()
+{
+    return activeSimdLevel().load(std::memory_order_relaxed);
+}
+
+simd_level setSimdLevel(simd_level level)
+{
+    if (level > supportedSimdLevel()) {
+        level = supportedSimdLevel();
+    }
+    activeSimdLevel().store(level, std::memory_order_relaxed);
+    return level;
+}
+
+template<typename IN, typename OUT>
+static void
+    convertArray(kernel_form form, const double* c, const IN* values, OUT* results, size_t size)
+{
+    switch (getSimdLevel()) {
+#if UNITS_X86_SIMD
+        case simd_level::avx512:
+            avx512_kernels::convert(form, c, values, results, size);
+            break;
+        case simd_level::avx2:
+            avx2_kernels::convert(form, c, values, results, size);
+            break;
+        case simd_level::sse2:
+            sse2_kernels::convert(form, c, values, results, size);
+            break;
+#endif
+        default:
+            scalar_kernels::convert(form, c, values, results, size);
+            break;
+    }
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#define UNITS_ALWAYS_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define UNITS_ALWAYS_INLINE __forceinline
+#else
+#define UNITS_ALWAYS_INLINE inline
+#endif
+
+static UNITS_ALWAYS_INLINE uint64_t toBits(double val)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    return bits;
+}
+
+static UNITS_ALWAYS_INLINE double fromBits(uint64_t bits)
+{
+    double val;
+    std::memcpy(&val, &bits, sizeof(val));
+    return val;
+}
+
+/// adding and subtracting 1.5*2^52 rounds a double to an integer and leaves the integer in the low bits
+static constexpr double roundingShift{6755399441055744.0};
+
+/** the values needed to compute base^y as exp(r)*2^n
+@details n=round(y*log2(base)) and r=(y-n*log_base(2))*ln(base), log_base(2) is split into a 32 bit high part
+and a low part so n*stepHi is exact and the reduction keeps its accuracy for large y*/
+struct powerBase {
+    double log2Base;
+    double stepHi;
+    double stepLo;
+    double lnBase;
+};
+
+static constexpr powerBase baseE{
+    1.4426950408889634,
+    0.6931471803691238,
+    1.9082149292705877e-10,
+    1.0};
+static constexpr powerBase base2{1.0, 1.0, 0.0, 0.6931471805599453};
+static constexpr powerBase base3{
+    1.584962500721156,
+    0.6309297534171492,
+    1.5430825096518874e-10,
+    1.0986122886681098};
+static constexpr powerBase base10{
+    3.321928094887362,
+    0.3010299955494702,
+    1.1451100898021838e-10,
+    2.302585092994046};
+static constexpr powerBase base100{
+    6.643856189774724,
+    0.1505149977747351,
+    5.725550449010919e-11,
+    4.605170185988092};
+static constexpr powerBase base1000{
+    9.965784284662087,
+    0.10034333186922595,
+    1.8767782688916994e-11,
+    6.907755278982137};
+static constexpr powerBase base50000{
+    15.609640474436812,
+    0.064062974503031,
+    1.8237050375548163e-11,
+    10.819778284410283};
+
+/// exp(r) for |r|<=ln(2)/2 from its Taylor series, the truncation error is below 2^-60
+static UNITS_ALWAYS_INLINE double expReduced(double r)
+{
+    double poly = 1.0 / 6227020800.0;
+    poly = poly * r + 1.0 / 479001600.0;
+    poly = poly * r + 1.0 / 39916800.0;
+    poly = poly * r + 1.0 / 3628800.0;
+    poly = poly * r + 1.0 / 362880.0;
+    poly = poly * r + 1.0 / 40320.0;
+    poly = poly * r + 1.0 / 5040.0;
+    poly = poly * r + 1.0 / 720.0;
+    poly = poly * r + 1.0 / 120.0;
+    poly = poly * r + 1.0 / 24.0;
+    poly = poly * r + 1.0 / 6.0;
+    poly = poly * r + 0.5;
+    poly = poly * r + 1.0;
+    return poly * r + 1.0;
+}
+
+/** branch free base^y, within 1 ulp of pow
+@details y is limited so that 2^n stays within 2^+-1080, the scale is applied as two factors so results in the
+subnormal range and overflow to infinity come out right, NaN propagates through the arithmetic*/
+static UNITS_ALWAYS_INLINE double powApprox(double y, double limit, const powerBase& base)
+{
+    y = (y < -limit) ? -limit : y;
+    y = (y > limit) ? limit : y;
+    double n = (y * base.log2Base + roundingShift) - roundingShift;
+    double half = (n * 0.5 + roundingShift) - roundingShift;
+    double rest = n - half;
+    double r = ((y - n * base.stepHi) - n * base.stepLo) * base.lnBase;
+    double scale1 = fromBits((toBits(half + roundingShift) - toBits(roundingShift) + 1023U) << 52U);
+    double scale2 = fromBits((toBits(rest + roundingShift) - toBits(roundingShift) + 1023U) << 52U);
+    return expReduced(r) * scale1 * scale2;
+}
+
+/** branch free natural log, within 1 ulp of log
+@details the value is split into m*2^e with m in [sqrt(1/2),sqrt(2)) and log(m) comes from the series for
+2*atanh(f/(2+f)) with f=m-1, subnormal values are scaled first*/
+static UNITS_ALWAYS_INLINE double logApprox(double val)
+{
+    constexpr double ln2Hi{6.93147180369123816490e-01};
+    constexpr double ln2Lo{1.90821492927058770002e-10};
+    bool subnormal = val < 2.2250738585072014e-308;
+    double scaled = subnormal ? val * 18014398509481984.0 : val;
+    // bias the bits so the exponent field rounds at sqrt(1/2)
+    uint64_t biasedExp = (toBits(scaled) + (0x3ff0000000000000ULL - 0x3fe6a09e667f3bcdULL)) >> 52U;
+    double exponent = fromBits(biasedExp | 0x4330000000000000ULL) - 4503599627371519.0;
+    exponent = subnormal ? exponent - 54.0 : exponent;
+    double f = fromBits(toBits(scaled) - ((biasedExp - 1023U) << 52U)) - 1.0;
+    double q = f / (2.0 + f);
+    double z = q * q;
+    double poly = 2.0 / 23.0;
+    poly = poly * z + 2.0 / 21.0;
+    poly = poly * z + 2.0 / 19.0;
+    poly = poly * z + 2.0 / 17.0;
+    poly = poly * z + 2.0 / 15.0;
+    poly = poly * z + 2.0 / 13.0;
+    poly = poly * z + 2.0 / 11.0;
+    poly = poly * z + 2.0 / 9.0;
+    poly = poly * z + 2.0 / 7.0;
+    poly = poly * z + 2.0 / 5.0;
+    poly = poly * z + 2.0 / 3.0;
+    double hfsq = 0.5 * f * f;
+    double result = exponent * ln2Hi + ((f - (hfsq - q * (hfsq + z * poly))) + exponent * ln2Lo);
+    result = (val == constants::infinity) ? val : result;
+    return (val > 0.0) ? result :
+                         ((val == 0.0) ? -constants::infinity : constants::invalid_conversion);
+}
+
+/// base^(((val+offset)*scale)/divisor) mirroring the exponent computed by convert_equnit_to_value
+struct powerKernel {
+    double offset;
+    double scale;
+    double divisor;
+    double limit;
+    powerBase base;
+    UNITS_ALWAYS_INLINE double operator()(double val) const
+    {
+        return powApprox(((val + offset) * scale) / divisor, limit, base);
+    }
+};
+
+/** log(val)*scale+offset, values at or below the limit are invalid
+@details the limit is 0 for the logarithmic units, otherwise -infinity which gives the same NaN as the log*/
+struct logKernel {
+    double scale;
+    double offset;
+    double limit;
+    UNITS_ALWAYS_INLINE double operator()(double val) const
+    {
+        double result = logApprox(val) * scale + offset;
+        return (val <= limit) ? constants::invalid_conversion : result;
+    }
+};
+
+/// the fma polynomials of the wind scales, these match the scalar functions exactly
+template<int TERMS>
+struct polynomialKernel {
+    double coeff[TERMS];
+    UNITS_ALWAYS_INLINE double operator()(double val) const
+    {
+        double out = coeff[0];
+        for (int ii = 1; ii < TERMS; ++ii) {
+            out = std::fma(out, val, coeff[ii]);
+        }
+        return out;
+    }
+};
+
+template<typename KERNEL>
+static void applyKernel(const KERNEL& kernel, const double* values, double* results, size_t size)
+{
+    for (size_t ii = 0; ii < size; ++ii) {
+        results[ii] = kernel(values[ii]);
+    }
+}
+
+#if UNITS_X86_SIMD
+// the same loop compiled for the wider instruction sets, the compiler vectorizes the inlined kernels
+template<typename KERNEL>
+UNITS_TARGET("avx2,fma")
+static void
+    applyKernelAvx2(const KERNEL& kernel, const double* values, double* results, size_t size)
+{
+    for (size_t ii = 0; ii < size; ++ii) {
+        results[ii] = kernel(values[ii]);
+    }
+}
+
+template<typename KERNEL>
+UNITS_TARGET("avx512f")
+static void
+    applyKernelAvx512(const KERNEL& kernel, const double* values, double* results, size_t size)
+{
+    for (size_t ii = 0; ii < size; ++ii) {
+        results[ii] = kernel(values[ii]);
+    }
+}
+#endif
+
+template<typename KERNEL>
+static void dispatchKernel(const KERNEL& kernel, const double* values, double* results, size_t size)
+{
+    switch (getSimdLevel()) {
+#if UNITS_X86_SIMD
+        case simd_level::avx512:
+            applyKernelAvx512(kernel, values, results, size);
+            break;
+        case simd_level::avx2:
+            applyKernelAvx2(kernel, values, results, size);
+            break;
+#endif
+        default:
+            applyKernel(kernel, values, results, size);
+            break;
+    }
+}
+
+static powerKernel
+    makePowerKernel(double offset, double scale, double divisor, const powerBase& base)
+{
+    return powerKernel{offset, scale, divisor, 1080.0 / base.log2Base, base};
+}
+
+// the coefficients are those of convert_equnit_to_value and convert_value_to_equnit
+static constexpr polynomialKernel<5> saffirSimpsonToValue{
+    {-0.17613636364, 2.88510101010, -14.95265151515, 47.85191197691, 38.90151515152}};
+static constexpr polynomialKernel<6> saffirSimpsonFromValue{
+    {1.75748569529e-10,
+     -9.09204303833e-08,
+     1.52274455780e-05,
+     -7.73787973277e-04,
+     2.81978682167e-02,
+     -6.67563481438e-01}};
+static constexpr polynomialKernel<5> beaufortToValue{
+    {0.00177396133, -0.05860071301, 0.93621452077, 0.24246097040, -0.12475759535}};
+static constexpr polynomialKernel<6> beaufortFromValue{
+    {2.18882896425e-08,
+     -4.78236313769e-06,
+     3.91121840061e-04,
+     -1.52427367162e-02,
+     4.24089585061e-01,
+     4.99241689370e-01}};
+
+namespace precise {
+    namespace equations {
+        void convert_equnit_to_value(
+            const double* values,
+            double* results,
+            size_t size,
+            detail::unit_data UT,
+            equation_accuracy accuracy)
+        {
+            if (!UT.is_equation()) {
+                if (results != values) {
+                    std::copy(values, values + size, results);
+                }
+                return;
+            }
+            int logtype = custom::eq_type(UT);
+            if (logtype == 22 || logtype == 23) {
+                dispatchKernel(
+                    (logtype == 22) ? saffirSimpsonToValue : beaufortToValue,
+                    values,
+                    results,
+                    size);
+                return;
+            }
+            if (accuracy == equation_accuracy::fast) {
+                bool power = is_power_unit(UT);
+                bool vectorized{true};
+                powerKernel kernel = makePowerKernel(-0.0, 1.0, 1.0, base10);
+                switch (logtype) {
+                    case 0:
+                    case 10:
+                        break;
+                    case 1:
+                        kernel = makePowerKernel(-0.0, 1.0, power ? 0.5 : 1.0, baseE);
+                        break;
+                    case 2:
+                        kernel.divisor = power ? 1.0 : 2.0;
+                        break;
+                    case 3:
+                        kernel.divisor = power ? 10.0 : 20.0;
+                        break;
+                    case 4:
+                        kernel.scale = -1.0;
+                        break;
+                    case 5:
+                        kernel = makePowerKernel(-0.0, -1.0, 1.0, base100);
+                        break;
+                    case 6:
+                        kernel = makePowerKernel(-0.0, -1.0, 1.0, base1000);
+                        break;
+                    case 7:
+                        kernel = makePowerKernel(-0.0, -1.0, 1.0, base50000);
+                        break;
+                    case 8:
+                        kernel = makePowerKernel(-0.0, 1.0, 1.0, base2);
+                        break;
+                    case 9:
+                        kernel = makePowerKernel(-0.0, 1.0, 1.0, baseE);
+                        break;
+                    case 11:
+                        kernel.divisor = 10.0;
+                        break;
+                    case 12:
+                        kernel.divisor = 2.0;
+                        break;
+                    case 13:
+                        kernel.divisor = 20.0;
+                        break;
+                    case 14:
+                        kernel = makePowerKernel(-0.0, 1.0, 1.0, base3);
+                        break;
+                    case 15:
+                        kernel = makePowerKernel(-0.0, 1.0, 0.5, baseE);
+                        break;
+                    case 29:
+                        kernel = makePowerKernel(10.7, 1.5, 1.0, base10);
+                        break;
+                    case 30:
+                        kernel = makePowerKernel(3.2, 1.5, 1.0, base10);
+                        break;
+                    default:
+                        vectorized = false;
+                        break;
+                }
+                if (vectorized) {
+                    dispatchKernel(kernel, values, results, size);
+                    return;
+                }
+            }
+            for (size_t ii = 0; ii < size; ++ii) {
+                results[ii] = convert_equnit_to_value(values[ii], UT);
+            }
+        }
+
+        void convert_value_to_equnit(
+            const double* values,
+            double* results,
+            size_t size,
+            detail::unit_data UT,
+            equation_accuracy accuracy)
+        {
+            if (!UT.is_equation()) {
+                if (results != values) {
+                    std::copy(values, values + size, results);
+                }
+                return;
+            }
+            int logtype = custom::eq_type(UT);
+            if (logtype == 22 || logtype == 23) {
+                dispatchKernel(
+                    (logtype == 22) ? saffirSimpsonFromValue : beaufortFromValue,
+                    values,
+                    results,
+                    size);
+                return;
+            }
+            if (accuracy == equation_accuracy::fast) {
+                constexpr double ln10{2.302585092994046};
+                bool power = is_power_unit(UT);
+                bool vectorized{true};
+                // log(val)*scale+offset, -0.0 leaves the sign of zero alone as in the scalar functions
+                logKernel kernel{1.0 / ln10, -0.0, (logtype < 16) ? 0.0 : -constants::infinity};
+                switch (logtype) {
+                    case 0:
+                    case 10:
+                        break;
+                    case 1:
+                        kernel.scale = power ? 0.5 : 1.0;
+                        break;
+                    case 2:
+                        kernel.scale = (power ? 1.0 : 2.0) / ln10;
+                        break;
+                    case 3:
+                        kernel.scale = (power ? 10.0 : 20.0) / ln10;
+                        break;
+                    case 4:
+                        kernel.scale = -1.0 / ln10;
+                        break;
+                    case 5:
+                        kernel.scale = -1.0 / (2.0 * ln10);
+                        break;
+                    case 6:
+                        kernel.scale = -1.0 / (3.0 * ln10);
+                        break;
+                    case 7:
+                        kernel.scale = -1.0 / base50000.lnBase;
+                        break;
+                    case 8:
+                        kernel.scale = 1.0 / base2.lnBase;
+                        break;
+                    case 9:
+                        kernel.scale = 1.0;
+                        break;
+                    case 11:
+                        kernel.scale = 10.0 / ln10;
+                        break;
+                    case 12:
+                        kernel.scale = 2.0 / ln10;
+                        break;
+                    case 13:
+                        kernel.scale = 20.0 / ln10;
+                        break;
+                    case 14:
+                        kernel.scale = 1.0 / base3.lnBase;
+                        break;
+                    case 15:
+                        kernel.scale = 0.5;
+                        break;
+                    case 29:
+                        kernel.scale = 2.0 / 3.0 / ln10;
+                        kernel.offset = -10.7;
+                        break;
+                    case 30:
+                        kernel.scale = 2.0 / 3.0 / ln10;
+                        kernel.offset = -3.2;
+                        break;
+                    default:
+                        vectorized = false;
+                        break;
+                }
+                if (vectorized) {
+                    dispatchKernel(kernel, values, results, size);
+                    return;
+                }
+            }
+            for (size_t ii = 0; ii < size; ++ii) {
+                results[ii] = convert_value_to_equnit(values[ii], UT);
+            }
+        }
+    }  // namespace equations
+}  // namespace precise
+
+/// convert values of an equation unit conversion through the linear value in the same steps as convert
+static void convertEquationArray(
+    const double* c,
+    detail::unit_data start,
+    detail::unit_data result,
+    const double* values,
+    double* results,
+    size_t size,
+    equation_accuracy accuracy)
+{
+    precise::equations::convert_equnit_to_value(values, results, size, start, accuracy);
+    convertArray(kernel_form::scale, c, results, results, size);
+    precise::equations::convert_value_to_equnit(results, results, size, result, accuracy);
+}
+
+static void convertEquationArray(
+    const double* c,
+    detail::unit_data start,
+    detail::unit_data result,
+    const float* values,
+    float* results,
+    size_t size,
+    equation_accuracy accuracy)
+{
+    constexpr size_t blockSize{512};
+    double block[blockSize];
+    for (size_t offset = 0; offset < size; offset += blockSize) {
+        size_t len = std::min(blockSize, size - offset);
+        std::copy(values + offset, values + offset + len, block);
+        convertEquationArray(c, start, result, block, block, len, accuracy);
+        for (size_t ii = 0; ii < len; ++ii) {
+            results[offset + ii] = static_cast<float>(block[ii]);
+        }
+    }
+}
+
+template<typename IN, typename OUT>
+static void convertArray(
+    const unit_converter& conv,
+    unit_converter::kind type,
+    const double* c,
+    detail::unit_data start,
+    detail::unit_data result,
+    const IN* values,
+    OUT* results,
+    size_t size,
+    equation_accuracy accuracy)
+{
+    switch (type) {
+        case unit_converter::kind::linear:
+        case unit_converter::kind::counting:
+            convertArray(
+                (c[0] == 1.0 && c[3] == 1.0) ? kernel_form::scale : kernel_form::linear,
+                c,
+                values,
+                results,
+                size);
+            break;
+        case unit_converter::kind::temperature:
+            convertArray(kernel_form::affine, c, values, results, size);
+            break;
+        case unit_converter::kind::inverse:
+            convertArray(kernel_form::inverse, c, values, results, size);
+            break;
+        case unit_converter::kind::equation:
+            convertEquationArray(c, start, result, values, results, size, accuracy);
+            break;
+        default:
+            for (size_t ii = 0; ii < size; ++ii) {
+                results[ii] = static_cast<OUT>(conv.convert(static_cast<double>(values[ii])));
+            }
+            break;
+    }
+}
+
+void unit_converter::convert(
+    const double* values,
+    double* results,
+    size_t size,
+    equation_accuracy accuracy) const
+{
+    convertArray(
+        *this,
+        kind_,
+        c_,
+        start_.base_units(),
+        result_.base_units(),
+        values,
+        results,
+        size,
+        accuracy);
+}
+
+void unit_converter::convert(
+    const float* values,
+    float* results,
+    size_t size,
+    equation_accuracy accuracy) const
+{
+    convertArray(
+        *this,
+        kind_,
+        c_,
+        start_.base_units(),
+        result_.base_units(),
+        values,
+        results,
+        size,
+        accuracy);
+}
+
+
+/* The kernels of the per unit conversions, each follows one form of per_unit_converter with the base values of
+the buses in arrays indexed alongside the values*/
+struct ratioKernel {
+    const double* power;
+    const double* voltage;
+    double c1;
+    double c2;
+    UNITS_ALWAYS_INLINE double operator()(double val, size_t ii) const
+    {
+        return val * power[ii] * c1 / voltage[ii] / c2;
+    }
+};
+
+struct scaleFirstKernel {
+    const double* base;
+    double c1;
+    double c2;
+    UNITS_ALWAYS_INLINE double operator()(double val, size_t ii) const
+    {
+        return val * base[ii] * c1 / c2;
+    }
+};
+
+struct scaleLastKernel {
+    const double* base;
+    double c1;
+    double c2;
+    UNITS_ALWAYS_INLINE double operator()(double val, size_t ii) const
+    {
+        return val * c1 / c2 / base[ii];
+    }
+};
+
+struct divideFirstKernel {
+    const double* base;
+    double c1;
+    UNITS_ALWAYS_INLINE double operator()(double val, size_t ii) const
+    {
+        return val / base[ii] * c1;
+    }
+};
+
+struct divideKernel {
+    const double* base;
+    UNITS_ALWAYS_INLINE double operator()(double val, size_t ii) const { return val / base[ii]; }
+};
+
+struct multiplyKernel {
+    const double* base;
+    UNITS_ALWAYS_INLINE double operator()(double val, size_t ii) const { return val * base[ii]; }
+};
+
+template<typename KERNEL>
+static void applyBusKernel(const KERNEL& kernel, const double* values, double* results, size_t size)
+{
+    for (size_t ii = 0; ii < size; ++ii) {
+        results[ii] = kernel(values[ii], ii);
+    }
+}
+
+#if UNITS_X86_SIMD
+// only mul and div are used so the vectorized loops round exactly as the scalar loop
+template<typename KERNEL>
+UNITS_TARGET("avx2")
+static void
+    applyBusKernelAvx2(const KERNEL& kernel, const double* values, double* results, size_t size)
+{
+    for (size_t ii = 0; ii < size; ++ii) {
+        results[ii] = kernel(values[ii], ii);
+    }
+}
+
+template<typename KERNEL>
+UNITS_TARGET("avx512f")
+static void
+    applyBusKernelAvx512(const KERNEL& kernel, const double* values, double* results, size_t size)
+{
+    for (size_t ii = 0; ii < size; ++ii) {
+        results[ii] = kernel(values[ii], ii);
+    }
+}
+#endif
+
+template<typename KERNEL>
+static void
+    dispatchBusKernel(const KERNEL& kernel, const double* values, double* results, size_t size)
+{
+    switch (getSimdLevel()) {
+#if UNITS_X86_SIMD
+        case simd_level::avx512:
+            applyBusKernelAvx512(kernel, values, results, size);
+            break;
+        case simd_level::avx2:
+            applyBusKernelAvx2(kernel, values, results, size);
+            break;
+#endif
+        default:
+            applyBusKernel(kernel, values, results, size);
+            break;
+    }
+}
+
+void per_unit_converter::set_bases(
+    double startMultiplier,
+    double resultMultiplier,
+    const double* powers,
+    double basePower,
+    const double* baseVoltage,
+    size_t buses)
+{
+    c1_ = startMultiplier;
+    c2_ = resultMultiplier;
+    count_ = buses;
+    bases_.clear();
+    voltages_.clear();
+    ratioBuses_.clear();
+    switch (form_) {
+        case form::shared:
+            break;
+        case form::shared_unless_missing:
+            // only the buses with a missing base are stored, their power and voltage are in bases_ and voltages_
+            for (size_t ii = 0; ii < buses; ++ii) {
+                double power = (powers != nullptr) ? powers[ii] : basePower;
+                if (std::isnan(puconversion::generate_base(base_, power, baseVoltage[ii]))) {
+                    ratioBuses_.push_back(ii);
+                    bases_.push_back(power);
+                    voltages_.push_back(baseVoltage[ii]);
+                }
+            }
+            break;
+        case form::base_ratio:
+        case form::same_base_ratio:
+            if (powers != nullptr) {
+                bases_.assign(powers, powers + buses);
+            } else {
+                bases_.assign(buses, basePower);
+            }
+            voltages_.assign(baseVoltage, baseVoltage + buses);
+            break;
+        default:
+            bases_.resize(buses);
+            for (size_t ii = 0; ii < buses; ++ii) {
+                double power = (powers != nullptr) ? powers[ii] : basePower;
+                double base = puconversion::generate_base(base_, power, baseVoltage[ii]);
+                if (form_ == form::multiply || form_ == form::nested_multiply) {
+                    base *= c1_;
+                }
+                bases_[ii] = base;
+            }
+            break;
+    }
+}
+
+void per_unit_converter::convert_range(
+    const double* values,
+    double* results,
+    size_t first,
+    size_t length) const
+{
+    const double* input = values + first;
+    double* output = results + first;
+    const double* base = bases_.data() + first;
+    switch (form_) {
+        case form::shared:
+            inner_.convert(input, output, length);
+            break;
+        case form::shared_unless_missing: {
+            auto begin = std::lower_bound(ratioBuses_.begin(), ratioBuses_.end(), first);
+            auto end = std::lower_bound(begin, ratioBuses_.end(), first + length);
+            // the values may be the same array as the results so keep the ones the ratio needs
+            std::vector<double> kept;
+            kept.reserve(end - begin);
+            for (auto bus = begin; bus != end; ++bus) {
+                kept.push_back(values[*bus]);
+            }
+            inner_.convert(input, output, length);
+            double c1 = sameUnits_ ? 1.0 : c1_;
+            double c2 = sameUnits_ ? 1.0 : c2_;
+            for (auto bus = begin; bus != end; ++bus) {
+                auto index = static_cast<size_t>(bus - ratioBuses_.begin());
+                results[*bus] = kept[bus - begin] * bases_[index] * c1 / voltages_[index] / c2;
+            }
+        } break;
+        case form::base_ratio:
+            dispatchBusKernel(
+                ratioKernel{base, voltages_.data() + first, c1_, c2_}, input, output, length);
+            break;
+        case form::same_base_ratio:
+            // multiplying and dividing by 1.0 is exact
+            dispatchBusKernel(
+                ratioKernel{base, voltages_.data() + first, 1.0, 1.0}, input, output, length);
+            break;
+        case form::scale_first:
+            dispatchBusKernel(scaleFirstKernel{base, c1_, c2_}, input, output, length);
+            break;
+        case form::scale_last:
+            dispatchBusKernel(scaleLastKernel{base, c1_, c2_}, input, output, length);
+            break;
+        case form::divide_first:
+            dispatchBusKernel(divideFirstKernel{base, c1_}, input, output, length);
+            break;
+        case form::multiply:
+            dispatchBusKernel(multiplyKernel{base}, input, output, length);
+            break;
+        case form::nested_divide: {
+            dispatchBusKernel(divideKernel{base}, input, output, length);
+            inner_.convert(output, output, length);
+            // multiplying by 1.0 is exact so the scale form is a division by c2
+            const double c[4]{0.0, 1.0, c2_, 1.0};
+            convertArray(kernel_form::scale, c, output, output, length);
+        } break;
+        case form::nested_multiply:
+            inner_.convert(input, output, length);
+            dispatchBusKernel(multiplyKernel{base}, output, output, length);
+            break;
+    }
+}
+
+void per_unit_converter::convert(const double* values, double* results, size_t threads) const
+{
+    // smaller chunks are not worth starting a thread for
+    constexpr size_t minimumChunk{16384};
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    size_t chunks = std::min(threads, count_ / minimumChunk);
+    if (chunks <= 1) {
+        convert_range(values, results, 0, count_);
+        return;
+    }
+    size_t chunkSize = (count_ + chunks - 1) / chunks;
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    for (size_t first = chunkSize; first < count_; first += chunkSize) {
+        size_t length = std::min(chunkSize, count_ - first);
+        workers.emplace_back(
+            [this, values, results, first, length]() {
+                convert_range(values, results, first, length);
+            });
+    }
+    convert_range(values, results, 0, chunkSize);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+}  // namespace units
@@ -0,0 +1,304 @@
+/*
+Copyright (c) 2019,
+Lawrence Livermore National Security, LLC;
+See the top-level NOTICE for additional details. All rights reserved.
+SPDX-License-Identifier: BSD-3-Clause
+*/
+// generated by scripts/generate_base_unit_index.py from the base_unit_vals table in units.cpp,
+// rerun the script after changing the table
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace units {
+namespace base_unit_index {
+    /// the number of entries in the table
+    constexpr size_t count{1907};
+    constexpr size_t bucketCount{512};
+    constexpr size_t slotCount{4096};
+    /// length of the longest string in the table
+    constexpr size_t maxLength{32};
+    /// FNV-1a hash of all the strings in the table with their null terminators
+    constexpr uint64_t tableHash{8529151060144377997ULL};
+
+    /// displacement for each bucket
+    constexpr std::array<uint16_t, 512> displacement{{
+        1, 0, 0, 0, 3, 1, 0, 6, 2, 0, 0, 1, 1, 2, 2, 7, 2, 1, 2, 1, 7, 4, 3, 0, 0, 0, 4, 3, 0, 1, 1,
+        8, 0, 3, 2, 0, 0, 3, 0, 1, 6, 5, 0, 0, 0, 6, 1, 4, 0, 0, 4, 6, 2, 1, 5, 1, 2, 3, 1, 3, 1, 1,
+        3, 0, 1, 2, 1, 0, 5, 4, 0, 1, 1, 2, 0, 2, 1, 1, 1, 1, 2, 1, 1, 2, 0, 4, 0, 0, 0, 8, 0, 1, 5,
+        2, 1, 2, 0, 3, 3, 3, 1, 3, 2, 2, 3, 1, 1, 3, 0, 2, 0, 3, 0, 2, 1, 2, 0, 3, 0, 4, 2, 0, 0, 3,
+        1, 2, 0, 10, 1, 0, 1, 0, 0, 3, 2, 2, 1, 5, 2, 4, 1, 1, 9, 0, 0, 4, 5, 0, 0, 1, 0, 1, 2, 0,
+        0, 5, 4, 2, 0, 3, 0, 0, 3, 1, 1, 0, 0, 0, 0, 1, 5, 8, 2, 3, 10, 5, 2, 0, 0, 1, 1, 4, 1, 2,
+        0, 3, 0, 1, 1, 0, 3, 3, 0, 0, 0, 10, 1, 1, 1, 0, 1, 1, 5, 1, 0, 4, 0, 0, 4, 5, 0, 1, 2, 2,
+        0, 1, 2, 2, 0, 5, 3, 2, 2, 0, 0, 0, 2, 2, 1, 1, 1, 8, 4, 0, 11, 0, 4, 0, 1, 8, 1, 2, 1, 3,
+        0, 1, 0, 0, 0, 8, 0, 5, 1, 0, 9, 4, 4, 0, 4, 3, 0, 0, 0, 4, 1, 2, 0, 2, 1, 0, 0, 1, 0, 1, 0,
+        1, 4, 2, 0, 0, 4, 0, 2, 1, 1, 1, 1, 2, 2, 3, 2, 1, 1, 3, 5, 6, 1, 3, 10, 1, 2, 1, 5, 1, 0,
+        1, 7, 3, 3, 1, 0, 1, 1, 4, 3, 3, 4, 4, 0, 0, 1, 2, 2, 0, 1, 2, 3, 2, 5, 2, 0, 0, 6, 16, 0,
+        5, 1, 0, 0, 1, 5, 2, 5, 3, 1, 0, 1, 1, 5, 16, 4, 5, 13, 2, 2, 1, 5, 2, 1, 7, 0, 2, 1, 1, 2,
+        1, 0, 9, 0, 1, 1, 1, 1, 0, 1, 1, 0, 3, 2, 1, 0, 4, 0, 2, 3, 2, 4, 0, 4, 2, 3, 1, 0, 6, 0, 0,
+        1, 8, 2, 7, 2, 1, 0, 16, 3, 1, 4, 9, 10, 1, 2, 0, 1, 5, 3, 0, 7, 14, 0, 1, 0, 1, 0, 5, 0, 1,
+        0, 2, 3, 8, 0, 7, 6, 9, 1, 2, 1, 2, 1, 1, 4, 1, 0, 1, 0, 2, 4, 0, 5, 1, 4, 1, 4, 6, 2, 3, 4,
+        7, 0, 1, 15, 0, 7, 1, 2, 1, 1, 2, 1, 4, 1, 0, 13, 1, 0, 1, 0, 6, 2, 2, 0, 1, 8, 0, 1, 0, 2,
+        7, 2, 5, 3, 1, 2, 8, 0, 1, 8, 5, 0, 4, 0, 0, 1, 9, 1, 0, 0, 0, 1, 3, 6, 3,
+    }};
+    /// entry index+1 for each slot (0 is an empty slot)
+    constexpr std::array<uint16_t, 4096> slots{{
+        1104, 0, 0, 0, 1351, 0, 0, 1035, 0, 0, 0, 541, 767, 63, 0, 0, 1116, 184, 1476, 0, 0, 0,
+        1818, 1700, 1465, 1047, 0, 0, 1393, 0, 0, 0, 0, 178, 0, 0, 604, 0, 0, 0, 0, 1906, 952, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 1883, 0, 1538, 418, 0, 0, 0, 0, 1532, 1603, 1005, 0, 0, 666,
+        1400, 1421, 1240, 291, 927, 0, 0, 0, 0, 1707, 37, 1229, 0, 445, 0, 0, 79, 208, 0, 0, 0, 172,
+        0, 0, 0, 974, 0, 0, 0, 410, 0, 243, 0, 0, 0, 749, 0, 793, 0, 1826, 0, 344, 0, 0, 1349, 1444,
+        0, 0, 0, 555, 918, 0, 1475, 0, 120, 0, 1381, 0, 0, 450, 30, 92, 0, 0, 0, 879, 0, 551, 0,
+        1823, 0, 0, 1340, 0, 0, 422, 0, 1390, 878, 0, 123, 0, 0, 0, 225, 0, 403, 357, 1837, 1887, 0,
+        0, 0, 0, 0, 1765, 0, 1776, 297, 0, 0, 750, 0, 1139, 1160, 0, 958, 1738, 1372, 233, 78, 48,
+        781, 389, 801, 0, 113, 507, 416, 0, 0, 0, 520, 1094, 1343, 1001, 0, 0, 206, 0, 252, 0, 0,
+        1398, 0, 1135, 0, 0, 0, 0, 0, 0, 0, 0, 913, 0, 0, 1093, 390, 0, 578, 0, 0, 0, 0, 1857, 0,
+        492, 1642, 1769, 0, 322, 894, 1347, 0, 0, 959, 0, 1872, 0, 0, 1885, 0, 1025, 1449, 0, 766,
+        0, 0, 0, 1138, 0, 0, 0, 0, 915, 1215, 624, 0, 0, 1900, 0, 0, 0, 0, 1084, 0, 0, 1032, 1817,
+        1697, 1083, 1196, 811, 1480, 0, 1716, 0, 77, 1236, 0, 0, 1115, 0, 0, 0, 294, 0, 0, 0, 1345,
+        0, 0, 963, 1109, 0, 0, 1534, 0, 1439, 0, 0, 0, 1431, 1401, 0, 0, 0, 1121, 751, 0, 0, 895,
+        1487, 0, 0, 0, 0, 1702, 1015, 0, 739, 0, 1357, 51, 0, 289, 0, 487, 0, 0, 0, 24, 1665, 478,
+        0, 0, 0, 0, 600, 1879, 591, 0, 1075, 0, 743, 0, 0, 0, 654, 0, 1004, 0, 0, 0, 0, 0, 1727, 0,
+        817, 877, 1558, 0, 1369, 0, 0, 738, 1825, 0, 1417, 0, 0, 0, 550, 133, 1114, 0, 764, 755, 0,
+        0, 1550, 0, 1805, 0, 728, 0, 923, 1166, 561, 0, 0, 0, 452, 713, 0, 0, 0, 0, 0, 0, 0, 1202,
+        467, 0, 1640, 0, 0, 0, 527, 805, 0, 215, 977, 1619, 519, 404, 703, 1140, 1175, 0, 0, 0, 539,
+        0, 1597, 1326, 0, 0, 1782, 0, 1617, 0, 0, 128, 0, 744, 0, 0, 742, 0, 0, 145, 0, 0, 0, 0,
+        1151, 496, 0, 745, 851, 0, 1331, 0, 0, 0, 0, 0, 213, 1896, 0, 0, 0, 0, 0, 0, 338, 0, 220, 0,
+        0, 1474, 1813, 1187, 0, 0, 0, 216, 1522, 1424, 1178, 0, 0, 1717, 0, 0, 111, 1858, 0, 0, 0,
+        1876, 0, 1367, 0, 896, 0, 0, 433, 840, 794, 759, 1789, 0, 1446, 0, 732, 1795, 787, 0, 0, 0,
+        0, 160, 1718, 593, 0, 0, 0, 230, 886, 0, 0, 0, 0, 846, 1204, 0, 0, 0, 399, 0, 0, 643, 0, 0,
+        1172, 425, 0, 0, 0, 0, 0, 0, 0, 320, 1383, 1310, 497, 602, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        312, 0, 856, 0, 0, 1808, 13, 726, 1332, 0, 929, 0, 1030, 0, 0, 1447, 1205, 1244, 1582, 634,
+        907, 0, 0, 0, 1592, 0, 0, 0, 0, 615, 100, 237, 32, 0, 0, 353, 567, 556, 0, 1117, 833, 1508,
+        0, 658, 0, 382, 1218, 336, 0, 722, 0, 0, 0, 0, 0, 101, 0, 0, 0, 0, 0, 0, 0, 0, 1220, 173, 0,
+        0, 1482, 1348, 0, 0, 741, 870, 476, 0, 34, 0, 187, 695, 995, 558, 0, 0, 0, 1647, 0, 0, 0, 0,
+        0, 1246, 596, 0, 0, 0, 0, 154, 0, 0, 0, 1500, 0, 711, 1147, 1729, 1052, 1710, 83, 0, 0, 832,
+        0, 1208, 1090, 1286, 0, 710, 0, 0, 0, 0, 75, 1609, 0, 0, 0, 443, 701, 447, 1288, 155, 0, 0,
+        306, 0, 0, 0, 0, 814, 0, 325, 1010, 0, 384, 122, 324, 0, 0, 175, 80, 204, 0, 0, 0, 677, 961,
+        421, 1285, 956, 0, 0, 0, 0, 1281, 0, 0, 0, 408, 0, 0, 1513, 0, 0, 1384, 0, 1546, 0, 1457, 0,
+        0, 0, 0, 0, 982, 0, 1730, 0, 0, 0, 1264, 0, 0, 1371, 91, 1452, 0, 1548, 0, 0, 655, 1653, 0,
+        1067, 0, 0, 965, 0, 0, 1492, 946, 0, 1070, 265, 371, 559, 0, 290, 0, 460, 453, 0, 0, 962,
+        309, 275, 807, 0, 631, 0, 0, 0, 0, 137, 0, 0, 0, 0, 1189, 545, 0, 20, 0, 901, 0, 1652, 0,
+        648, 1455, 310, 247, 848, 1514, 394, 568, 0, 308, 0, 366, 1081, 581, 1211, 22, 454, 1144,
+        1725, 598, 0, 0, 0, 0, 0, 0, 1143, 0, 0, 1080, 1502, 1237, 0, 0, 1803, 0, 1156, 0, 383, 0,
+        0, 1368, 0, 1297, 0, 0, 0, 0, 810, 0, 0, 355, 388, 1663, 533, 976, 0, 0, 0, 557, 0, 0, 1086,
+        1850, 0, 544, 0, 0, 0, 102, 0, 1706, 1253, 0, 0, 588, 0, 0, 0, 1162, 0, 203, 0, 0, 0, 1579,
+        0, 0, 1377, 1807, 0, 326, 1039, 148, 0, 0, 219, 298, 0, 0, 989, 1843, 0, 118, 0, 0, 0, 0,
+        734, 0, 439, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1630, 0, 1511, 0, 808, 0, 228, 656, 0, 0, 565, 692,
+        826, 0, 718, 0, 0, 424, 0, 0, 1022, 0, 1486, 0, 1694, 0, 0, 562, 554, 0, 0, 0, 904, 0, 820,
+        0, 1272, 1834, 0, 769, 0, 1810, 462, 0, 0, 73, 0, 1, 1158, 0, 0, 1610, 108, 0, 0, 0, 0, 637,
+        318, 1628, 164, 498, 1806, 0, 679, 0, 1799, 618, 1866, 177, 464, 0, 0, 0, 1756, 577, 1816,
+        0, 0, 0, 0, 141, 0, 0, 0, 587, 1681, 935, 813, 0, 0, 0, 0, 332, 0, 0, 1731, 1304, 0, 0, 0,
+        0, 1670, 0, 0, 1330, 0, 672, 0, 358, 302, 1389, 774, 0, 0, 0, 1671, 0, 0, 266, 0, 1796,
+        1688, 0, 0, 28, 0, 0, 667, 1293, 0, 0, 1612, 0, 0, 1759, 1225, 0, 1618, 0, 842, 0, 260, 258,
+        0, 244, 0, 0, 0, 931, 124, 0, 0, 1342, 580, 0, 0, 0, 0, 0, 1479, 474, 1464, 0, 1023, 1063,
+        1703, 1046, 1132, 0, 1577, 0, 1733, 849, 0, 0, 0, 1692, 0, 0, 1411, 0, 0, 917, 0, 0, 910, 0,
+        0, 0, 0, 1072, 689, 837, 0, 3, 0, 1433, 1258, 1325, 0, 0, 0, 0, 0, 611, 1420, 789, 676, 0,
+        0, 0, 0, 156, 816, 985, 0, 0, 1481, 795, 1016, 0, 0, 0, 1438, 754, 0, 1488, 1773, 0, 1069,
+        916, 0, 0, 0, 0, 0, 115, 1875, 0, 0, 1034, 0, 0, 0, 68, 0, 515, 0, 867, 911, 1362, 473, 0,
+        0, 1078, 0, 0, 311, 0, 0, 1907, 0, 1801, 441, 0, 1851, 0, 0, 437, 182, 0, 1199, 0, 0, 0,
+        1044, 482, 0, 1497, 350, 0, 1527, 0, 1902, 0, 0, 0, 1306, 1602, 0, 0, 0, 697, 0, 1238, 0,
+        623, 0, 0, 852, 0, 211, 0, 0, 0, 0, 0, 0, 0, 457, 86, 0, 1207, 0, 777, 1466, 1893, 0, 1842,
+        0, 0, 0, 0, 0, 0, 0, 0, 349, 560, 0, 317, 1470, 1033, 1127, 1064, 1426, 0, 0, 0, 999, 0,
+        930, 768, 1068, 1087, 0, 1100, 869, 0, 1295, 0, 0, 0, 0, 1043, 912, 0, 0, 0, 1588, 0, 0, 0,
+        592, 0, 0, 1436, 0, 1153, 0, 0, 0, 1696, 1290, 1364, 430, 0, 0, 0, 0, 0, 153, 0, 0, 0, 1163,
+        1587, 531, 0, 0, 0, 0, 0, 466, 0, 0, 0, 889, 1566, 1811, 0, 0, 1397, 1292, 1830, 1106, 103,
+        0, 0, 0, 0, 0, 1786, 0, 1614, 135, 1408, 0, 971, 0, 1763, 0, 1177, 44, 1819, 376, 0, 1556,
+        0, 0, 1386, 1705, 1749, 698, 0, 0, 0, 412, 1167, 694, 906, 0, 0, 0, 0, 1616, 1661, 1176,
+        1901, 134, 0, 1048, 1686, 0, 0, 0, 19, 286, 620, 1699, 1903, 0, 1650, 1496, 0, 1831, 0, 0,
+        1695, 1230, 1460, 1265, 1865, 0, 1537, 0, 1197, 1324, 0, 0, 0, 1897, 696, 165, 0, 0, 0,
+        1221, 1283, 0, 525, 419, 387, 0, 0, 1745, 1698, 307, 0, 0, 714, 0, 0, 130, 351, 1862, 0, 0,
+        138, 864, 62, 770, 0, 1358, 948, 126, 0, 1584, 0, 875, 0, 0, 0, 1379, 0, 0, 65, 0, 249, 0,
+        1723, 0, 860, 0, 189, 0, 1760, 0, 0, 1002, 511, 163, 112, 1840, 0, 914, 360, 0, 0, 200, 0,
+        0, 0, 0, 1305, 1583, 0, 0, 0, 0, 0, 0, 90, 94, 57, 0, 926, 0, 0, 1062, 0, 0, 0, 64, 0, 209,
+        50, 0, 1800, 180, 0, 630, 0, 142, 0, 516, 0, 0, 1406, 1855, 0, 0, 1407, 0, 802, 0, 1312, 0,
+        0, 0, 468, 329, 1277, 1413, 0, 0, 0, 0, 0, 938, 512, 786, 0, 1402, 465, 125, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 1054, 272, 0, 402, 0, 0, 0, 532, 0, 1836, 0, 0, 1013, 0, 340, 0, 0, 0, 0, 609,
+        1847, 0, 0, 0, 0, 0, 0, 0, 0, 0, 377, 761, 1254, 0, 0, 0, 1662, 0, 0, 898, 1319, 1598, 0, 0,
+        1414, 146, 757, 0, 1255, 0, 5, 0, 0, 0, 495, 1442, 0, 0, 0, 0, 0, 0, 921, 0, 0, 0, 0, 0,
+        1560, 0, 0, 606, 0, 0, 0, 0, 1531, 0, 0, 0, 76, 627, 902, 16, 194, 212, 0, 1092, 1239, 0,
+        1437, 45, 261, 0, 0, 881, 88, 0, 236, 0, 1608, 0, 224, 825, 1852, 1148, 1031, 1689, 0, 0, 0,
+        0, 773, 0, 1274, 0, 0, 0, 0, 1050, 0, 597, 0, 0, 590, 626, 0, 0, 937, 0, 0, 1473, 1667, 0,
+        199, 947, 0, 1526, 0, 1781, 0, 0, 150, 0, 1724, 987, 0, 0, 0, 0, 0, 0, 1673, 0, 1399, 1512,
+        0, 0, 0, 0, 0, 0, 671, 0, 0, 1677, 0, 179, 0, 0, 470, 0, 0, 0, 905, 0, 0, 0, 288, 0, 0, 735,
+        0, 0, 330, 1257, 0, 1251, 1739, 0, 251, 0, 0, 0, 1194, 0, 1680, 0, 818, 1463, 1171, 834,
+        1107, 0, 0, 0, 0, 0, 0, 548, 0, 1145, 1849, 771, 21, 1021, 0, 990, 1458, 0, 0, 614, 0, 806,
+        0, 0, 0, 576, 1629, 0, 0, 231, 0, 506, 323, 1794, 1037, 0, 0, 229, 0, 583, 0, 0, 0, 1217,
+        934, 1775, 259, 0, 0, 0, 0, 0, 0, 250, 166, 1627, 1322, 0, 522, 0, 960, 0, 1006, 0, 785, 0,
+        1206, 15, 0, 0, 0, 0, 0, 95, 0, 0, 193, 0, 218, 0, 0, 0, 0, 0, 798, 1018, 327, 0, 0, 0, 788,
+        337, 1213, 0, 0, 1415, 0, 1059, 0, 1744, 0, 1882, 0, 1060, 0, 242, 1574, 0, 1580, 0, 0, 269,
+        1827, 0, 0, 0, 815, 0, 227, 0, 479, 0, 0, 1028, 1181, 0, 0, 0, 0, 939, 835, 535, 1041, 270,
+        0, 0, 0, 1012, 161, 1564, 0, 586, 1074, 540, 0, 1485, 0, 0, 603, 0, 121, 0, 715, 1552, 0, 0,
+        762, 1490, 0, 1201, 1515, 1886, 0, 1007, 0, 0, 1416, 1038, 0, 823, 0, 0, 1077, 1423, 0, 70,
+        0, 109, 1854, 0, 505, 1134, 0, 0, 1226, 0, 0, 707, 1625, 169, 0, 0, 1040, 1262, 0, 0, 1073,
+        1336, 319, 1385, 0, 0, 0, 17, 0, 1210, 0, 0, 1333, 0, 0, 11, 0, 0, 0, 438, 0, 1778, 0, 0,
+        1266, 0, 1418, 0, 0, 0, 1461, 1287, 850, 0, 1899, 1387, 0, 0, 0, 0, 1563, 966, 0, 1441, 52,
+        0, 168, 1376, 0, 0, 0, 1748, 1761, 0, 0, 809, 1877, 0, 136, 0, 395, 0, 0, 0, 528, 0, 1891,
+        0, 104, 1410, 1279, 1125, 1690, 662, 1613, 459, 853, 508, 1110, 0, 1770, 1815, 0, 1732, 925,
+        485, 855, 0, 0, 0, 0, 0, 0, 0, 0, 0, 720, 725, 1846, 440, 529, 1170, 1501, 0, 278, 0, 1108,
+        0, 1888, 276, 0, 1082, 0, 0, 0, 0, 928, 0, 105, 0, 0, 0, 863, 0, 1091, 887, 56, 0, 0, 0,
+        1822, 0, 0, 652, 1672, 0, 274, 0, 1764, 0, 0, 0, 1212, 36, 0, 14, 1797, 0, 0, 0, 456, 0, 0,
+        876, 0, 919, 1499, 0, 1881, 0, 0, 0, 1430, 0, 1329, 2, 374, 0, 0, 0, 1184, 763, 0, 1771, 0,
+        1445, 0, 0, 0, 0, 0, 1585, 1195, 469, 0, 972, 0, 0, 0, 0, 0, 372, 0, 1182, 0, 0, 0, 0, 1391,
+        0, 880, 943, 475, 0, 0, 1835, 448, 0, 1684, 267, 0, 0, 0, 7, 0, 364, 296, 0, 0, 0, 1450, 0,
+        0, 0, 0, 0, 255, 0, 1557, 0, 0, 1517, 1058, 979, 0, 0, 1302, 1123, 983, 428, 60, 61, 1223,
+        0, 463, 0, 831, 1626, 0, 31, 680, 0, 998, 0, 0, 0, 0, 0, 1352, 1743, 1065, 222, 1620, 0,
+        1726, 0, 758, 661, 0, 670, 812, 0, 0, 0, 245, 1159, 0, 299, 922, 0, 0, 356, 0, 542, 304,
+        1338, 300, 0, 1248, 0, 0, 0, 1259, 0, 0, 1777, 0, 0, 0, 0, 0, 0, 1685, 892, 0, 0, 1623, 0,
+        0, 0, 0, 190, 0, 0, 954, 1233, 0, 1664, 1137, 0, 724, 799, 646, 0, 1878, 0, 874, 0, 0, 0,
+        885, 0, 0, 1742, 1440, 625, 0, 0, 1231, 174, 1509, 0, 1750, 1562, 0, 1126, 0, 0, 0, 0, 1720,
+        1422, 0, 0, 0, 0, 1448, 828, 1788, 0, 0, 664, 1271, 0, 0, 0, 0, 0, 489, 1682, 429, 1356, 0,
+        0, 0, 861, 0, 0, 1249, 564, 0, 446, 0, 0, 0, 393, 0, 0, 0, 0, 1518, 0, 1747, 1179, 1180, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1191, 699, 1252, 0, 119, 0, 0, 613, 0, 87, 0, 84, 0, 0,
+        1185, 0, 1638, 0, 0, 0, 1712, 431, 0, 0, 0, 315, 129, 1601, 0, 0, 0, 0, 0, 1101, 0, 0, 0,
+        1533, 488, 0, 262, 1644, 0, 684, 0, 1066, 0, 727, 0, 1554, 0, 0, 0, 334, 1026, 0, 0, 0, 650,
+        0, 504, 170, 1542, 157, 647, 0, 0, 572, 0, 579, 988, 0, 737, 0, 375, 0, 0, 0, 1809, 1845,
+        1495, 0, 0, 1260, 1869, 0, 0, 0, 41, 398, 0, 0, 681, 0, 0, 85, 0, 0, 0, 0, 1498, 605, 0,
+        1701, 0, 0, 1543, 978, 0, 0, 0, 804, 1099, 996, 0, 0, 1573, 0, 0, 10, 287, 0, 117, 1335, 0,
+        0, 0, 1553, 0, 0, 0, 0, 0, 1767, 1536, 0, 632, 1656, 1346, 0, 373, 0, 1382, 0, 641, 1624, 0,
+        1581, 0, 1228, 0, 731, 0, 1873, 964, 0, 0, 0, 26, 0, 0, 0, 0, 435, 574, 0, 1721, 836, 0, 0,
+        0, 0, 4, 0, 1247, 107, 712, 53, 0, 0, 38, 409, 0, 0, 0, 991, 0, 1136, 1611, 0, 0, 0, 0, 0,
+        642, 1535, 0, 1853, 0, 0, 0, 709, 0, 721, 341, 369, 760, 0, 0, 0, 0, 1722, 0, 1241, 0, 953,
+        0, 0, 0, 1600, 1472, 1307, 1561, 379, 955, 471, 890, 0, 1752, 865, 0, 0, 0, 0, 0, 328, 0, 0,
+        859, 0, 343, 0, 0, 778, 0, 0, 733, 1507, 0, 0, 0, 214, 633, 1687, 0, 957, 0, 1824, 0, 1313,
+        1432, 829, 0, 0, 653, 0, 197, 0, 502, 0, 0, 0, 0, 0, 246, 0, 547, 0, 841, 0, 1128, 352, 176,
+        1098, 0, 0, 0, 1142, 1798, 0, 0, 1659, 0, 0, 872, 0, 0, 0, 0, 0, 0, 0, 1844, 0, 0, 0, 0, 0,
+        1451, 1779, 0, 0, 0, 1173, 1604, 1675, 171, 1867, 221, 0, 1403, 549, 1676, 0, 0, 705, 0,
+        830, 1503, 0, 1003, 575, 0, 1863, 1071, 584, 1539, 0, 0, 0, 1590, 0, 0, 0, 0, 0, 0, 589,
+        1570, 0, 1374, 0, 0, 131, 346, 585, 1493, 370, 1339, 96, 1523, 449, 933, 1860, 1505, 226,
+        854, 1646, 0, 0, 0, 891, 1232, 0, 1565, 1904, 0, 0, 0, 500, 1388, 0, 0, 0, 0, 708, 981, 0,
+        0, 566, 0, 0, 0, 0, 0, 0, 0, 1589, 0, 0, 530, 1666, 0, 0, 1758, 924, 0, 1192, 571, 0, 0,
+        188, 1234, 0, 1434, 0, 1551, 0, 277, 0, 0, 0, 1459, 0, 0, 945, 400, 0, 0, 423, 0, 407, 0,
+        1337, 461, 185, 361, 686, 0, 110, 0, 0, 0, 0, 1341, 1615, 0, 1591, 0, 1905, 0, 43, 0, 0, 0,
+        143, 281, 0, 1309, 0, 0, 0, 775, 0, 279, 0, 54, 0, 0, 0, 0, 748, 765, 509, 0, 622, 0, 0, 0,
+        0, 0, 0, 1311, 1541, 378, 736, 1214, 663, 93, 0, 1088, 0, 0, 253, 0, 158, 1190, 0, 1599,
+        1200, 1009, 1209, 0, 1540, 0, 483, 0, 1454, 1832, 0, 0, 1467, 69, 0, 1359, 0, 59, 116, 0, 0,
+        0, 0, 0, 0, 1772, 202, 0, 0, 0, 0, 0, 0, 1898, 607, 0, 0, 1674, 1510, 1053, 0, 491, 0, 0, 0,
+        0, 1278, 0, 1008, 1350, 0, 0, 1636, 0, 800, 0, 0, 0, 0, 1425, 1314, 0, 0, 1269, 0, 1227, 0,
+        293, 0, 0, 0, 843, 0, 1224, 0, 0, 0, 0, 1751, 71, 740, 0, 0, 0, 0, 0, 0, 0, 1284, 1791, 0,
+        1198, 0, 0, 0, 797, 0, 0, 1280, 0, 0, 717, 536, 0, 1728, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1519,
+        9, 58, 0, 0, 0, 0, 0, 451, 0, 0, 234, 1576, 0, 0, 0, 0, 0, 1736, 1268, 0, 0, 241, 1569, 0,
+        0, 0, 0, 1645, 0, 239, 0, 1802, 0, 0, 0, 0, 0, 0, 920, 0, 295, 638, 1056, 1895, 0, 0, 1884,
+        0, 1375, 0, 365, 1169, 871, 1373, 0, 897, 0, 1112, 0, 0, 0, 1755, 0, 0, 0, 0, 1020, 1785,
+        845, 0, 316, 1243, 331, 0, 97, 0, 628, 0, 1715, 0, 1711, 0, 1868, 1713, 257, 1568, 1315,
+        1149, 0, 0, 756, 0, 821, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1607, 0, 0, 0, 8, 1366, 1494,
+        0, 0, 0, 1222, 1529, 0, 39, 0, 1256, 1524, 0, 0, 195, 303, 1586, 1754, 0, 635, 510, 899, 0,
+        0, 0, 415, 0, 0, 1242, 1606, 0, 1102, 0, 0, 0, 1363, 1291, 0, 256, 657, 970, 0, 1774, 0, 0,
+        0, 0, 1267, 0, 0, 0, 0, 0, 0, 1378, 1575, 0, 0, 1000, 0, 0, 1804, 1049, 0, 0, 0, 1814, 0, 0,
+        1521, 1365, 0, 264, 0, 1129, 0, 1061, 0, 0, 1453, 1783, 1639, 0, 0, 74, 1634, 0, 0, 1165, 0,
+        0, 0, 0, 0, 0, 477, 1861, 791, 223, 0, 0, 0, 1276, 0, 1833, 1890, 0, 752, 0, 0, 25, 1353, 0,
+        271, 0, 481, 0, 0, 0, 0, 159, 411, 0, 0, 392, 0, 0, 1506, 55, 0, 0, 0, 0, 0, 0, 132, 0, 0,
+        0, 0, 838, 417, 455, 0, 967, 0, 196, 235, 0, 1691, 0, 0, 659, 47, 0, 0, 523, 0, 1029, 582,
+        486, 0, 0, 674, 0, 0, 0, 513, 0, 941, 866, 980, 0, 0, 0, 0, 1435, 1545, 1203, 1027, 0, 1263,
+        490, 1762, 0, 1036, 0, 0, 0, 1643, 1051, 0, 0, 268, 0, 427, 0, 0, 0, 1693, 0, 0, 0, 1261, 0,
+        0, 396, 386, 292, 942, 280, 0, 1394, 198, 0, 0, 1838, 0, 1150, 1889, 0, 42, 0, 0, 0, 0, 0,
+        167, 782, 0, 0, 0, 649, 783, 0, 0, 0, 0, 704, 0, 0, 1637, 0, 140, 0, 81, 0, 217, 0, 0, 181,
+        0, 660, 0, 0, 0, 1317, 35, 973, 186, 1719, 0, 1477, 1289, 1871, 1504, 0, 0, 0, 1578, 0, 0,
+        432, 0, 1427, 0, 1395, 0, 0, 0, 0, 1011, 1186, 0, 702, 0, 1412, 301, 0, 0, 651, 0, 0, 1679,
+        0, 1321, 0, 780, 0, 82, 0, 0, 1491, 0, 827, 1829, 0, 746, 0, 621, 0, 0, 1812, 0, 1790, 0, 0,
+        900, 944, 1164, 0, 0, 0, 1235, 0, 601, 0, 0, 0, 436, 367, 0, 0, 0, 0, 6, 0, 354, 1456, 0, 0,
+        0, 305, 114, 363, 0, 1270, 0, 1105, 1635, 569, 0, 347, 0, 1841, 0, 0, 0, 0, 0, 610, 0, 1308,
+        1469, 0, 0, 0, 442, 997, 1839, 1193, 1793, 0, 0, 0, 0, 700, 0, 1085, 0, 0, 1216, 0, 0, 0,
+        1567, 0, 0, 524, 0, 0, 0, 345, 0, 27, 0, 458, 0, 0, 0, 0, 0, 0, 1111, 0, 0, 1428, 0, 1320,
+        538, 339, 1124, 0, 1792, 0, 0, 0, 0, 1520, 1316, 0, 426, 0, 0, 0, 517, 0, 144, 936, 0, 0,
+        526, 1468, 0, 1544, 1489, 362, 951, 0, 99, 0, 1621, 0, 0, 0, 884, 0, 494, 1429, 1155, 1392,
+        0, 0, 932, 0, 0, 1334, 1380, 1327, 1649, 753, 151, 1014, 521, 0, 0, 730, 0, 1019, 335, 263,
+        747, 0, 772, 0, 0, 0, 0, 1880, 0, 518, 283, 0, 0, 0, 0, 0, 1740, 0, 232, 0, 0, 72, 0, 0, 0,
+        420, 0, 1525, 0, 205, 0, 1784, 1660, 645, 0, 1282, 273, 534, 1787, 0, 629, 0, 46, 240, 1595,
+        984, 0, 819, 314, 139, 1076, 716, 796, 149, 0, 147, 40, 986, 0, 868, 688, 0, 0, 883, 1303,
+        480, 968, 192, 434, 0, 152, 183, 1141, 552, 191, 0, 0, 1651, 0, 0, 0, 790, 0, 0, 1152, 0,
+        803, 1419, 0, 238, 0, 673, 0, 0, 0, 563, 0, 0, 1120, 0, 0, 950, 0, 1298, 685, 385, 644, 201,
+        1118, 0, 723, 1848, 348, 0, 1633, 1301, 0, 0, 1780, 0, 1174, 0, 665, 683, 1658, 636, 969,
+        639, 0, 858, 0, 1528, 0, 0, 792, 0, 546, 0, 0, 0, 0, 0, 1131, 0, 0, 822, 975, 0, 406, 0,
+        1555, 0, 824, 0, 1354, 1704, 0, 0, 0, 472, 0, 1737, 0, 0, 1370, 599, 0, 0, 0, 0, 0, 0, 1113,
+        0, 0, 127, 839, 0, 862, 1870, 668, 444, 0, 1133, 1168, 691, 1296, 1130, 0, 847, 0, 0, 0,
+        1734, 1323, 0, 1273, 993, 0, 0, 0, 0, 1768, 1596, 1683, 333, 1409, 0, 1571, 1631, 1057, 391,
+        0, 0, 0, 0, 0, 0, 0, 380, 0, 784, 493, 0, 1594, 0, 0, 0, 0, 0, 0, 1443, 514, 0, 1530, 1856,
+        0, 1741, 1079, 162, 1714, 0, 0, 0, 0, 0, 1250, 1095, 543, 0, 210, 0, 0, 0, 1161, 0, 29, 0,
+        0, 1360, 0, 0, 1275, 1657, 909, 321, 0, 401, 89, 1361, 0, 1024, 0, 0, 994, 484, 888, 0, 414,
+        0, 98, 0, 18, 0, 0, 0, 0, 776, 1396, 0, 0, 405, 0, 0, 0, 0, 66, 0, 0, 1820, 1119, 608, 857,
+        0, 0, 1859, 1735, 908, 0, 0, 0, 640, 0, 682, 573, 0, 0, 1055, 282, 675, 0, 0, 949, 882, 0,
+        0, 0, 1219, 0, 779, 0, 1547, 0, 106, 1344, 0, 0, 0, 0, 0, 0, 0, 1089, 1404, 594, 1605, 0, 0,
+        690, 0, 706, 0, 1294, 1757, 0, 0, 0, 1593, 1245, 0, 0, 0, 0, 33, 0, 0, 1045, 537, 0, 1668,
+        49, 1355, 0, 1821, 1708, 0, 0, 0, 1483, 0, 0, 0, 0, 0, 0, 0, 1549, 617, 0, 0, 0, 0, 0, 1300,
+        0, 0, 1654, 1183, 0, 0, 0, 0, 0, 0, 0, 1478, 0, 23, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1017,
+        1678, 844, 0, 0, 0, 0, 1864, 1655, 1559, 0, 359, 0, 12, 1516, 1648, 0, 0, 0, 0, 1669, 0, 0,
+        669, 0, 1892, 0, 0, 0, 1146, 0, 1299, 0, 1622, 1746, 1484, 207, 0, 0, 1641, 1097, 0, 0, 570,
+        0, 0, 0, 678, 0, 1709, 381, 0, 0, 0, 940, 0, 0, 1766, 1894, 1188, 0, 1122, 1632, 285, 1328,
+        0, 67, 0, 1828, 0, 248, 0, 397, 0, 0, 0, 0, 1318, 0, 0, 0, 0, 0, 0, 0, 0, 992, 0, 0, 0,
+        1096, 0, 0, 595, 0, 729, 368, 254, 0, 0, 0, 284, 0, 893, 0, 313, 0, 0, 0, 1154, 413, 0, 0,
+        619, 903, 0, 553, 1753, 0, 0, 0, 0, 1572, 0,
+    }};
+    /// length of each string in the table
+    constexpr std::array<uint16_t, 1907> lengths{{
+        0, 2, 3, 7, 7, 1, 3, 3, 3, 8, 8, 4, 4, 9, 9, 8, 3, 4, 3, 3, 4, 3, 4, 4, 4, 4, 7, 7, 6, 3, 2,
+        4, 4, 3, 5, 5, 4, 5, 4, 4, 5, 4, 5, 5, 5, 4, 4, 5, 4, 2, 3, 3, 6, 6, 5, 3, 7, 5, 6, 4, 8, 7,
+        7, 10, 7, 8, 11, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4, 3, 1, 7, 10, 8, 3, 2, 10, 3, 3, 2, 2, 4,
+        11, 4, 2, 2, 4, 4, 4, 1, 2, 5, 6, 5, 5, 2, 1, 2, 15, 5, 6, 2, 2, 8, 3, 5, 4, 3, 4, 5, 4, 16,
+        3, 3, 4, 1, 5, 5, 2, 10, 2, 3, 6, 5, 3, 2, 5, 11, 2, 1, 5, 10, 1, 3, 4, 7, 2, 1, 4, 1, 5, 4,
+        2, 8, 2, 8, 3, 4, 4, 2, 15, 3, 3, 1, 3, 3, 3, 6, 11, 5, 5, 2, 3, 2, 7, 6, 11, 2, 10, 2, 3,
+        11, 16, 1, 6, 7, 9, 10, 9, 10, 4, 5, 1, 2, 2, 6, 2, 2, 6, 3, 3, 1, 5, 5, 6, 1, 7, 7, 6, 1,
+        5, 3, 7, 3, 9, 3, 3, 3, 2, 3, 5, 5, 7, 7, 1, 6, 7, 3, 3, 6, 3, 3, 2, 8, 5, 7, 2, 5, 1, 5, 1,
+        5, 7, 7, 3, 9, 3, 5, 2, 2, 5, 3, 5, 3, 2, 2, 2, 2, 9, 10, 8, 5, 5, 1, 2, 2, 2, 3, 4, 8, 3,
+        5, 13, 11, 11, 19, 17, 2, 8, 3, 3, 3, 2, 4, 6, 6, 6, 8, 5, 4, 4, 7, 7, 9, 7, 2, 3, 5, 4, 7,
+        6, 7, 2, 5, 8, 5, 7, 16, 19, 16, 5, 2, 3, 7, 5, 4, 7, 23, 6, 8, 16, 6, 8, 23, 3, 7, 6, 8,
+        10, 3, 4, 6, 5, 8, 9, 5, 7, 7, 6, 9, 6, 8, 6, 4, 4, 10, 3, 5, 7, 3, 11, 12, 5, 13, 7, 2, 4,
+        6, 4, 6, 2, 2, 4, 6, 2, 2, 4, 4, 3, 6, 9, 9, 11, 2, 3, 4, 5, 7, 4, 6, 6, 8, 7, 4, 5, 7, 7,
+        7, 4, 3, 5, 7, 3, 5, 7, 2, 3, 5, 7, 3, 3, 3, 4, 3, 3, 4, 5, 4, 4, 2, 3, 3, 3, 7, 7, 4, 6, 4,
+        6, 2, 4, 6, 7, 6, 4, 5, 5, 7, 6, 7, 8, 2, 3, 5, 7, 2, 3, 5, 7, 5, 7, 9, 10, 7, 5, 7, 7, 5,
+        7, 6, 5, 4, 5, 7, 16, 5, 7, 23, 6, 8, 9, 10, 5, 7, 7, 5, 7, 7, 6, 8, 15, 17, 5, 7, 7, 5, 7,
+        7, 6, 8, 9, 4, 5, 8, 9, 9, 6, 9, 9, 3, 3, 12, 6, 3, 6, 5, 8, 5, 6, 3, 8, 5, 7, 4, 3, 4, 3,
+        6, 2, 11, 2, 2, 1, 4, 3, 2, 1, 1, 4, 6, 8, 9, 2, 2, 1, 2, 1, 4, 6, 5, 3, 6, 7, 9, 10, 3, 8,
+        6, 4, 7, 6, 5, 8, 10, 10, 6, 7, 7, 3, 6, 9, 5, 3, 10, 8, 6, 4, 5, 10, 10, 8, 10, 8, 3, 10,
+        8, 6, 4, 5, 2, 5, 7, 2, 2, 3, 4, 4, 12, 7, 10, 4, 4, 7, 4, 11, 4, 3, 7, 4, 11, 3, 8, 9, 8,
+        7, 6, 14, 15, 10, 3, 3, 1, 2, 1, 5, 4, 9, 6, 4, 2, 13, 1, 1, 3, 9, 2, 2, 6, 4, 2, 13, 1, 3,
+        3, 3, 6, 3, 10, 3, 5, 2, 4, 8, 5, 10, 4, 4, 8, 6, 5, 8, 4, 4, 17, 3, 16, 5, 6, 5, 3, 4, 5,
+        5, 4, 2, 3, 2, 3, 4, 2, 3, 3, 8, 7, 4, 5, 6, 4, 5, 6, 3, 3, 2, 2, 7, 5, 6, 11, 5, 4, 4, 3,
+        3, 10, 7, 8, 10, 4, 5, 13, 10, 10, 7, 10, 2, 2, 3, 10, 2, 4, 6, 3, 6, 3, 3, 6, 8, 4, 6, 7,
+        6, 8, 3, 5, 7, 9, 3, 5, 8, 3, 7, 2, 10, 2, 9, 2, 10, 2, 9, 2, 4, 9, 10, 2, 6, 3, 3, 3, 3,
+        12, 20, 5, 3, 3, 3, 3, 5, 18, 7, 4, 6, 3, 1, 3, 16, 3, 4, 3, 15, 30, 21, 3, 12, 5, 3, 5, 10,
+        10, 12, 10, 12, 17, 2, 2, 3, 16, 14, 24, 5, 2, 1, 6, 8, 2, 1, 2, 1, 2, 1, 2, 1, 2, 3, 1, 3,
+        5, 4, 4, 5, 5, 4, 7, 5, 6, 5, 5, 6, 5, 4, 7, 3, 3, 1, 6, 3, 5, 3, 5, 4, 4, 5, 3, 3, 5, 5, 3,
+        3, 19, 20, 2, 2, 2, 4, 2, 2, 7, 3, 5, 3, 22, 23, 2, 2, 6, 2, 2, 4, 5, 9, 3, 7, 3, 3, 2, 2,
+        5, 2, 2, 2, 7, 2, 2, 7, 7, 2, 2, 1, 3, 1, 5, 2, 2, 5, 1, 5, 8, 7, 6, 8, 9, 9, 3, 3, 1, 3, 3,
+        7, 4, 4, 11, 2, 2, 7, 2, 8, 2, 2, 5, 8, 3, 7, 3, 2, 2, 3, 3, 4, 5, 3, 21, 2, 2, 5, 3, 1, 11,
+        10, 3, 4, 7, 5, 3, 4, 3, 5, 2, 2, 9, 20, 5, 4, 3, 2, 4, 5, 9, 8, 7, 6, 8, 8, 6, 7, 8, 15, 4,
+        3, 2, 2, 7, 4, 1, 3, 2, 5, 2, 9, 3, 4, 5, 4, 10, 3, 6, 3, 5, 2, 8, 2, 8, 6, 3, 8, 3, 3, 3,
+        3, 3, 4, 4, 5, 2, 7, 4, 5, 4, 5, 5, 5, 4, 7, 2, 10, 12, 13, 4, 3, 5, 21, 20, 20, 15, 22, 17,
+        15, 21, 15, 14, 9, 13, 7, 3, 5, 21, 22, 20, 18, 12, 3, 4, 5, 12, 3, 5, 16, 17, 18, 16, 10,
+        3, 11, 3, 12, 5, 14, 14, 15, 16, 2, 3, 5, 7, 3, 6, 8, 9, 5, 7, 2, 4, 6, 7, 4, 6, 5, 3, 3, 3,
+        3, 3, 2, 2, 2, 12, 12, 3, 12, 3, 3, 5, 5, 22, 12, 13, 16, 20, 8, 9, 14, 13, 11, 10, 8, 14,
+        13, 10, 7, 6, 7, 6, 9, 8, 8, 5, 11, 6, 5, 6, 10, 10, 6, 6, 10, 3, 7, 4, 4, 4, 4, 11, 3, 3,
+        3, 4, 4, 4, 5, 5, 20, 6, 6, 6, 8, 9, 6, 6, 6, 8, 9, 6, 6, 6, 8, 9, 5, 5, 5, 6, 6, 6, 8, 6,
+        3, 3, 6, 8, 9, 9, 15, 7, 7, 7, 4, 4, 4, 7, 3, 3, 4, 26, 29, 3, 3, 3, 3, 18, 3, 3, 3, 3, 3,
+        5, 10, 18, 13, 6, 3, 2, 19, 19, 14, 7, 3, 7, 3, 3, 3, 4, 18, 19, 16, 17, 5, 5, 4, 6, 5, 9,
+        5, 7, 4, 6, 7, 6, 7, 9, 9, 13, 11, 13, 15, 19, 10, 10, 9, 26, 11, 16, 13, 11, 17, 3, 4, 6,
+        6, 4, 6, 6, 3, 4, 5, 5, 5, 12, 14, 14, 14, 15, 20, 21, 5, 7, 7, 5, 7, 7, 4, 5, 6, 6, 10, 12,
+        13, 13, 12, 13, 12, 18, 19, 4, 4, 4, 4, 5, 3, 9, 6, 8, 8, 6, 8, 7, 5, 3, 3, 12, 3, 12, 2, 4,
+        2, 4, 1, 1, 2, 5, 5, 2, 2, 3, 6, 8, 9, 15, 6, 5, 8, 12, 17, 3, 6, 8, 11, 6, 8, 8, 9, 11, 14,
+        8, 11, 4, 6, 8, 11, 6, 11, 8, 2, 3, 5, 7, 10, 5, 3, 3, 10, 1, 2, 5, 5, 3, 2, 6, 1, 3, 3, 21,
+        14, 7, 4, 18, 18, 19, 12, 18, 12, 7, 22, 22, 2, 2, 4, 4, 8, 10, 8, 10, 2, 2, 2, 3, 1, 3, 3,
+        4, 2, 2, 3, 3, 5, 5, 5, 15, 14, 6, 3, 4, 2, 2, 2, 2, 2, 22, 5, 4, 2, 6, 5, 4, 5, 4, 7, 6, 3,
+        8, 10, 13, 6, 8, 12, 6, 8, 8, 7, 10, 7, 2, 2, 4, 5, 5, 4, 7, 7, 8, 5, 7, 2, 4, 5, 4, 7, 6,
+        7, 12, 4, 7, 9, 18, 7, 9, 17, 7, 9, 3, 6, 6, 13, 16, 16, 20, 19, 8, 8, 12, 10, 13, 12, 8, 8,
+        10, 7, 9, 8, 11, 6, 6, 5, 8, 7, 9, 7, 10, 9, 10, 6, 5, 7, 8, 8, 5, 6, 3, 8, 14, 11, 5, 7, 7,
+        10, 5, 7, 7, 5, 7, 8, 5, 5, 7, 8, 4, 6, 7, 7, 4, 7, 7, 16, 6, 5, 8, 17, 5, 8, 7, 1, 2, 5, 4,
+        11, 11, 13, 13, 14, 14, 10, 10, 2, 9, 2, 4, 8, 8, 10, 10, 2, 12, 13, 14, 15, 11, 11, 7, 7,
+        3, 2, 2, 6, 2, 5, 6, 6, 8, 3, 10, 3, 10, 13, 4, 4, 2, 3, 9, 5, 5, 2, 3, 6, 8, 14, 3, 6, 8,
+        8, 11, 4, 5, 3, 3, 6, 8, 10, 13, 7, 5, 4, 3, 5, 7, 7, 10, 5, 7, 15, 10, 5, 4, 7, 17, 12, 5,
+        7, 17, 12, 5, 2, 5, 7, 8, 4, 7, 5, 7, 4, 2, 7, 6, 8, 2, 5, 7, 4, 7, 5, 6, 7, 9, 3, 6, 5, 8,
+        8, 11, 8, 6, 8, 10, 7, 5, 5, 7, 8, 5, 7, 7, 6, 8, 7, 5, 5, 7, 7, 5, 6, 7, 9, 6, 7, 8, 13, 6,
+        8, 12, 6, 8, 8, 9, 6, 13, 11, 7, 6, 6, 3, 3, 4, 4, 3, 4, 3, 5, 15, 3, 4, 3, 5, 15, 3, 4, 4,
+        4, 6, 16, 3, 4, 19, 5, 5, 4, 7, 3, 5, 5, 3, 5, 4, 4, 14, 13, 12, 6, 5, 8, 13, 12, 11, 6, 5,
+        8, 4, 6, 5, 7, 5, 7, 5, 10, 7, 6, 8, 3, 5, 3, 6, 25, 3, 5, 11, 13, 11, 3, 32, 24, 5, 3, 25,
+        20, 8, 3, 19, 8, 8, 3, 4, 6, 7, 7, 13, 8, 5, 8, 2, 12, 29, 6, 8, 8, 14, 3, 5, 5, 4, 20, 11,
+        6, 19, 2, 4, 21, 6, 8, 4, 6, 5, 7, 3, 15, 15, 8, 8, 17, 15, 9, 1, 3, 2, 7, 8, 2, 2, 3, 6, 5,
+        3, 18, 13, 4, 6, 6, 6, 16, 7, 12, 7, 5, 4, 4, 2, 5, 7, 4, 5, 8, 5, 5, 5, 5, 12, 5, 6, 6, 5,
+        6, 5, 6, 16, 5, 5, 12, 6, 8, 7, 13, 9, 17, 8, 9, 4, 4, 7, 4, 5, 5, 5, 5, 6, 5, 11, 5, 6, 3,
+        12, 3, 14, 3, 13, 7, 7, 4, 4, 6, 2, 2, 5, 3, 8, 8, 5, 3, 18, 4, 4, 4, 4, 30, 28, 23, 6, 6,
+        5, 7, 7, 7, 7, 7, 7, 7, 7, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 2, 7, 4,
+    }};
+} // namespace base_unit_index
+} // namespace units
@@ -13,10 +13,13 @@ SPDX-License-Identifier: BSD-3-Clause
 #include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <tuple>
 #include <unordered_map>
+#include <vector>
 
 /*
 // https://en.wikipedia.org/wiki/List_of_traded_commodities
@@ -277,20 +280,239 @@ uint32_t stringHash(const std::string& str)
     return h; // or return h % C;
 }
 
-static std::atomic<bool> allowCustomCommodities{true};
+/** a bounded table of the names of unrecognized commodity strings indexed by their hash codes
+@details the table is split into buckets of four slots and a full bucket evicts its names in insertion order.
+Each slot is guarded by a sequence counter:  a reader copies the slot and discards the copy if the counter
+changed,  a writer claims a slot by making the counter odd and gives up if another writer holds it,  a name
+that is missed or not stored only means the code is shown as CXCOMM[code].  Names that don't fit in a slot are
+stored as immutable strings referenced from the slot,  a reader holds a reference to the string so an evicted
+name is released once no reader is using it.  Reads of names that fit in a slot are lock-free,  the reference
+to a longer name is copied with std::atomic_load and std::atomic_store on the shared_ptr which are not
+lock-free in common standard libraries (libstdc++ guards them with a pool of mutexes),  so reading or
+writing a long name may wait briefly on another thread using a shared_ptr that hashes to the same mutex
+*/
+class commodityNameTable {
+  public:
+    static constexpr size_t ways{4};
+    static constexpr size_t wordCount{7};
+    static constexpr size_t maxNameLength{wordCount * sizeof(uint64_t)};
+
+    explicit commodityNameTable(size_t capacity) :
+        mask(bucketCount(capacity) - 1), slots((mask + 1) * ways), cursors(mask + 1)
+    {
+    }
+    /// find the name stored for a code
+    bool find(uint32_t code, std::string& name) const
+    {
+        auto base = (code & mask) * ways;
+        for (size_t ii = base; ii < base + ways; ++ii) {
+            const auto& slt = slots[ii];
+            auto sequence = slt.sequence.load(std::memory_order_acquire);
+            if ((sequence & 1U) != 0 || slt.code.load(std::memory_order_relaxed) != code) {
+                continue;
+            }
+            std::array<uint64_t, wordCount> words;
+            for (size_t jj = 0; jj < wordCount; ++jj) {
+                words[jj] = slt.words[jj].load(std::memory_order_relaxed);
+            }
+            // the stored names are never empty so an empty name is stored out of line
+            std::shared_ptr<const std::string> longName;
+            if (words[0] == 0) {
+                longName = std::atomic_load(&slt.longName);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slt.sequence.load(std::memory_order_relaxed) != sequence) {
+                continue;
+            }
+            if (words[0] == 0) {
+                if (!longName) {
+                    continue;
+                }
+                name = *longName;
+                return true;
+            }
+            std::array<char, maxNameLength> buffer;
+            std::memcpy(buffer.data(), words.data(), maxNameLength);
+            name.assign(buffer.data(), std::find(buffer.begin(), buffer.end(), '\0'));
+            return true;
+        }
+        return false;
+    }
+    /// store the name of a code if it is not already stored
+    void insert(const std::string& name, uint32_t code)
+    {
+        std::string existing;
+        if (find(code, existing) || name.empty()) {
+            return;
+        }
+        // build the out of line string before claiming the slot so the slot is held briefly
+        std::shared_ptr<const std::string> longName;
+        if (name.size() > maxNameLength) {
+            longName = std::make_shared<const std::string>(name);
+        }
+        auto bucket = code & mask;
+        auto base = bucket * ways;
+        // use an empty slot if there is one,  otherwise the oldest name in the bucket
+        auto target = base + ways;
+        for (size_t ii = base; ii < base + ways; ++ii) {
+            if (slots[ii].code.load(std::memory_order_relaxed) == 0) {
+                target = ii;
+                break;
+            }
+        }
+        if (target == base + ways) {
+            target = base + cursors[bucket].fetch_add(1, std::memory_order_relaxed) % ways;
+        }
+        auto& slt = slots[target];
+        auto sequence = slt.sequence.load(std::memory_order_relaxed);
+        if ((sequence & 1U) != 0 ||
+            !slt.sequence.compare_exchange_strong(
+                sequence, sequence + 1, std::memory_order_acquire)) {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        bool occupied = (slt.code.load(std::memory_order_relaxed) != 0);
+        std::array<uint64_t, wordCount> words{};
+        if (!longName) {
+            std::memcpy(words.data(), name.data(), name.size());
+        }
+        auto previous = std::atomic_load(&slt.longName);
+        if (previous) {
+            longNameMemory.fetch_sub(longNameSize(*previous), std::memory_order_relaxed);
+        }
+        if (longName) {
+            longNameMemory.fetch_add(longNameSize(*longName), std::memory_order_relaxed);
+        }
+        std::atomic_store(&slt.longName, std::move(longName));
+        slt.code.store(code, std::memory_order_relaxed);
+        for (size_t jj = 0; jj < wordCount; ++jj) {
+            slt.words[jj].store(words[jj], std::memory_order_relaxed);
+        }
+        slt.sequence.store(sequence + 2, std::memory_order_release);
+        if (occupied) {
+            evictions.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            count.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    /// add the usage of the table to a set of statistics
+    void addStatistics(commodity_statistics& stats) const
+    {
+        stats.names = count.load(std::memory_order_relaxed);
+        stats.capacity = slots.size();
+        stats.evictions = evictions.load(std::memory_order_relaxed);
+        stats.rejected = rejected.load(std::memory_order_relaxed);
+        stats.memory += sizeof(commodityNameTable) + slots.size() * sizeof(slot) +
+            cursors.size() * sizeof(std::atomic<uint32_t>) +
+            longNameMemory.load(std::memory_order_relaxed);
+    }
+
+  private:
+    struct slot {
+        std::atomic<uint32_t> sequence{0};
+        std::atomic<uint32_t> code{0};
+        std::array<std::atomic<uint64_t>, wordCount> words;
+        /// the name if it is longer than maxNameLength,  accessed with std::atomic_load and atomic_store,  which
+        /// may take a lock
+        std::shared_ptr<const std::string> longName;
+        slot()
+        {
+            for (auto& word : words) {
+                word.store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+    /// the number of buckets to use for a capacity,  always a power of 2
+    static size_t bucketCount(size_t capacity)
+    {
+        size_t buckets{1};
+        while (buckets * ways < capacity) {
+            buckets *= 2;
+        }
+        return buckets;
+    }
+    /// the approximate memory used by a name stored out of line including its shared_ptr control block
+    static size_t longNameSize(const std::string& name)
+    {
+        return sizeof(std::string) + name.capacity() + 1 + 4 * sizeof(void*);
+    }
+    const size_t mask;
+    std::vector<slot> slots;
+    std::vector<std::atomic<uint32_t>> cursors;
+    std::atomic<size_t> count{0};
+    std::atomic<uint64_t> evictions{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<size_t> longNameMemory{0};
+};
+
+/// an immutable snapshot of the custom commodities,  the name table is shared between snapshots
+struct commodityRegistry {
+    commodities::commodityNameMap codes;
+    std::unordered_map<uint32_t, std::string> names;
+    std::shared_ptr<commodityNameTable> table;
+};
+
+namespace detail {
+    /** the custom commodities of a context
+    @details the commodities added by the user are published as immutable snapshots in the same way as the
+    user defined units,  so a lookup takes no locks in the common case*/
+    struct commodityContextData {
+        std::atomic<bool> allowCustomCommodities{true};
+        std::atomic<size_t> nameCapacity{1024};
+        std::shared_ptr<const commodityRegistry> registry;
+        std::atomic<uint64_t> version{0};
+        /// writers are serialized so no update is lost
+        std::mutex writeLock;
+    };
+} // namespace detail
+
+/// the custom commodities used when no context is active
+static detail::commodityContextData globalCommodityData;
+/// source of the versions of the commodity snapshots
+static std::atomic<uint64_t> commodityVersions{0};
+
+/** get the current custom commodities of a context for this thread,  nullptr if there are none
+@details the pointer is valid until the next call from the same thread*/
+static const commodityRegistry* commodityRegistryFor(detail::commodityContextData& data)
+{
+    thread_local std::shared_ptr<const commodityRegistry> localSnapshot;
+    thread_local uint64_t localVersion{0};
+    auto version = data.version.load(std::memory_order_acquire);
+    if (version != localVersion) {
+        localSnapshot = std::atomic_load(&data.registry);
+        localVersion = version;
+    }
+    return localSnapshot.get();
+}
+
+/// publish a new snapshot of the custom commodities,  the write lock must be held
+static void publishCommodities(
+    detail::commodityContextData& data,
+    std::shared_ptr<const commodityRegistry> registry)
+{
+    std::atomic_store(&data.registry, std::move(registry));
+    data.version.store(commodityVersions.fetch_add(1) + 1, std::memory_order_release);
+}
+
+// get a modifiable copy of the current snapshot,  the write lock must be held
+static std::shared_ptr<commodityRegistry> copyCommodities(detail::commodityContextData& data)
+{
+    auto current = std::atomic_load(&data.registry);
+    return (current) ? std::make_shared<commodityRegistry>(*current) :
+                       std::make_shared<commodityRegistry>();
+}
 
 bool disableCustomCommodities()
 {
-    allowCustomCommodities.store(false);
+    globalCommodityData.allowCustomCommodities.store(false);
     return false;
 }
 bool enableCustomCommodities()
 {
-    allowCustomCommodities.store(true);
+    globalCommodityData.allowCustomCommodities.store(true);
     return true;
 }
-static commodities::commodityNameMap customCommodityCodes;
-static std::unordered_map<uint32_t, std::string> customCommodityNames;
 /// remove some escaped characters from a string mainly the escape character and (){}[]
 static void removeEscapeSequences(std::string& str)
 {
@@ -313,18 +535,69 @@ static void removeEscapeSequences(std::string& str)
         eloc = str.find_first_of('\\', eloc + 1);
     }
 }
+// store a custom commodity, the name must already be lower case
+static void addCustomCommodity(
+    detail::commodityContextData& data,
+    const std::string& comm,
+    uint32_t code)
+{
+    if (data.allowCustomCommodities.load()) {
+        std::lock_guard<std::mutex> lock(data.writeLock);
+        auto registry = copyCommodities(data);
+        registry->names.emplace(code, comm);
+        registry->codes.emplace(comm, code);
+        publishCommodities(data, std::move(registry));
+    }
+}
+
+// store the name of an unrecognized commodity string so the name can be found from the code
+static void registerCommodityName(
+    detail::commodityContextData& data,
+    const commodityRegistry* registry,
+    const std::string& comm,
+    uint32_t code)
+{
+    if (!data.allowCustomCommodities.load()) {
+        return;
+    }
+    if (registry != nullptr && registry->table) {
+        registry->table->insert(comm, code);
+        return;
+    }
+    if (data.nameCapacity.load() == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(data.writeLock);
+    auto current = std::atomic_load(&data.registry);
+    if (current && current->table) {
+        current->table->insert(comm, code);
+        return;
+    }
+    auto capacity = data.nameCapacity.load();
+    if (capacity == 0) {
+        return;
+    }
+    auto updated = copyCommodities(data);
+    updated->table = std::make_shared<commodityNameTable>(capacity);
+    updated->table->insert(comm, code);
+    publishCommodities(data, std::move(updated));
+}
+
 // get the code to use for a particular commodity
 uint32_t getCommodity(std::string comm)
 {
+    const auto* ctx = context::current();
+    auto& data = (ctx != nullptr) ? *ctx->commodityData : globalCommodityData;
     removeEscapeSequences(comm);
     std::transform(comm.begin(), comm.end(), comm.begin(), ::tolower);
     auto fnd = commodities::commodity_codes.find(comm);
     if (fnd != commodities::commodity_codes.end()) {
         return fnd->second;
     }
-    if (!customCommodityCodes.empty()) {
-        auto fnd2 = customCommodityCodes.find(comm);
-        if (fnd2 != customCommodityCodes.end()) {
+    const auto* registry = commodityRegistryFor(data);
+    if (registry != nullptr) {
+        auto fnd2 = registry->codes.find(comm);
+        if (fnd2 != registry->codes.end()) {
             return fnd2->second;
         }
     }
@@ -350,7 +623,8 @@ uint32_t getCommodity(std::string comm)
     auto hcode = stringHash(comm);
     hcode &= 0x1FFFFFFF;
     hcode |= 0x60000000;
-    addCustomCommodity(comm, hcode);
+    // the string would always generate the same code, so the unit string cache is still valid
+    registerCommodityName(data, registry, comm, hcode);
 
     return hcode;
 }
@@ -358,15 +632,22 @@ uint32_t getCommodity(std::string comm)
 // get the code to use for a particular commodity
 std::string getCommodityName(uint32_t commodity)
 {
+    const auto* ctx = context::current();
+    auto& data = (ctx != nullptr) ? *ctx->commodityData : globalCommodityData;
     auto fnd = commodities::commodity_names.find(commodity);
     if (fnd != commodities::commodity_names.end()) {
         return fnd->second;
     }
-    if (!customCommodityNames.empty()) {
-        auto fnd2 = customCommodityNames.find(commodity);
-        if (fnd2 != customCommodityNames.end()) {
+    const auto* registry = commodityRegistryFor(data);
+    if (registry != nullptr) {
+        auto fnd2 = registry->names.find(commodity);
+        if (fnd2 != registry->names.end()) {
             return fnd2->second;
         }
+        std::string name;
+        if (registry->table && registry->table->find(commodity, name)) {
+            return name;
+        }
     }
     if ((commodity & 0x60000000) == 0x40000000) {
         std::string ret;
@@ -383,19 +664,107 @@ std::string getCommodityName(uint32_t commodity)
     return std::string("CXCOMM[") + std::to_string(commodity) + "]";
 }
 
+static void clearCustomCommodities(detail::commodityContextData& data)
+{
+    std::lock_guard<std::mutex> lock(data.writeLock);
+    publishCommodities(data, nullptr);
+}
+
+static void setCommodityNameCapacity(detail::commodityContextData& data, size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(data.writeLock);
+    data.nameCapacity.store(capacity);
+    auto registry = copyCommodities(data);
+    registry->table.reset();
+    publishCommodities(data, std::move(registry));
+}
+
+static commodity_statistics getCommodityStatistics(detail::commodityContextData& data)
+{
+    commodity_statistics stats;
+    auto registry = std::atomic_load(&data.registry);
+    stats.capacity = data.nameCapacity.load();
+    if (registry) {
+        stats.custom = registry->codes.size();
+        stats.memory = sizeof(commodityRegistry);
+        for (const auto& code : registry->codes) {
+            // the strings and nodes of both maps
+            stats.memory += 2 * (code.first.capacity() + 4 * sizeof(void*));
+        }
+        if (registry->table) {
+            registry->table->addStatistics(stats);
+        }
+    }
+    return stats;
+}
+
 // add a custom commodity for later retrieval
 void addCustomCommodity(std::string comm, uint32_t code)
 {
-    if (allowCustomCommodities.load()) {
+    if (globalCommodityData.allowCustomCommodities.load()) {
         std::transform(comm.begin(), comm.end(), comm.begin(), ::tolower);
-        customCommodityNames.emplace(code, comm);
-        customCommodityCodes.emplace(comm, code);
+        addCustomCommodity(globalCommodityData, comm, code);
+        clearUnitStringCache();
+        clearUnitFormatCache();
     }
 }
 
 void clearCustomCommodities()
 {
-    customCommodityNames.clear();
-    customCommodityCodes.clear();
+    clearCustomCommodities(globalCommodityData);
+    clearUnitStringCache();
+    clearUnitFormatCache();
+}
+
+void setCommodityNameCapacity(size_t capacity)
+{
+    setCommodityNameCapacity(globalCommodityData, capacity);
+}
+
+commodity_statistics getCommodityStatistics()
+{
+    return getCommodityStatistics(globalCommodityData);
+}
+
+std::shared_ptr<detail::commodityContextData> context::newCommodityData()
+{
+    return std::make_shared<detail::commodityContextData>();
+}
+
+void context::addCustomCommodity(std::string comm, uint32_t code)
+{
+    if (commodityData->allowCustomCommodities.load()) {
+        std::transform(comm.begin(), comm.end(), comm.begin(), ::tolower);
+        units::addCustomCommodity(*commodityData, comm, code);
+        clearUnitStringCache();
+        clearUnitFormatCache();
+    }
+}
+
+void context::clearCustomCommodities()
+{
+    units::clearCustomCommodities(*commodityData);
+    clearUnitStringCache();
+    clearUnitFormatCache();
+}
+
+void context::disableCustomCommodities()
+{
+    commodityData->allowCustomCommodities.store(false);
+}
+
+void context::enableCustomCommodities()
+{
+    commodityData->allowCustomCommodities.store(true);
+}
+
+void context::setCommodityNameCapacity(size_t capacity)
+{
+    units::setCommodityNameCapacity(*commodityData, capacity);
+}
+
+commodity_statistics context::getCommodityStatistics() const
+{
+    return units::getCommodityStatistics(*commodityData);
 }
 } // namespace units
@@ -0,0 +1,288 @@
+/*
+Copyright (c) 2019,
+Lawrence Livermore National Security, LLC;
+See the top-level NOTICE for additional details. All rights reserved.
+SPDX-License-Identifier: BSD-3-Clause
+*/
+#include "units.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace units {
+/// the packed start and result units of a conversion
+struct conversionKey {
+    uint64_t words[4];
+    bool operator==(const conversionKey& other) const
+    {
+        return words[0] == other.words[0] && words[1] == other.words[1] &&
+            words[2] == other.words[2] && words[3] == other.words[3];
+    }
+};
+
+static void packUnit(precise_unit un, uint64_t* words)
+{
+    auto base = un.base_units();
+    auto mult = un.multiplier();
+    uint32_t baseBits;
+    std::memcpy(&baseBits, &base, sizeof(baseBits));
+    words[0] = (static_cast<uint64_t>(baseBits) << 32U) | un.commodity();
+    std::memcpy(&words[1], &mult, sizeof(words[1]));
+}
+
+static conversionKey makeKey(precise_unit start, precise_unit result)
+{
+    conversionKey key;
+    packUnit(start, key.words);
+    packUnit(result, key.words + 2);
+    return key;
+}
+
+static uint64_t hashKey(const conversionKey& key)
+{
+    uint64_t hash = key.words[0] ^ (key.words[1] * 0x9e3779b97f4a7c15ULL) ^
+        (key.words[2] * 0xc2b2ae3d27d4eb4fULL) ^ (key.words[3] * 0x165667b19e3779f9ULL);
+    hash ^= hash >> 29U;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 32U;
+    return hash;
+}
+
+static_assert(
+    std::is_trivially_copyable<unit_converter>::value,
+    "the conversion cache copies unit_converter objects as words");
+
+/** a fixed size open addressed table of converters
+@details each slot is guarded by a sequence number which is odd while the slot is written.  Readers copy a slot
+and check the sequence did not change, writers take a slot by moving the sequence from even to odd so no
+thread ever blocks.  Every field is an atomic word so a reader racing a writer only sees a changed sequence
+and treats the lookup as a miss*/
+class conversionTable {
+  public:
+    explicit conversionTable(size_t capacity) :
+        mask(slotCount(capacity) - 1), slots(new slot[slotCount(capacity)])
+    {
+    }
+    /// the number of slots used for a capacity, a power of 2
+    static size_t slotCount(size_t capacity)
+    {
+        size_t size{16};
+        while (size < capacity) {
+            size *= 2;
+        }
+        return size;
+    }
+    bool find(const conversionKey& key, uint64_t hash, unit_converter& conv) const
+    {
+        for (size_t probe = 0; probe < maxProbe; ++probe) {
+            const slot& current = slots[(hash + probe) & mask];
+            uint64_t sequence = current.sequence.load(std::memory_order_acquire);
+            if ((sequence & 1U) != 0) {
+                continue;
+            }
+            bool occupied = current.occupied.load(std::memory_order_relaxed) != 0;
+            conversionKey stored;
+            for (size_t ii = 0; ii < 4; ++ii) {
+                stored.words[ii] = current.key[ii].load(std::memory_order_relaxed);
+            }
+            uint64_t value[valueWords];
+            for (size_t ii = 0; ii < valueWords; ++ii) {
+                value[ii] = current.value[ii].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (current.sequence.load(std::memory_order_relaxed) != sequence) {
+                continue;
+            }
+            if (!occupied) {
+                // the probe sequence ends at the first empty slot
+                return false;
+            }
+            if (stored == key) {
+                std::memcpy(&conv, value, sizeof(unit_converter));
+                return true;
+            }
+        }
+        return false;
+    }
+    void insert(const conversionKey& key, uint64_t hash, const unit_converter& conv)
+    {
+        uint64_t value[valueWords]{};
+        std::memcpy(value, &conv, sizeof(unit_converter));
+        for (size_t probe = 0; probe < maxProbe; ++probe) {
+            slot& current = slots[(hash + probe) & mask];
+            if (current.occupied.load(std::memory_order_relaxed) != 0) {
+                continue;
+            }
+            uint64_t sequence = 0;
+            if (!lock(current, sequence)) {
+                continue;
+            }
+            if (current.occupied.load(std::memory_order_relaxed) != 0) {
+                // another thread filled the slot first
+                current.sequence.store(sequence + 2, std::memory_order_release);
+                continue;
+            }
+            write(current, key, value);
+            current.sequence.store(sequence + 2, std::memory_order_release);
+            count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // the probe window is full so the first slot is replaced
+        slot& home = slots[hash & mask];
+        uint64_t sequence = 0;
+        if (lock(home, sequence)) {
+            write(home, key, value);
+            home.sequence.store(sequence + 2, std::memory_order_release);
+            evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    void clear()
+    {
+        for (size_t ii = 0; ii <= mask; ++ii) {
+            slot& current = slots[ii];
+            uint64_t sequence = 0;
+            while (!lock(current, sequence)) {
+            }
+            if (current.occupied.load(std::memory_order_relaxed) != 0) {
+                current.occupied.store(0, std::memory_order_relaxed);
+                count.fetch_sub(1, std::memory_order_relaxed);
+            }
+            current.sequence.store(sequence + 2, std::memory_order_release);
+        }
+    }
+    void resetStatistics()
+    {
+        hits.store(0, std::memory_order_relaxed);
+        misses.store(0, std::memory_order_relaxed);
+        evictions.store(0, std::memory_order_relaxed);
+    }
+    size_t capacity() const { return mask + 1; }
+
+    mutable std::atomic<uint64_t> hits{0};
+    mutable std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> evictions{0};
+    std::atomic<size_t> count{0};
+
+  private:
+    static constexpr size_t maxProbe{8};
+    static constexpr size_t valueWords{(sizeof(unit_converter) + 7) / 8};
+    struct slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<uint64_t> occupied{0};
+        std::atomic<uint64_t> key[4];
+        std::atomic<uint64_t> value[valueWords];
+    };
+    /// move the sequence of a slot from even to odd
+    static bool lock(slot& current, uint64_t& sequence)
+    {
+        sequence = current.sequence.load(std::memory_order_relaxed);
+        return (sequence & 1U) == 0 &&
+            current.sequence.compare_exchange_strong(
+                sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+    static void write(slot& current, const conversionKey& key, const uint64_t* value)
+    {
+        // the writes must not move ahead of taking the slot
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t ii = 0; ii < 4; ++ii) {
+            current.key[ii].store(key.words[ii], std::memory_order_relaxed);
+        }
+        for (size_t ii = 0; ii < valueWords; ++ii) {
+            current.value[ii].store(value[ii], std::memory_order_relaxed);
+        }
+        current.occupied.store(1, std::memory_order_relaxed);
+    }
+
+    size_t mask;
+    std::unique_ptr<slot[]> slots;
+};
+
+constexpr size_t conversionTable::maxProbe;
+constexpr size_t conversionTable::valueWords;
+
+static std::atomic<conversionTable*> activeConversionTable{nullptr};
+static std::mutex conversionTableLock;
+/** tables are never freed while the program runs since a reader may still hold one after the cache is
+disabled, a table of the same capacity is reused when the cache is enabled again*/
+static std::vector<std::unique_ptr<conversionTable>> conversionTables;
+
+void enableConversionCache(size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(conversionTableLock);
+    conversionTable* table{nullptr};
+    for (auto& existing : conversionTables) {
+        if (existing->capacity() == conversionTable::slotCount(capacity)) {
+            table = existing.get();
+        }
+    }
+    if (table == nullptr) {
+        conversionTables.emplace_back(new conversionTable(capacity));
+        table = conversionTables.back().get();
+    } else {
+        table->clear();
+    }
+    table->resetStatistics();
+    activeConversionTable.store(table, std::memory_order_release);
+}
+
+void disableConversionCache()
+{
+    std::lock_guard<std::mutex> lock(conversionTableLock);
+    auto* table = activeConversionTable.exchange(nullptr);
+    if (table != nullptr) {
+        table->clear();
+    }
+}
+
+void clearConversionCache()
+{
+    auto* table = activeConversionTable.load(std::memory_order_acquire);
+    if (table != nullptr) {
+        table->clear();
+    }
+}
+
+cache_statistics getConversionCacheStatistics()
+{
+    cache_statistics stats;
+    auto* table = activeConversionTable.load(std::memory_order_acquire);
+    if (table != nullptr) {
+        stats.hits = table->hits.load(std::memory_order_relaxed);
+        stats.misses = table->misses.load(std::memory_order_relaxed);
+        stats.evictions = table->evictions.load(std::memory_order_relaxed);
+        stats.size = table->count.load(std::memory_order_relaxed);
+        stats.capacity = table->capacity();
+    }
+    return stats;
+}
+
+unit_converter cached_converter(precise_unit start, precise_unit result)
+{
+    auto* table = activeConversionTable.load(std::memory_order_acquire);
+    if (table == nullptr) {
+        return unit_converter(start, result);
+    }
+    auto key = makeKey(start, result);
+    auto hash = hashKey(key);
+    unit_converter conv;
+    if (table->find(key, hash, conv)) {
+        table->hits.fetch_add(1, std::memory_order_relaxed);
+        return conv;
+    }
+    table->misses.fetch_add(1, std::memory_order_relaxed);
+    conv = unit_converter(start, result);
+    table->insert(key, hash, conv);
+    return conv;
+}
+
+double cached_convert(double val, precise_unit start, precise_unit result)
+{
+    return cached_converter(start, result).convert(val);
+}
+
+}  // namespace units
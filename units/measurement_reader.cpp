@@ -0,0 +1,654 @@
+/*
+Copyright (c) 2019,
+Lawrence Livermore National Security, LLC;
+See the top-level NOTICE for additional details. All rights reserved.
+SPDX-License-Identifier: BSD-3-Clause
+*/
+#include "measurement_reader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace units {
+/// the powers of 10 which are exactly representable as a double
+static const std::array<double, 23> exactPowersOf10{{1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                                      1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                                      1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                                      1e18, 1e19, 1e20, 1e21, 1e22}};
+
+static inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/** convert a plain decimal number at the start of some text without using a locale
+@details the conversion only succeeds if the number has at most 15 significant digits and a power of 10 of
+at most 22 in magnitude,  so a single multiplication or division produces the correctly rounded value
+@param start the start of the text
+@param end the end of the text
+@param value the converted number
+@param next set to the first character after the number
+@return false if the text does not start with a number which can be converted exactly
+*/
+static bool fastNumber(const char* start, const char* end, double& value, const char*& next)
+{
+    const char* pos = start;
+    bool negative{false};
+    if (pos < end && (*pos == '-' || *pos == '+')) {
+        negative = (*pos == '-');
+        ++pos;
+    }
+    uint64_t mantissa{0};
+    int significant{0};
+    int exponent{0};
+    bool digits{false};
+    for (; pos < end && isDigit(*pos); ++pos) {
+        if (mantissa != 0 || *pos != '0') {
+            ++significant;
+        }
+        mantissa = mantissa * 10 + static_cast<uint64_t>(*pos - '0');
+        digits = true;
+    }
+    if (pos < end && *pos == '.') {
+        for (++pos; pos < end && isDigit(*pos); ++pos) {
+            if (mantissa != 0 || *pos != '0') {
+                ++significant;
+            }
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*pos - '0');
+            --exponent;
+            digits = true;
+        }
+    }
+    if (!digits || significant > 15) {
+        return false;
+    }
+    if (pos < end && (*pos == 'e' || *pos == 'E')) {
+        const char* epos = pos + 1;
+        bool eneg{false};
+        if (epos < end && (*epos == '-' || *epos == '+')) {
+            eneg = (*epos == '-');
+            ++epos;
+        }
+        if (epos < end && isDigit(*epos)) {
+            int evalue{0};
+            for (; epos < end && isDigit(*epos); ++epos) {
+                if (evalue > 1000) {
+                    return false;
+                }
+                evalue = evalue * 10 + (*epos - '0');
+            }
+            exponent += (eneg) ? -evalue : evalue;
+            pos = epos;
+        }
+    }
+    if (mantissa == 0) {
+        value = (negative) ? -0.0 : 0.0;
+    } else if (exponent < -22 || exponent > 22) {
+        return false;
+    } else {
+        auto mvalue = static_cast<double>(mantissa);
+        value = (exponent < 0) ? mvalue / exactPowersOf10[static_cast<size_t>(-exponent)] :
+                                 mvalue * exactPowersOf10[static_cast<size_t>(exponent)];
+        if (negative) {
+            value = -value;
+        }
+    }
+    next = pos;
+    return true;
+}
+
+namespace {
+    /// a section of the text of a row
+    struct cell {
+        const char* begin{nullptr};
+        const char* end{nullptr};
+        bool escaped{false}; //!< the cell contains doubled quotes
+        bool found{false};
+    };
+
+    /// key for the units of a section of text without copying it
+    struct textKey {
+        const char* data;
+        size_t length;
+        bool operator==(const textKey& other) const
+        {
+            return length == other.length && std::memcmp(data, other.data, length) == 0;
+        }
+    };
+
+    struct textKeyHash {
+        size_t operator()(const textKey& key) const
+        {
+            // FNV-1a
+            uint64_t hash{14695981039346656037ULL};
+            for (size_t ii = 0; ii < key.length; ++ii) {
+                hash ^= static_cast<unsigned char>(key.data[ii]);
+                hash *= 1099511628211ULL;
+            }
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    /** the units of the unit strings converted by one thread
+    @details the keys point into the text being read so the cache is only valid during a single read*/
+    class unitTextCache {
+      public:
+        explicit unitTextCache(uint32_t flags) : match_flags(flags) {}
+        precise_unit get(const char* begin, const char* end)
+        {
+            textKey key{begin, static_cast<size_t>(end - begin)};
+            auto fnd = units.find(key);
+            if (fnd != units.end()) {
+                return fnd->second;
+            }
+            auto unit = unit_from_string(std::string(begin, end), match_flags);
+            if (units.size() >= maxEntries) {
+                units.clear();
+            }
+            units.emplace(key, unit);
+            return unit;
+        }
+
+      private:
+        static constexpr size_t maxEntries{1U << 16U};
+        std::unordered_map<textKey, precise_unit, textKeyHash> units;
+        uint32_t match_flags;
+    };
+} // namespace
+
+static inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+// remove the spaces at the ends of a cell
+static void trimCell(cell& text)
+{
+    while (text.begin < text.end && isSpace(*text.begin)) {
+        ++text.begin;
+    }
+    while (text.end > text.begin && isSpace(*(text.end - 1))) {
+        --text.end;
+    }
+}
+
+/** split a row into cells and store the ones in the requested columns
+@param begin the start of the row
+@param end the end of the row
+@param delimiter the character separating the cells
+@param columns the column of each requested cell
+@param cells the cells of the requested columns
+*/
+static void splitRow(
+    const char* begin,
+    const char* end,
+    char delimiter,
+    const std::array<int, 2>& columns,
+    std::array<cell, 2>& cells)
+{
+    int lastColumn = (std::max)(columns[0], columns[1]);
+    const char* pos = begin;
+    bool more{true};
+    for (int column = 0; column <= lastColumn && more; ++column) {
+        cell current;
+        while (pos < end && isSpace(*pos)) {
+            ++pos;
+        }
+        if (pos < end && *pos == '"') {
+            current.begin = ++pos;
+            while (pos < end) {
+                if (*pos == '"') {
+                    if (pos + 1 < end && *(pos + 1) == '"') {
+                        current.escaped = true;
+                        pos += 2;
+                        continue;
+                    }
+                    break;
+                }
+                ++pos;
+            }
+            current.end = pos;
+            pos = std::find(pos, end, delimiter);
+        } else {
+            current.begin = pos;
+            pos = std::find(pos, end, delimiter);
+            current.end = pos;
+        }
+        current.found = true;
+        trimCell(current);
+        for (size_t ii = 0; ii < columns.size(); ++ii) {
+            if (columns[ii] == column) {
+                cells[ii] = current;
+            }
+        }
+        more = (pos < end);
+        if (more) {
+            ++pos;
+        }
+    }
+}
+
+// get the text of a cell with the doubled quotes replaced
+static std::string cellString(const cell& text)
+{
+    std::string str(text.begin, text.end);
+    if (text.escaped) {
+        auto loc = str.find("\"\"");
+        while (loc != std::string::npos) {
+            str.erase(loc, 1);
+            loc = str.find("\"\"", loc + 1);
+        }
+    }
+    return str;
+}
+
+// get the number in a cell
+static double cellValue(const cell& text, uint32_t match_flags)
+{
+    if (!text.found || text.begin == text.end) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    double value;
+    const char* next;
+    if (!text.escaped && fastNumber(text.begin, text.end, value, next) && next == text.end) {
+        return value;
+    }
+    auto measure = measurement_from_string(cellString(text), match_flags);
+    return (is_valid(measure.units())) ? measure.value() :
+                                         std::numeric_limits<double>::quiet_NaN();
+}
+
+// get the unit in a cell
+static precise_unit cellUnit(const cell& text, unitTextCache& cache, uint32_t match_flags)
+{
+    if (!text.found) {
+        return precise::invalid;
+    }
+    if (text.begin == text.end) {
+        return precise::one;
+    }
+    if (text.escaped) {
+        return unit_from_string(cellString(text), match_flags);
+    }
+    return cache.get(text.begin, text.end);
+}
+
+// check if the text after a number could change the interpretation of the number
+static bool ambiguousUnitStart(char c)
+{
+    switch (c) {
+        case '.':
+        case '+':
+        case '-':
+        case '*':
+        case '/':
+        case '^':
+        case '(':
+        case 'e':
+        case 'E':
+        case 'x':
+        case 'X':
+            return true;
+        default:
+            return isDigit(c);
+    }
+}
+
+// get the measurement in a cell with a value and a unit
+static precision_measurement
+    cellMeasurement(const cell& text, unitTextCache& cache, uint32_t match_flags)
+{
+    if (!text.found || text.begin == text.end) {
+        return {std::numeric_limits<double>::quiet_NaN(), precise::invalid};
+    }
+    double value;
+    const char* next;
+    if (!text.escaped && fastNumber(text.begin, text.end, value, next)) {
+        while (next < text.end && isSpace(*next)) {
+            ++next;
+        }
+        if (next == text.end) {
+            return {value, precise::one};
+        }
+        if (!ambiguousUnitStart(*next)) {
+            return {value, cache.get(next, text.end)};
+        }
+    }
+    return measurement_from_string(cellString(text), match_flags);
+}
+
+/// convert the rows of a chunk of text
+static void convertChunk(
+    const char* begin,
+    const char* end,
+    const measurement_reader_options& options,
+    unitTextCache& cache,
+    std::vector<precision_measurement>& measurements)
+{
+    bool separate = (options.value_column >= 0);
+    std::array<int, 2> columns{
+        {separate ? options.value_column : options.measurement_column,
+         separate ? options.unit_column : -1}};
+    while (begin < end) {
+        auto rowEnd = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+        if (rowEnd == nullptr) {
+            rowEnd = end;
+        }
+        auto textEnd = rowEnd;
+        if (textEnd > begin && *(textEnd - 1) == '\r') {
+            --textEnd;
+        }
+        const char* pos = begin;
+        while (pos < textEnd && isSpace(*pos)) {
+            ++pos;
+        }
+        if (pos < textEnd) {
+            std::array<cell, 2> cells;
+            splitRow(begin, textEnd, options.delimiter, columns, cells);
+            if (!separate) {
+                measurements.push_back(cellMeasurement(cells[0], cache, options.match_flags));
+            } else if (options.unit_column < 0) {
+                measurements.emplace_back(cellValue(cells[0], options.match_flags), precise::one);
+            } else {
+                measurements.emplace_back(
+                    cellValue(cells[0], options.match_flags),
+                    cellUnit(cells[1], cache, options.match_flags));
+            }
+        }
+        begin = rowEnd + 1;
+    }
+}
+
+size_t read_measurements(
+    const char* text,
+    size_t length,
+    const measurement_reader_options& options,
+    const measurement_chunk_handler& handler)
+{
+    const char* end = text + length;
+    const char* pos = text;
+    for (size_t ii = 0; ii < options.header_rows && pos < end; ++ii) {
+        auto rowEnd = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+        pos = (rowEnd == nullptr) ? end : rowEnd + 1;
+    }
+    // split the text into chunks at row boundaries
+    auto chunkBytes = (std::max)(options.chunk_bytes, size_t{1});
+    std::vector<std::pair<const char*, const char*>> chunks;
+    while (pos < end) {
+        const char* chunkEnd = end;
+        if (static_cast<size_t>(end - pos) > chunkBytes) {
+            auto rowEnd = static_cast<const char*>(
+                std::memchr(pos + chunkBytes, '\n', end - pos - chunkBytes));
+            chunkEnd = (rowEnd == nullptr) ? end : rowEnd + 1;
+        }
+        chunks.emplace_back(pos, chunkEnd);
+        pos = chunkEnd;
+    }
+
+    size_t threadCount =
+        (options.threads == 0) ? std::thread::hardware_concurrency() : options.threads;
+    if (threadCount > chunks.size()) {
+        threadCount = chunks.size();
+    }
+    size_t rows{0};
+    if (threadCount <= 1) {
+        unitTextCache cache(options.match_flags);
+        std::vector<precision_measurement> measurements;
+        for (const auto& chunk : chunks) {
+            measurements.clear();
+            convertChunk(chunk.first, chunk.second, options, cache, measurements);
+            handler(rows, measurements);
+            rows += measurements.size();
+        }
+        return rows;
+    }
+
+    // the workers stay a limited number of chunks ahead of the handler to bound the memory in use
+    const size_t window = threadCount * 2;
+    std::vector<std::vector<precision_measurement>> results(chunks.size());
+    std::vector<char> complete(chunks.size(), 0);
+    std::mutex lock;
+    std::condition_variable update;
+    size_t nextChunk{0};
+    size_t handled{0};
+    // set when the handler or a worker throws so every thread stops at its next chunk
+    bool stop{false};
+    std::exception_ptr workerError;
+
+    auto worker = [&]() {
+        unitTextCache cache(options.match_flags);
+        while (true) {
+            size_t index;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                update.wait(guard, [&]() {
+                    return stop || nextChunk >= chunks.size() || nextChunk < handled + window;
+                });
+                if (stop || nextChunk >= chunks.size()) {
+                    return;
+                }
+                index = nextChunk++;
+            }
+            std::vector<precision_measurement> measurements;
+            try {
+                convertChunk(
+                    chunks[index].first, chunks[index].second, options, cache, measurements);
+            }
+            catch (...) {
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    if (!workerError) {
+                        workerError = std::current_exception();
+                    }
+                    stop = true;
+                }
+                update.notify_all();
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                results[index] = std::move(measurements);
+                complete[index] = 1;
+            }
+            update.notify_all();
+        }
+    };
+    // the conversions on the other threads use the context of the calling thread
+    const auto* ctx = context::current();
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+    std::exception_ptr handlerError;
+    try {
+        for (size_t ii = 0; ii < threadCount; ++ii) {
+            workers.emplace_back([&worker, ctx]() {
+                if (ctx != nullptr) {
+                    context::scope active(*ctx);
+                    worker();
+                } else {
+                    worker();
+                }
+            });
+        }
+        for (size_t ii = 0; ii < chunks.size(); ++ii) {
+            std::vector<precision_measurement> measurements;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                update.wait(guard, [&]() { return stop || complete[ii] != 0; });
+                if (stop) {
+                    break;
+                }
+                measurements.swap(results[ii]);
+            }
+            handler(rows, measurements);
+            rows += measurements.size();
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                ++handled;
+            }
+            update.notify_all();
+        }
+    }
+    catch (...) {
+        handlerError = std::current_exception();
+    }
+    // the workers must be joined before anything is rethrown
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stop = true;
+    }
+    update.notify_all();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    if (handlerError) {
+        std::rethrow_exception(handlerError);
+    }
+    if (workerError) {
+        std::rethrow_exception(workerError);
+    }
+    return rows;
+}
+
+namespace {
+    /// a read only memory map of a file
+    class mappedFile {
+      public:
+        explicit mappedFile(const std::string& file_name)
+        {
+#ifdef _WIN32
+            file = CreateFileA(
+                file_name.c_str(),
+                GENERIC_READ,
+                FILE_SHARE_READ,
+                nullptr,
+                OPEN_EXISTING,
+                FILE_FLAG_SEQUENTIAL_SCAN,
+                nullptr);
+            if (file == INVALID_HANDLE_VALUE) {
+                return;
+            }
+            LARGE_INTEGER size;
+            if (GetFileSizeEx(file, &size) == 0) {
+                return;
+            }
+            length = static_cast<size_t>(size.QuadPart);
+            valid = true;
+            if (length == 0) {
+                return;
+            }
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping == nullptr) {
+                valid = false;
+                return;
+            }
+            data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            valid = (data != nullptr);
+#else
+            descriptor = open(file_name.c_str(), O_RDONLY);
+            if (descriptor < 0) {
+                return;
+            }
+            struct stat info;
+            if (fstat(descriptor, &info) != 0) {
+                return;
+            }
+            length = static_cast<size_t>(info.st_size);
+            valid = true;
+            if (length == 0) {
+                return;
+            }
+            void* map = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (map == MAP_FAILED) {
+                valid = false;
+                return;
+            }
+            data = static_cast<const char*>(map);
+            // the file is read from start to end
+            madvise(map, length, MADV_SEQUENTIAL);
+#endif
+        }
+        ~mappedFile()
+        {
+#ifdef _WIN32
+            if (data != nullptr) {
+                UnmapViewOfFile(data);
+            }
+            if (mapping != nullptr) {
+                CloseHandle(mapping);
+            }
+            if (file != INVALID_HANDLE_VALUE) {
+                CloseHandle(file);
+            }
+#else
+            if (data != nullptr) {
+                munmap(const_cast<char*>(data), length);
+            }
+            if (descriptor >= 0) {
+                close(descriptor);
+            }
+#endif
+        }
+        mappedFile(const mappedFile&) = delete;
+        mappedFile& operator=(const mappedFile&) = delete;
+
+        const char* data{nullptr};
+        size_t length{0};
+        bool valid{false};
+
+      private:
+#ifdef _WIN32
+        HANDLE file{INVALID_HANDLE_VALUE};
+        HANDLE mapping{nullptr};
+#else
+        int descriptor{-1};
+#endif
+    };
+} // namespace
+
+bool read_measurement_file(
+    const std::string& file_name,
+    const measurement_reader_options& options,
+    const measurement_chunk_handler& handler)
+{
+    size_t bytes{0};
+    return read_measurement_file(file_name, options, handler, bytes);
+}
+
+bool read_measurement_file(
+    const std::string& file_name,
+    const measurement_reader_options& options,
+    const measurement_chunk_handler& handler,
+    size_t& bytes)
+{
+    bytes = 0;
+    mappedFile file(file_name);
+    if (!file.valid) {
+        return false;
+    }
+    bytes = file.length;
+    read_measurements(file.data, file.length, options, handler);
+    return true;
+}
+} // namespace units
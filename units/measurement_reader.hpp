@@ -0,0 +1,77 @@
+/*
+Copyright (c) 2019,
+Lawrence Livermore National Security, LLC;
+See the top-level NOTICE for additional details. All rights reserved.
+SPDX-License-Identifier: BSD-3-Clause
+*/
+#pragma once
+#include "units.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace units {
+/// the layout of the measurements in delimited text
+struct measurement_reader_options {
+    char delimiter{','}; //!< the character separating the cells of a row
+    /// the column of cells with a value and a unit such as "12.5 kg",  used if value_column is negative
+    int measurement_column{0};
+    int value_column{-1}; //!< the column of the values
+    int unit_column{-1}; //!< the column of the unit strings,  negative if the values have no units
+    size_t header_rows{0}; //!< the number of rows to skip at the start of the text
+    size_t chunk_bytes{size_t{1} << 22U}; //!< the approximate size of the text converted as one chunk
+    size_t threads{0}; //!< the number of threads converting chunks,  0 for the hardware concurrency
+    uint32_t match_flags{0}; //!< see /ref unit_conversion_flags
+};
+
+/** handler for the measurements of a chunk of rows
+@param first_row the index of the first row of the chunk,  not counting the header rows
+@param measurements the measurements of the rows of the chunk in order
+*/
+using measurement_chunk_handler = std::function<
+    void(size_t first_row, const std::vector<precision_measurement>& measurements)>;
+
+/** Extract the measurements from a block of delimited text
+@details rows are separated by '\n' or "\r\n" and blank rows are skipped.  Cells can be quoted with '"' but a
+quoted cell can't contain a row break.  The text is split into chunks at row boundaries which are converted on
+multiple threads, the handler is called on the calling thread with the chunks in order.  Plain decimal numbers
+are converted without a locale and each distinct unit string is converted once per thread,  anything else
+goes through measurement_from_string.  A row without the needed columns produces an invalid measurement.  An
+exception thrown by the handler or while converting a chunk stops the other threads and is rethrown once they
+have finished
+@param text the start of the text
+@param length the number of characters in the text
+@param options the layout of the text
+@param handler called with the measurements of each chunk
+@return the number of rows converted
+*/
+size_t read_measurements(
+    const char* text,
+    size_t length,
+    const measurement_reader_options& options,
+    const measurement_chunk_handler& handler);
+
+/** Extract the measurements from a file of delimited text
+@details the file is memory mapped and converted in the same way as read_measurements
+@param file_name the name of the file to read
+@param options the layout of the file
+@param handler called with the measurements of each chunk
+@return false if the file could not be read
+*/
+bool read_measurement_file(
+    const std::string& file_name,
+    const measurement_reader_options& options,
+    const measurement_chunk_handler& handler);
+
+/** Extract the measurements from a file of delimited text and get the size of the file
+@param bytes set to the number of bytes in the file that was read,  0 if the file could not be read
+@return false if the file could not be read
+*/
+bool read_measurement_file(
+    const std::string& file_name,
+    const measurement_reader_options& options,
+    const measurement_chunk_handler& handler,
+    size_t& bytes);
+} // namespace units
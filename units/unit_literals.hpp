@@ -0,0 +1,313 @@
+/*
+Copyright (c) 2019,
+Lawrence Livermore National Security, LLC;
+See the top-level NOTICE for additional details. All rights reserved.
+SPDX-License-Identifier: BSD-3-Clause
+*/
+#pragma once
+#include "unit_definitions.hpp"
+
+#include <cstddef>
+
+namespace units {
+namespace detail {
+    /** compile time parser of unit strings in the strict UCUM syntax
+    @details the supported subset is the metric and time units of UCUM with SI prefixes, '.' for
+    multiplication, '/' for division, integer exponents following a unit, integer factors, and
+    parenthesis.  The functions are limited to the C++11 constexpr rules so each one is a single
+    expression and loops are written as recursion
+    */
+    namespace ucum_literal {
+        /// a unit symbol and if it takes SI prefixes
+        struct atom {
+            const char* symbol;
+            precise_unit unit;
+            bool metric;
+        };
+
+        constexpr atom atoms[] = {
+            {"m", precise::m, true},
+            {"s", precise::s, true},
+            {"g", precise::g, true},
+            {"rad", precise::rad, true},
+            {"K", precise::K, true},
+            {"C", precise::C, true},
+            {"cd", precise::cd, true},
+            {"mol", precise::mol, true},
+            {"A", precise::A, true},
+            {"sr", precise::sr, true},
+            {"Hz", precise::Hz, true},
+            {"N", precise::N, true},
+            {"Pa", precise::Pa, true},
+            {"J", precise::J, true},
+            {"W", precise::W, true},
+            {"V", precise::V, true},
+            {"F", precise::F, true},
+            {"Ohm", precise::ohm, true},
+            {"S", precise::S, true},
+            {"Wb", precise::Wb, true},
+            {"T", precise::T, true},
+            {"H", precise::H, true},
+            {"lm", precise::lm, true},
+            {"lx", precise::lx, true},
+            {"Bq", precise::Bq, true},
+            {"Gy", precise::Gy, true},
+            {"Sv", precise::Sv, true},
+            {"kat", precise::kat, true},
+            {"L", precise::L, true},
+            {"l", precise::L, true},
+            {"ar", precise::area::are, true},
+            {"t", precise::tonne, true},
+            {"bar", precise::bar, true},
+            {"u", precise::u, true},
+            {"eV", precise::energy::eV, true},
+            {"bit", precise::bit, true},
+            {"By", precise::B, true},
+            {"Bd", precise::bit / precise::s, true},
+            {"min", precise::min, false},
+            {"h", precise::hr, false},
+            {"d", precise::time::day, false},
+            {"wk", precise::time::week, false},
+            {"mo", precise::time::mog, false},
+            {"a", precise::time::year, false},
+            {"deg", precise::deg, false},
+            {"gon", precise::angle::gon, false},
+        };
+        constexpr std::size_t atomCount = sizeof(atoms) / sizeof(atom);
+
+        /// an SI prefix symbol and its multiplier
+        struct prefix {
+            const char* symbol;
+            double multiplier;
+        };
+        // da must come before d
+        constexpr prefix prefixes[] = {
+            {"Y", 1e24},   {"Z", 1e21},   {"E", 1e18},   {"P", 1e15},   {"T", 1e12},
+            {"G", 1e9},    {"M", 1e6},    {"k", 1e3},    {"h", 1e2},    {"da", 1e1},
+            {"d", 1e-1},   {"c", 1e-2},   {"m", 1e-3},   {"u", 1e-6},   {"n", 1e-9},
+            {"p", 1e-12},  {"f", 1e-15},  {"a", 1e-18},  {"z", 1e-21},  {"y", 1e-24},
+        };
+        constexpr std::size_t prefixCount = sizeof(prefixes) / sizeof(prefix);
+
+        /// the result of parsing part of a unit string
+        struct result {
+            precise_unit unit;
+            std::size_t next;
+        };
+
+        /** called on a malformed unit string,  this is not constexpr so a malformed literal in a
+        constant expression is a compile error,  at run time the unit is invalid*/
+        inline precise_unit invalidUnit()
+        {
+            return precise::invalid;
+        }
+
+        /// check if a character is a decimal digit
+        constexpr bool isDigit(char c)
+        {
+            return c >= '0' && c <= '9';
+        }
+
+        /// check if a character can be part of a unit symbol
+        constexpr bool isLetter(char c)
+        {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        }
+
+        /// get the end of a unit symbol
+        constexpr std::size_t symbolEnd(const char* str, std::size_t length, std::size_t pos)
+        {
+            return (pos < length && isLetter(str[pos])) ? symbolEnd(str, length, pos + 1) : pos;
+        }
+
+        /// get the end of a sequence of digits
+        constexpr std::size_t digitsEnd(const char* str, std::size_t length, std::size_t pos)
+        {
+            return (pos < length && isDigit(str[pos])) ? digitsEnd(str, length, pos + 1) : pos;
+        }
+
+        /// get the value of a sequence of digits
+        constexpr int
+            digitsValue(const char* str, std::size_t length, std::size_t pos, int value = 0)
+        {
+            return (pos < length && isDigit(str[pos])) ?
+                digitsValue(str, length, pos + 1, value * 10 + (str[pos] - '0')) :
+                value;
+        }
+
+        /// check if a null terminated symbol matches a section of a string
+        constexpr bool symbolMatch(const char* symbol, const char* str, std::size_t length)
+        {
+            return (length == 0) ?
+                (*symbol == '\0') :
+                (*symbol == *str && symbolMatch(symbol + 1, str + 1, length - 1));
+        }
+
+        /// get the index of a symbol in the atom table,  atomCount if not found
+        constexpr std::size_t
+            findAtom(const char* str, std::size_t length, std::size_t index = 0)
+        {
+            return (index >= atomCount) ? atomCount :
+                (symbolMatch(atoms[index].symbol, str, length) ? index :
+                                                                 findAtom(str, length, index + 1));
+        }
+
+        /// check if a string starts with a null terminated symbol
+        constexpr bool startsWith(const char* symbol, const char* str, std::size_t length)
+        {
+            return (*symbol == '\0') ?
+                true :
+                (length > 0 && *symbol == *str && startsWith(symbol + 1, str + 1, length - 1));
+        }
+
+        /// get the length of a null terminated symbol
+        constexpr std::size_t symbolLength(const char* symbol)
+        {
+            return (*symbol == '\0') ? 0 : 1 + symbolLength(symbol + 1);
+        }
+
+        /// check if a string is a metric unit symbol
+        constexpr bool isMetricAtom(const char* str, std::size_t length)
+        {
+            return findAtom(str, length) < atomCount && atoms[findAtom(str, length)].metric;
+        }
+
+        /// get the unit of a symbol made of a prefix and a metric unit starting with a given prefix
+        constexpr precise_unit
+            prefixedUnit(const char* str, std::size_t length, std::size_t index = 0)
+        {
+            return (index >= prefixCount) ?
+                invalidUnit() :
+                ((startsWith(prefixes[index].symbol, str, length) &&
+                  isMetricAtom(
+                      str + symbolLength(prefixes[index].symbol),
+                      length - symbolLength(prefixes[index].symbol))) ?
+                     precise_unit(
+                         prefixes[index].multiplier,
+                         atoms[findAtom(
+                                   str + symbolLength(prefixes[index].symbol),
+                                   length - symbolLength(prefixes[index].symbol))]
+                             .unit) :
+                     prefixedUnit(str, length, index + 1));
+        }
+
+        /// get the unit of a symbol,  a unit symbol takes precedence over a prefixed unit
+        constexpr precise_unit symbolUnit(const char* str, std::size_t length)
+        {
+            return (findAtom(str, length) < atomCount) ? atoms[findAtom(str, length)].unit :
+                                                         prefixedUnit(str, length);
+        }
+
+        /// parse a sequence of components joined by '.' or '/'
+        constexpr result parseTerm(const char* str, std::size_t length, std::size_t pos);
+
+        /// raise a unit to the power given by the digits starting at a position
+        constexpr result applyExponent(
+            const char* str,
+            std::size_t length,
+            precise_unit unit,
+            int sign,
+            std::size_t pos)
+        {
+            return (digitsEnd(str, length, pos) == pos) ?
+                result{invalidUnit(), length} :
+                result{unit.pow(sign * digitsValue(str, length, pos)), digitsEnd(str, length, pos)};
+        }
+
+        /// apply an exponent if one follows a unit
+        constexpr result exponent(const char* str, std::size_t length, result base)
+        {
+            return (base.next < length &&
+                    (str[base.next] == '+' || str[base.next] == '-' || isDigit(str[base.next]))) ?
+                applyExponent(
+                    str,
+                    length,
+                    base.unit,
+                    (str[base.next] == '-') ? -1 : 1,
+                    isDigit(str[base.next]) ? base.next : base.next + 1) :
+                base;
+        }
+
+        /// finish a parenthesized term
+        constexpr result closeGroup(const char* str, std::size_t length, result inner)
+        {
+            return (inner.next < length && str[inner.next] == ')') ?
+                exponent(str, length, result{inner.unit, inner.next + 1}) :
+                result{invalidUnit(), length};
+        }
+
+        /// parse a unit with its exponent,  an integer factor,  or a term in parenthesis
+        constexpr result parseComponent(const char* str, std::size_t length, std::size_t pos)
+        {
+            return (pos >= length) ?
+                result{invalidUnit(), length} :
+                ((str[pos] == '(') ?
+                     closeGroup(str, length, parseTerm(str, length, pos + 1)) :
+                     (isDigit(str[pos]) ?
+                          result{
+                              precise_unit(
+                                  static_cast<double>(digitsValue(str, length, pos)), precise::one),
+                              digitsEnd(str, length, pos)} :
+                          exponent(
+                              str,
+                              length,
+                              result{
+                                  symbolUnit(str + pos, symbolEnd(str, length, pos) - pos),
+                                  symbolEnd(str, length, pos)})));
+        }
+
+        /// combine a term with the next component
+        constexpr result combine(char operation, precise_unit left, result right)
+        {
+            return result{(operation == '/') ? left / right.unit : left * right.unit, right.next};
+        }
+
+        /// parse the operations following the first component of a term
+        constexpr result parseTermTail(const char* str, std::size_t length, result left)
+        {
+            return (left.next < length && (str[left.next] == '.' || str[left.next] == '/')) ?
+                parseTermTail(
+                    str,
+                    length,
+                    combine(
+                        str[left.next], left.unit, parseComponent(str, length, left.next + 1))) :
+                left;
+        }
+
+        constexpr result parseTerm(const char* str, std::size_t length, std::size_t pos)
+        {
+            return parseTermTail(str, length, parseComponent(str, length, pos));
+        }
+
+        /// check the whole string was used and no part of it was invalid
+        constexpr precise_unit finish(result term, std::size_t length)
+        {
+            return (term.next == length && !is_error(term.unit)) ? term.unit : invalidUnit();
+        }
+
+        /// parse a unit string,  a leading '/' inverts the unit
+        constexpr precise_unit parse(const char* str, std::size_t length)
+        {
+            return (length > 0 && str[0] == '/') ?
+                finish(combine('/', precise::one, parseTerm(str, length, 1)), length) :
+                finish(parseTerm(str, length, 0), length);
+        }
+    } // namespace ucum_literal
+} // namespace detail
+
+/// user defined literals for units
+namespace literals {
+    /** generate a precise_unit from a strict UCUM unit string such as "kg.m/s2"_punit
+    @details a malformed string used in a constant expression is a compile error,  at run time it
+    produces an invalid unit*/
+    constexpr precise_unit operator"" _punit(const char* str, std::size_t length)
+    {
+        return detail::ucum_literal::parse(str, length);
+    }
+    /// generate a unit from a strict UCUM unit string such as "kg.m/s2"_unit
+    constexpr unit operator"" _unit(const char* str, std::size_t length)
+    {
+        return unit_cast(detail::ucum_literal::parse(str, length));
+    }
+} // namespace literals
+} // namespace units
@@ -6,15 +6,23 @@ SPDX-License-Identifier: BSD-3-Clause
 */
 #include "units.hpp"
 
+#include "base_unit_index.hpp"
+
 #include <algorithm>
 #include <array>
 #include <atomic>
 #include <cctype>
+#include <chrono>
 #include <cstring>
+#include <exception>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
@@ -108,9 +116,128 @@ static int order(unit val)
     return order;
 }
 
+using ustr = std::pair<precise_unit, const char*>;
+// units to divide into tests to explore common multiplier units
+static UPTCONST std::array<ustr, 22> testUnits{{ustr{precise::m, "m"},
+                                                ustr{precise::s, "s"},
+                                                ustr{precise::ms, "ms"},
+                                                ustr{precise::min, "min"},
+                                                ustr{precise::hr, "hr"},
+                                                ustr{precise::time::day, "day"},
+                                                ustr{precise::lb, "lb"},
+                                                ustr{precise::ft, "ft"},
+                                                ustr{precise::ft.pow(2), "ft^2"},
+                                                ustr{precise::ft.pow(3), "ft^3"},
+                                                ustr{precise::m.pow(2), "m^2"},
+                                                ustr{precise::L, "L"},
+                                                ustr{precise::kg, "kg"},
+                                                ustr{precise::km, "km"},
+                                                ustr{precise::currency, "$"},
+                                                ustr{precise::volt, "V"},
+                                                ustr{precise::watt, "W"},
+                                                ustr{precise::kW, "kW"},
+                                                ustr{precise::mW, "mW"},
+                                                ustr{precise::MW, "MW"},
+                                                ustr{precise::s.pow(2), "s^2"},
+                                                ustr{precise::count, "item"}}};
+
+/// the ways a test unit is combined with a unit to find a name in to_string
+enum testUnitForm : size_t {
+    divided_by_test = 0, //!< the unit times the test unit is named: name/test
+    times_test = 1, //!< the unit divided by the test unit is named: name*test
+    test_divided_by = 2, //!< the inverse of the unit divided by the test unit is named: test/name
+    inverse_times_test = 3, //!< the inverse of the unit times the test unit is named: 1/(name*test)
+    test_unit_form_count = 4,
+};
+/// bit ii is set if test unit ii can give a named unit in a form
+using testUnitMasks = std::array<uint32_t, test_unit_form_count>;
+static_assert(std::tuple_size<decltype(testUnits)>::value <= 32, "test unit masks are 32 bits");
+
+/** the names of units grouped by their base units
+@details a unit matches a name if the base units are the same and the rounded multipliers are equal,  the same
+test as a lookup in an unordered_map keyed on unit.  Most lookups while generating a string are for base units
+with no names at all,  those are rejected with a single probe on the base units without rounding the
+multiplier.
+
+For the products of a unit with the test units the index also keeps,  for the base units of the unit, the
+test units which give base units with a name in each form.  This is one probe for all the test units
+instead of one for each,  and only the test units in the masks compute a multiplier and look up the name
+itself.  The test units have no flags so each test unit maps the base units of a name to exactly one set
+of base units of the unit being converted*/
+class unitNameIndex {
+  public:
+    unitNameIndex() = default;
+    unitNameIndex(std::initializer_list<std::pair<unit, const char*>> names)
+    {
+        // like the construction of a map the first name of a unit is kept
+        for (const auto& name : names) {
+            insert(name.first, name.second, false);
+        }
+    }
+    /// add a name for a unit,  replacing any existing name of the same unit
+    void add(unit un, std::string name) { insert(un, std::move(name), true); }
+    /// get the test units which can give a named unit when combined with a unit of the given base units
+    const testUnitMasks* testUnitCandidates(detail::unit_data base) const
+    {
+        auto fnd = products.find(base);
+        return (fnd != products.end()) ? &fnd->second : nullptr;
+    }
+    /// get the name of a unit,  nullptr if it doesn't have one
+    const std::string* find(unit un) const
+    {
+        auto fnd = index.find(un.base_units());
+        if (fnd == index.end()) {
+            return nullptr;
+        }
+        auto mult = un.cround();
+        for (const auto& candidate : fnd->second) {
+            if (candidate.first == mult) {
+                return &candidate.second;
+            }
+        }
+        return nullptr;
+    }
+
+  private:
+    void insert(unit un, std::string name, bool replace)
+    {
+        auto base = un.base_units();
+        auto fnd = index.find(base);
+        if (fnd == index.end()) {
+            fnd = index.emplace(base, std::vector<std::pair<float, std::string>>{}).first;
+            addProducts(base);
+        }
+        auto& candidates = fnd->second;
+        auto mult = un.cround();
+        for (auto& candidate : candidates) {
+            if (candidate.first == mult) {
+                if (replace) {
+                    candidate.second = std::move(name);
+                }
+                return;
+            }
+        }
+        candidates.emplace_back(mult, std::move(name));
+    }
+    // mark the test units that give the new named base units in each form
+    void addProducts(detail::unit_data named)
+    {
+        for (size_t ii = 0; ii < testUnits.size(); ++ii) {
+            auto test = testUnits[ii].first.base_units();
+            auto testBit = uint32_t{1} << ii;
+            products[named - test][divided_by_test] |= testBit;
+            products[named + test][times_test] |= testBit;
+            products[named.inv() + test][test_divided_by] |= testBit;
+            products[named.inv() - test][inverse_times_test] |= testBit;
+        }
+    }
+
+    std::unordered_map<detail::unit_data, std::vector<std::pair<float, std::string>>> index;
+    std::unordered_map<detail::unit_data, testUnitMasks> products;
+};
+
 // NOTE no units with '/' in it this can cause issues when converting to string with out of order operations
-using umap = std::unordered_map<unit, const char*>;
-static const umap base_unit_names{
+static const unitNameIndex base_unit_names{
     {m, "m"},
     {m * m, "m^2"},
     {m * m * m, "m^3"},
@@ -278,31 +405,6 @@ static const umap base_unit_names{
     {ppm, "ppm"},
     {ppb, "ppb"}};
 
-using ustr = std::pair<precise_unit, const char*>;
-// units to divide into tests to explore common multiplier units
-static UPTCONST std::array<ustr, 22> testUnits{{ustr{precise::m, "m"},
-                                                ustr{precise::s, "s"},
-                                                ustr{precise::ms, "ms"},
-                                                ustr{precise::min, "min"},
-                                                ustr{precise::hr, "hr"},
-                                                ustr{precise::time::day, "day"},
-                                                ustr{precise::lb, "lb"},
-                                                ustr{precise::ft, "ft"},
-                                                ustr{precise::ft.pow(2), "ft^2"},
-                                                ustr{precise::ft.pow(3), "ft^3"},
-                                                ustr{precise::m.pow(2), "m^2"},
-                                                ustr{precise::L, "L"},
-                                                ustr{precise::kg, "kg"},
-                                                ustr{precise::km, "km"},
-                                                ustr{precise::currency, "$"},
-                                                ustr{precise::volt, "V"},
-                                                ustr{precise::watt, "W"},
-                                                ustr{precise::kW, "kW"},
-                                                ustr{precise::mW, "mW"},
-                                                ustr{precise::MW, "MW"},
-                                                ustr{precise::s.pow(2), "s^2"},
-                                                ustr{precise::count, "item"}}};
-
 // complex units used to reduce unit complexity
 static UPTCONST std::array<ustr, 4> creduceUnits{{ustr{precise::V.inv(), "V*"},
                                                   ustr{precise::V, "V^-1*"},
@@ -332,9 +434,17 @@ static inline bool isNumericalCharacter(char X)
 }
 // forward declaration of the internal from_string function
 static precise_unit unit_from_string_internal(std::string unit_string, uint32_t match_flags);
-
-// forward declaration of the quick find function
-static precise_unit unit_quick_match(std::string unit_string, uint32_t match_flags);
+// forward declaration of the function to convert a segment of a string
+static precise_unit unit_from_string_segment(
+    const std::string& unit_string,
+    size_t start,
+    size_t length,
+    uint32_t match_flags);
+
+// forward declaration of the quick find functions
+static precise_unit
+    unit_quick_match(const char* unit_string, size_t length, uint32_t match_flags);
+static precise_unit unit_quick_match(const std::string& unit_string, uint32_t match_flags);
 // forward declaration of the function to check for custom units
 static precise_unit checkForCustomUnit(const std::string& unit_string);
 
@@ -522,34 +632,823 @@ static std::string generateRawUnitString(precise_unit un)
     return val;
 }
 
-static std::atomic<bool> allowUserDefinedUnits{true};
+/** a bounded concurrent cache split into independently locked shards
+@details each shard evicts with the CLOCK algorithm:  a hit sets the reference bit of an entry and an
+insertion into a full shard advances the clock hand,  clearing reference bits until it finds an entry that
+has not been used since the last pass.  Insertions carry the generation at the start of the computation so
+results computed before a clear are never stored
+*/
+template<typename KEY, typename VALUE, typename HASH>
+class concurrentClockCache {
+  public:
+    static constexpr size_t shardCount{16};
+    /// set the capacity, this clears the cache and resets the statistics
+    void resize(size_t capacity)
+    {
+        ++generation_;
+        hits.store(0);
+        misses.store(0);
+        evictions.store(0);
+        for (auto& shrd : shards) {
+            std::lock_guard<std::mutex> lock(shrd.lock);
+            shrd.clear();
+            shrd.capacity = (capacity + shardCount - 1) / shardCount;
+            shrd.entries.reserve(shrd.capacity);
+            shrd.ring.reserve(shrd.capacity);
+        }
+    }
+    /// remove all entries
+    void clear()
+    {
+        ++generation_;
+        for (auto& shrd : shards) {
+            std::lock_guard<std::mutex> lock(shrd.lock);
+            shrd.clear();
+        }
+    }
+    /// get the generation to use for a later insert
+    uint32_t generation() const { return generation_.load(); }
+    /// find a key in the cache and mark it as used
+    bool find(const KEY& key, VALUE& value)
+    {
+        return visit(key, [&value](const VALUE& val) { value = val; });
+    }
+    /** find a key in the cache and call a function with its value while the entry is locked
+    @details the function must not use the cache*/
+    template<typename FUNC>
+    bool visit(const KEY& key, FUNC&& func)
+    {
+        auto& shrd = getShard(key);
+        std::lock_guard<std::mutex> lock(shrd.lock);
+        auto fnd = shrd.entries.find(key);
+        if (fnd == shrd.entries.end()) {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        fnd->second.referenced = true;
+        func(fnd->second.value);
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    /// insert a value if the cache has not been cleared since generation was retrieved
+    void insert(KEY key, const VALUE& value, uint32_t generation)
+    {
+        auto& shrd = getShard(key);
+        std::lock_guard<std::mutex> lock(shrd.lock);
+        if (shrd.capacity == 0 || generation != generation_.load()) {
+            return;
+        }
+        if (shrd.ring.size() < shrd.capacity) {
+            auto res = shrd.entries.emplace(std::move(key), entry{value, false});
+            if (res.second) {
+                shrd.ring.push_back(res.first);
+            }
+            return;
+        }
+        if (shrd.entries.find(key) != shrd.entries.end()) {
+            return;
+        }
+        while (shrd.ring[shrd.hand]->second.referenced) {
+            shrd.ring[shrd.hand]->second.referenced = false;
+            shrd.hand = (shrd.hand + 1) % shrd.capacity;
+        }
+        shrd.entries.erase(shrd.ring[shrd.hand]);
+        shrd.ring[shrd.hand] = shrd.entries.emplace(std::move(key), entry{value, false}).first;
+        shrd.hand = (shrd.hand + 1) % shrd.capacity;
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+    /// get the current statistics of the cache
+    cache_statistics statistics()
+    {
+        cache_statistics stats;
+        stats.hits = hits.load(std::memory_order_relaxed);
+        stats.misses = misses.load(std::memory_order_relaxed);
+        stats.evictions = evictions.load(std::memory_order_relaxed);
+        for (auto& shrd : shards) {
+            std::lock_guard<std::mutex> lock(shrd.lock);
+            stats.size += shrd.entries.size();
+            stats.capacity += shrd.capacity;
+        }
+        return stats;
+    }
+
+  private:
+    struct entry {
+        VALUE value;
+        bool referenced;
+    };
+    using entryMap = std::unordered_map<KEY, entry, HASH>;
+    struct shard {
+        std::mutex lock;
+        entryMap entries; //!< the map is reserved to capacity so the iterators are stable
+        std::vector<typename entryMap::iterator> ring;
+        size_t hand{0};
+        size_t capacity{0};
+        void clear()
+        {
+            entries.clear();
+            ring.clear();
+            hand = 0;
+        }
+    };
+    shard& getShard(const KEY& key)
+    {
+        return shards[(HASH{}(key) >> 8U) % shardCount];
+    }
+    std::array<shard, shardCount> shards;
+    std::atomic<uint32_t> generation_{0};
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> evictions{0};
+};
+
+/// key for the cache of unit strings
+struct unitStringKey {
+    std::string unit_string;
+    uint32_t match_flags;
+    bool operator==(const unitStringKey& other) const
+    {
+        return match_flags == other.match_flags && unit_string == other.unit_string;
+    }
+};
+
+struct unitStringKeyHash {
+    size_t operator()(const unitStringKey& key) const
+    {
+        auto hash = std::hash<std::string>{}(key.unit_string);
+        return hash ^ (key.match_flags + 0x9e3779b9U + (hash << 6U) + (hash >> 2U));
+    }
+};
+
+/// key for the cache of generated unit strings,  the exact bits of the unit
+struct unitFormatKey {
+    uint64_t multiplier;
+    uint32_t base_units;
+    uint32_t commodity;
+    uint32_t match_flags;
+    bool operator==(const unitFormatKey& other) const
+    {
+        return multiplier == other.multiplier && base_units == other.base_units &&
+            commodity == other.commodity && match_flags == other.match_flags;
+    }
+};
+
+struct unitFormatKeyHash {
+    size_t operator()(const unitFormatKey& key) const
+    {
+        uint64_t hash = key.multiplier ^ (static_cast<uint64_t>(key.base_units) << 32U) ^
+            (static_cast<uint64_t>(key.commodity) * 0x9e3779b97f4a7c15ULL) ^ key.match_flags;
+        hash ^= hash >> 29U;
+        hash *= 0xbf58476d1ce4e5b9ULL;
+        hash ^= hash >> 32U;
+        return static_cast<size_t>(hash);
+    }
+};
+
+static std::atomic<bool> instrumentParsing{false};
+static std::mutex parseStatisticsLock;
+static parse_statistics parseStatistics;
+static size_t parseSlowestCount{16};
+
+static std::atomic<uint64_t> budgetMaxSteps{0};
+static std::atomic<uint64_t> budgetMaxProbes{0};
+static std::atomic<uint64_t> budgetMaxNanoseconds{0};
+
+/** the number of passes through the conversion process allowed for each character of a string
+@details the heuristics of the conversion process re-enter it for parts of the string,  and a string
+such as a fuzzer output with many separators can combine them into millions of passes.  Each
+conversion is allowed a number of passes proportional to the length of its string,  well above the 3
+passes per character of any real unit string,  so the work of a conversion grows linearly with the
+length of the string.  A conversion that runs out is cut off like one that exhausts the parse budget
+*/
+static constexpr uint64_t parsePassesPerCharacter{32};
+
+/// the state of a single conversion,  its trace and the limits on its work
+struct parseSession {
+    parse_trace trace;
+    /// the stage the outermost conversion is trying,  it goes in the trace if it produces a valid unit
+    parse_stage stageTried{parse_stage::unmatched};
+    uint32_t depth{0};
+    uint64_t maxPasses{0};
+    uint64_t maxSteps{0};
+    uint64_t maxProbes{0};
+    bool timed{false};
+    bool exceeded{false};
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point deadline;
+
+    // count a pass through the conversion process, returns false once the budget is exhausted
+    bool step()
+    {
+        ++trace.calls;
+        ++depth;
+        if (depth > trace.max_depth) {
+            trace.max_depth = depth;
+        }
+        if (trace.calls > maxPasses || (maxSteps != 0 && trace.calls > maxSteps) ||
+            (timed && std::chrono::steady_clock::now() > deadline)) {
+            exceeded = true;
+        }
+        return !exceeded;
+    }
+    // count a lookup in the unit tables, returns false once the budget is exhausted
+    bool probe()
+    {
+        ++trace.probes;
+        if (maxProbes != 0 && trace.probes > maxProbes) {
+            exceeded = true;
+        } else if (timed && (trace.probes & 0x3FU) == 0 && std::chrono::steady_clock::now() > deadline) {
+            exceeded = true;
+        }
+        return !exceeded;
+    }
+};
+// the session of the active conversion on this thread,  nullptr outside of a conversion
+static thread_local parseSession* activeSession{nullptr};
+static thread_local parse_trace lastTrace;
+static thread_local bool lastBudgetExceeded{false};
+
+void enableParseInstrumentation(size_t slowestCount)
+{
+    std::lock_guard<std::mutex> lock(parseStatisticsLock);
+    parseSlowestCount = slowestCount;
+    parseStatistics = parse_statistics{};
+    instrumentParsing.store(true);
+}
+
+void disableParseInstrumentation()
+{
+    instrumentParsing.store(false);
+}
 
-void disableUserDefinedUnits()
+void clearParseInstrumentation()
 {
-    allowUserDefinedUnits.store(false);
+    std::lock_guard<std::mutex> lock(parseStatisticsLock);
+    parseStatistics = parse_statistics{};
 }
-void enableUserDefinedUnits()
+
+parse_trace getLastParseTrace()
+{
+    return lastTrace;
+}
+
+parse_statistics getParseStatistics()
+{
+    std::lock_guard<std::mutex> lock(parseStatisticsLock);
+    auto stats = parseStatistics;
+    stats.stages.resize(parse_stage_count);
+    return stats;
+}
+
+const char* parseStageName(parse_stage stage)
+{
+    static constexpr const char* names[]{
+        "unmatched",
+        "cached",
+        "quick match",
+        "clean string",
+        "custom unit",
+        "leading number",
+        "operator split",
+        "power",
+        "commodity",
+        "SI prefix",
+        "capitalization",
+        "word prefix",
+        "alternate spelling",
+        "per rewrite",
+        "word modifiers",
+        "locality modifiers",
+        "partitioning",
+    };
+    static_assert(
+        sizeof(names) / sizeof(names[0]) == parse_stage_count,
+        "every parse stage needs a name");
+    auto index = static_cast<size_t>(stage);
+    return (index < parse_stage_count) ? names[index] : "unknown";
+}
+
+std::string parseInstrumentationReport()
+{
+    auto stats = getParseStatistics();
+    std::stringstream report;
+    report << "unit_from_string calls: " << stats.calls << '\n';
+    report << std::left << std::setw(20) << "stage" << std::right << std::setw(10) << "count"
+           << std::setw(14) << "avg probes" << std::setw(14) << "avg ns" << std::setw(14) << "max ns"
+           << '\n';
+    for (size_t ii = 0; ii < stats.stages.size(); ++ii) {
+        const auto& stage = stats.stages[ii];
+        if (stage.count == 0) {
+            continue;
+        }
+        report << std::left << std::setw(20) << parseStageName(static_cast<parse_stage>(ii))
+               << std::right << std::setw(10) << stage.count << std::setw(14)
+               << stage.probes / stage.count << std::setw(14) << stage.nanoseconds / stage.count
+               << std::setw(14) << stage.max_nanoseconds << '\n';
+    }
+    if (!stats.slowest.empty()) {
+        report << "slowest strings:\n";
+        for (const auto& trace : stats.slowest) {
+            report << "  " << trace.nanoseconds << " ns, " << trace.probes << " probes, depth "
+                   << trace.max_depth << ", " << parseStageName(trace.stage) << ": \""
+                   << trace.unit_string << "\"\n";
+        }
+    }
+    return report.str();
+}
+
+// add a completed trace to the aggregated statistics
+static void recordParseTrace(const parse_trace& trace)
+{
+    lastTrace = trace;
+    std::lock_guard<std::mutex> lock(parseStatisticsLock);
+    ++parseStatistics.calls;
+    parseStatistics.stages.resize(parse_stage_count);
+    auto& stage = parseStatistics.stages[static_cast<size_t>(trace.stage)];
+    ++stage.count;
+    stage.probes += trace.probes;
+    stage.nanoseconds += trace.nanoseconds;
+    if (trace.nanoseconds > stage.max_nanoseconds) {
+        stage.max_nanoseconds = trace.nanoseconds;
+    }
+    auto& slowest = parseStatistics.slowest;
+    if (slowest.size() < parseSlowestCount || trace.nanoseconds > slowest.back().nanoseconds) {
+        auto loc = std::upper_bound(
+            slowest.begin(),
+            slowest.end(),
+            trace,
+            [](const parse_trace& t1, const parse_trace& t2) {
+                return t1.nanoseconds > t2.nanoseconds;
+            });
+        slowest.insert(loc, trace);
+        if (slowest.size() > parseSlowestCount) {
+            slowest.pop_back();
+        }
+    }
+}
+
+void setParseBudget(const parse_budget& budget)
+{
+    budgetMaxSteps.store(budget.max_steps);
+    budgetMaxProbes.store(budget.max_probes);
+    budgetMaxNanoseconds.store(budget.max_nanoseconds);
+}
+
+parse_budget getParseBudget()
+{
+    parse_budget budget;
+    budget.max_steps = budgetMaxSteps.load();
+    budget.max_probes = budgetMaxProbes.load();
+    budget.max_nanoseconds = budgetMaxNanoseconds.load();
+    return budget;
+}
+
+void clearParseBudget()
+{
+    setParseBudget(parse_budget{});
+}
+
+bool parseBudgetExceeded()
+{
+    return lastBudgetExceeded;
+}
+
+// run a conversion as a session on the calling thread
+class parseSessionScope {
+  public:
+    parseSessionScope(const std::string& unit_string, bool instrument, const parse_budget& budget) :
+        instrumented(instrument && instrumentParsing.load())
+    {
+        if (instrumented) {
+            session.trace.unit_string = unit_string;
+        }
+        session.maxPasses = parsePassesPerCharacter * (unit_string.size() + 1);
+        session.maxSteps = budget.max_steps;
+        session.maxProbes = budget.max_probes;
+        session.timed = (budget.max_nanoseconds != 0);
+        if (instrumented || session.timed) {
+            session.start = std::chrono::steady_clock::now();
+        }
+        if (session.timed) {
+            session.deadline = session.start + std::chrono::nanoseconds(budget.max_nanoseconds);
+        }
+        activeSession = &session;
+    }
+    ~parseSessionScope() { activeSession = nullptr; }
+    parseSessionScope(const parseSessionScope&) = delete;
+    parseSessionScope& operator=(const parseSessionScope&) = delete;
+
+    /// end the session,  the result of a conversion that ran out of budget is always invalid
+    precise_unit finish(precise_unit result)
+    {
+        activeSession = nullptr;
+        lastBudgetExceeded = session.exceeded;
+        if (session.exceeded) {
+            result = precise::invalid;
+        }
+        if (instrumented) {
+            auto elapsed = std::chrono::steady_clock::now() - session.start;
+            session.trace.nanoseconds = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+            session.trace.budget_exceeded = session.exceeded;
+            if (!is_valid(result)) {
+                session.trace.stage = parse_stage::unmatched;
+            }
+            recordParseTrace(session.trace);
+        }
+        return result;
+    }
+
+  private:
+    parseSession session;
+    bool instrumented;
+};
+
+// mark the stage the outermost pass of unit_from_string_steps is trying
+static inline void markParseStage(parse_stage stage)
+{
+    if (activeSession != nullptr && activeSession->depth == 1) {
+        activeSession->stageTried = stage;
+    }
+}
+
+// record the stage that produced the result of the outermost conversion,  nested conversions are part of
+// the stage of the outermost one and an invalid result is unmatched
+static inline void recordParseStage(parse_stage stage, const precise_unit& result)
 {
-    allowUserDefinedUnits.store(true);
+    if (activeSession != nullptr && activeSession->depth == 0 && is_valid(result)) {
+        activeSession->trace.stage = stage;
+    }
 }
 
+// count a lookup in the unit tables,  returns false if the budget of the conversion is exhausted
+static inline bool allowParseProbe()
+{
+    return (activeSession == nullptr || activeSession->probe());
+}
+
+// track the nesting and the budget of the conversion process
+class parseDepthGuard {
+  public:
+    parseDepthGuard() : session(activeSession)
+    {
+        if (session != nullptr && !session->step()) {
+            allowed = false;
+        }
+    }
+    ~parseDepthGuard()
+    {
+        if (session != nullptr) {
+            --session->depth;
+        }
+    }
+    parseDepthGuard(const parseDepthGuard&) = delete;
+    parseDepthGuard& operator=(const parseDepthGuard&) = delete;
+    /// check if the budget of the conversion is exhausted
+    bool exhausted() const { return !allowed; }
+
+  private:
+    parseSession* session;
+    bool allowed{true};
+};
+
+/** character trie of unit strings used to find all the leading substrings of a string which are unit strings
+in a single pass*/
+class unitPrefixTrie {
+  public:
+    /// add a unit string to the trie
+    void insert(const char* str, size_t length)
+    {
+        if (nodes.empty()) {
+            nodes.emplace_back();
+        }
+        size_t node{0};
+        for (size_t ii = 0; ii < length; ++ii) {
+            auto next = child(node, str[ii]);
+            if (next == 0) {
+                next = nodes.size();
+                nodes.emplace_back();
+                nodes.back().ch = str[ii];
+                nodes.back().sibling = nodes[node].child;
+                nodes[node].child = static_cast<uint32_t>(next);
+            }
+            node = next;
+        }
+        nodes[node].terminal = true;
+    }
+    /// remove all the unit strings
+    void clear() { nodes.clear(); }
+    /** mark the lengths of the leading substrings of a string which are in the trie
+    @param str the string to check
+    @param first the character to use in place of the first character of the string
+    @param matches vector of flags indexed by the substring length,  matched lengths are set to true
+    */
+    void markPrefixes(const std::string& str, char first, std::vector<bool>& matches) const
+    {
+        if (nodes.empty() || str.empty()) {
+            return;
+        }
+        size_t node = child(0, first);
+        for (size_t ii = 1; node != 0; ++ii) {
+            if (nodes[node].terminal) {
+                matches[ii] = true;
+            }
+            if (ii >= str.size()) {
+                break;
+            }
+            node = child(node, str[ii]);
+        }
+    }
+
+  private:
+    struct trieNode {
+        uint32_t child{0};
+        uint32_t sibling{0};
+        char ch{'\0'};
+        bool terminal{false};
+    };
+    size_t child(size_t node, char ch) const
+    {
+        auto next = nodes[node].child;
+        while (next != 0 && nodes[next].ch != ch) {
+            next = nodes[next].sibling;
+        }
+        return next;
+    }
+    std::vector<trieNode> nodes;
+};
+
 using smap = std::unordered_map<std::string, precise_unit>;
 
-static std::unordered_map<unit, std::string> user_defined_unit_names;
-static smap user_defined_units;
+/// an immutable snapshot of the user defined units
+struct userUnitRegistry {
+    unitNameIndex names;
+    smap units;
+    unitPrefixTrie trie;
+};
 
-void addUserDefinedUnit(std::string name, precise_unit un)
+namespace detail {
+    /** the user defined units and the unit string caches of a context
+    @details the user defined units are published as a whole by writers (RCU style) and the snapshot is only
+    accessed through std::atomic_load and std::atomic_store.  Each publication is given a version that is
+    unique across all contexts.  Each thread keeps its own reference to the snapshot and only reloads it when
+    the version changes,  so readers take no locks in the common case and a snapshot is released when the
+    last thread using it moves on to a newer one
+    */
+    struct unitContextData {
+        std::shared_ptr<const userUnitRegistry> userUnits;
+        std::atomic<uint64_t> version{0};
+        /// writers are serialized so no update is lost
+        std::mutex writeLock;
+        std::atomic<bool> allowUserDefinedUnits{true};
+        std::atomic<bool> useCache{false};
+        concurrentClockCache<unitStringKey, precise_unit, unitStringKeyHash> cache;
+        std::atomic<bool> useFormatCache{false};
+        concurrentClockCache<unitFormatKey, std::string, unitFormatKeyHash> formatCache;
+    };
+} // namespace detail
+
+/// the state used when no context is active
+static detail::unitContextData globalUnitData;
+/// source of the versions of the user defined unit snapshots
+static std::atomic<uint64_t> userUnitVersions{0};
+
+static thread_local const context* activeContext{nullptr};
+static thread_local detail::unitContextData* activeUnitData{nullptr};
+
+// get the state to use for a conversion on the calling thread
+static inline detail::unitContextData& activeUnits()
+{
+    return (activeUnitData != nullptr) ? *activeUnitData : globalUnitData;
+}
+
+/** get the current user defined units for this thread,  nullptr if there are none
+@details the pointer is valid until the next call from the same thread*/
+static const userUnitRegistry* userUnits()
+{
+    thread_local std::shared_ptr<const userUnitRegistry> localSnapshot;
+    thread_local uint64_t localVersion{0};
+    auto& data = activeUnits();
+    auto version = data.version.load(std::memory_order_acquire);
+    if (version != localVersion) {
+        localSnapshot = std::atomic_load(&data.userUnits);
+        localVersion = version;
+    }
+    return localSnapshot.get();
+}
+
+/// publish a new snapshot of the user defined units,  the write lock must be held
+static void publishUserUnits(
+    detail::unitContextData& data,
+    std::shared_ptr<const userUnitRegistry> registry)
+{
+    std::atomic_store(&data.userUnits, std::move(registry));
+    data.version.store(userUnitVersions.fetch_add(1) + 1, std::memory_order_release);
+    data.cache.clear();
+    data.formatCache.clear();
+}
+
+static void addUserDefinedUnits(
+    detail::unitContextData& data,
+    const std::vector<std::pair<std::string, precise_unit>>& units)
 {
-    if (allowUserDefinedUnits.load()) {
-        user_defined_unit_names[unit_cast(un)] = name;
-        user_defined_units[name] = un;
+    if (!data.allowUserDefinedUnits.load() || units.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(data.writeLock);
+    auto current = std::atomic_load(&data.userUnits);
+    auto registry = (current) ? std::make_shared<userUnitRegistry>(*current) :
+                                std::make_shared<userUnitRegistry>();
+    for (const auto& def : units) {
+        registry->names.add(unit_cast(def.second), def.first);
+        registry->trie.insert(def.first.c_str(), def.first.size());
+        registry->units[def.first] = def.second;
     }
+    publishUserUnits(data, std::move(registry));
+}
+
+static void clearUserDefinedUnits(detail::unitContextData& data)
+{
+    std::lock_guard<std::mutex> lock(data.writeLock);
+    publishUserUnits(data, nullptr);
+}
+
+static void enableUnitStringCache(detail::unitContextData& data, size_t capacity)
+{
+    data.cache.resize(capacity);
+    data.useCache.store(true);
+}
+
+static void disableUnitStringCache(detail::unitContextData& data)
+{
+    data.useCache.store(false);
+    data.cache.resize(0);
+}
+
+static void enableUnitFormatCache(detail::unitContextData& data, size_t capacity)
+{
+    data.formatCache.resize(capacity);
+    data.useFormatCache.store(true);
+}
+
+static void disableUnitFormatCache(detail::unitContextData& data)
+{
+    data.useFormatCache.store(false);
+    data.formatCache.resize(0);
+}
+
+void addUserDefinedUnits(const std::vector<std::pair<std::string, precise_unit>>& units)
+{
+    addUserDefinedUnits(globalUnitData, units);
+}
+
+void addUserDefinedUnit(std::string name, precise_unit un)
+{
+    addUserDefinedUnits(globalUnitData, {{std::move(name), un}});
+}
+
+void clearUserDefinedUnits()
+{
+    clearUserDefinedUnits(globalUnitData);
+}
+
+void disableUserDefinedUnits()
+{
+    globalUnitData.allowUserDefinedUnits.store(false);
+}
+
+void enableUserDefinedUnits()
+{
+    globalUnitData.allowUserDefinedUnits.store(true);
+}
+
+void enableUnitStringCache(size_t capacity)
+{
+    enableUnitStringCache(globalUnitData, capacity);
+}
+
+void disableUnitStringCache()
+{
+    disableUnitStringCache(globalUnitData);
+}
+
+void clearUnitStringCache()
+{
+    globalUnitData.cache.clear();
+}
+
+cache_statistics getUnitStringCacheStatistics()
+{
+    return globalUnitData.cache.statistics();
+}
+
+void enableUnitFormatCache(size_t capacity)
+{
+    enableUnitFormatCache(globalUnitData, capacity);
+}
+
+void disableUnitFormatCache()
+{
+    disableUnitFormatCache(globalUnitData);
+}
+
+void clearUnitFormatCache()
+{
+    globalUnitData.formatCache.clear();
+}
+
+cache_statistics getUnitFormatCacheStatistics()
+{
+    return globalUnitData.formatCache.statistics();
+}
+
+context::context() :
+    unitData(std::make_shared<detail::unitContextData>()), commodityData(newCommodityData())
+{
+}
+
+context::~context() = default;
+
+void context::addUserDefinedUnit(std::string name, precise_unit un)
+{
+    units::addUserDefinedUnits(*unitData, {{std::move(name), un}});
+}
+
+void context::addUserDefinedUnits(const std::vector<std::pair<std::string, precise_unit>>& units)
+{
+    units::addUserDefinedUnits(*unitData, units);
+}
+
+void context::clearUserDefinedUnits()
+{
+    units::clearUserDefinedUnits(*unitData);
+}
+
+void context::disableUserDefinedUnits()
+{
+    unitData->allowUserDefinedUnits.store(false);
+}
+
+void context::enableUserDefinedUnits()
+{
+    unitData->allowUserDefinedUnits.store(true);
+}
+
+void context::enableUnitStringCache(size_t capacity)
+{
+    units::enableUnitStringCache(*unitData, capacity);
+}
+
+void context::disableUnitStringCache()
+{
+    units::disableUnitStringCache(*unitData);
+}
+
+void context::clearUnitStringCache()
+{
+    unitData->cache.clear();
+}
+
+cache_statistics context::getUnitStringCacheStatistics() const
+{
+    return unitData->cache.statistics();
+}
+
+void context::enableUnitFormatCache(size_t capacity)
+{
+    units::enableUnitFormatCache(*unitData, capacity);
+}
+
+void context::disableUnitFormatCache()
+{
+    units::disableUnitFormatCache(*unitData);
+}
+
+void context::clearUnitFormatCache()
+{
+    unitData->formatCache.clear();
+}
+
+cache_statistics context::getUnitFormatCacheStatistics() const
+{
+    return unitData->formatCache.statistics();
+}
+
+context::scope::scope(const context& ctx) : previous(activeContext)
+{
+    activeContext = &ctx;
+    activeUnitData = ctx.unitData.get();
+}
+
+context::scope::~scope()
+{
+    activeContext = previous;
+    activeUnitData = (previous != nullptr) ? previous->unitData.get() : nullptr;
 }
 
-void clearUserDefinedUnits()
+const context* context::current()
 {
-    user_defined_unit_names.clear();
-    user_defined_units.clear();
+    return activeContext;
 }
 
 // add escapes for some particular sequences
@@ -657,18 +1556,36 @@ std::string clean_unit_string(std::string propUnitString, uint32_t commodity)
 
 static std::string find_unit(unit un)
 {
-    if (!user_defined_unit_names.empty()) {
-        auto fndud = user_defined_unit_names.find(un);
-        if (fndud != user_defined_unit_names.end()) {
-            return fndud->second;
+    const auto* registry = userUnits();
+    if (registry != nullptr) {
+        const auto* fndud = registry->names.find(un);
+        if (fndud != nullptr) {
+            return *fndud;
         }
     }
-    auto fnd = base_unit_names.find(un);
-    if (fnd != base_unit_names.end()) {
-        return fnd->second;
+    const auto* fnd = base_unit_names.find(un);
+    return (fnd != nullptr) ? *fnd : std::string{};
+}
+// get the test units which can give a named unit in each form when combined with a unit of the given base units
+static testUnitMasks testUnitCandidates(detail::unit_data base)
+{
+    testUnitMasks masks{};
+    const auto* registry = userUnits();
+    if (registry != nullptr) {
+        const auto* user = registry->names.testUnitCandidates(base);
+        if (user != nullptr) {
+            masks = *user;
+        }
+    }
+    const auto* builtin = base_unit_names.testUnitCandidates(base);
+    if (builtin != nullptr) {
+        for (size_t ii = 0; ii < masks.size(); ++ii) {
+            masks[ii] |= (*builtin)[ii];
+        }
     }
-    return std::string{};
+    return masks;
 }
+
 static std::string to_string_internal(precise_unit un, uint32_t match_flags)
 {
     if (!std::isnormal(un.multiplier())) {
@@ -760,8 +1677,14 @@ static std::string to_string_internal(precise_unit un, uint32_t match_flags)
         }
         return std::string("1/") + prefix;
     }
+    // one probe for the test units which can give a named unit in each form
+    auto candidates = testUnitCandidates(un.base_units());
     // let's try common divisor units
-    for (auto& tu : testUnits) {
+    for (size_t ii = 0; ii < testUnits.size(); ++ii) {
+        if ((candidates[divided_by_test] & (uint32_t{1} << ii)) == 0) {
+            continue;
+        }
+        const auto& tu = testUnits[ii];
         auto ext = un * tu.first;
         fnd = find_unit(unit_cast(ext));
         if (!fnd.empty()) {
@@ -770,7 +1693,11 @@ static std::string to_string_internal(precise_unit un, uint32_t match_flags)
     }
 
     // let's try common multiplier units
-    for (auto& tu : testUnits) {
+    for (size_t ii = 0; ii < testUnits.size(); ++ii) {
+        if ((candidates[times_test] & (uint32_t{1} << ii)) == 0) {
+            continue;
+        }
+        const auto& tu = testUnits[ii];
         auto ext = un / tu.first;
         fnd = find_unit(unit_cast(ext));
         if (!fnd.empty()) {
@@ -778,7 +1705,11 @@ static std::string to_string_internal(precise_unit un, uint32_t match_flags)
         }
     }
     // let's try common divisor with inv units
-    for (auto& tu : testUnits) {
+    for (size_t ii = 0; ii < testUnits.size(); ++ii) {
+        if ((candidates[test_divided_by] & (uint32_t{1} << ii)) == 0) {
+            continue;
+        }
+        const auto& tu = testUnits[ii];
         auto ext = un / tu.first;
         fnd = find_unit(unit_cast(ext.inv()));
         if (!fnd.empty()) {
@@ -786,7 +1717,11 @@ static std::string to_string_internal(precise_unit un, uint32_t match_flags)
         }
     }
     // let's try inverse of common multiplier units
-    for (auto& tu : testUnits) {
+    for (size_t ii = 0; ii < testUnits.size(); ++ii) {
+        if ((candidates[inverse_times_test] & (uint32_t{1} << ii)) == 0) {
+            continue;
+        }
+        const auto& tu = testUnits[ii];
         auto ext = un * tu.first;
         fnd = find_unit(unit_cast(ext.inv()));
         if (!fnd.empty()) {
@@ -847,7 +1782,11 @@ static std::string to_string_internal(precise_unit un, uint32_t match_flags)
 
     std::string beststr;
     // let's try common divisor units on base units
-    for (auto& tu : testUnits) {
+    for (size_t ii = 0; ii < testUnits.size(); ++ii) {
+        if ((candidates[divided_by_test] & (uint32_t{1} << ii)) == 0) {
+            continue;
+        }
+        const auto& tu = testUnits[ii];
         auto ext = un * tu.first;
         auto base = unit(ext.base_units());
         fnd = find_unit(base);
@@ -865,7 +1804,11 @@ static std::string to_string_internal(precise_unit un, uint32_t match_flags)
     }
 
     // let's try common multiplier units on base units
-    for (auto& tu : testUnits) {
+    for (size_t ii = 0; ii < testUnits.size(); ++ii) {
+        if ((candidates[times_test] & (uint32_t{1} << ii)) == 0) {
+            continue;
+        }
+        const auto& tu = testUnits[ii];
         auto ext = un / tu.first;
         auto base = unit(ext.base_units());
         fnd = find_unit(base);
@@ -881,7 +1824,11 @@ static std::string to_string_internal(precise_unit un, uint32_t match_flags)
         }
     }
     // let's try common divisor with inv units on base units
-    for (auto& tu : testUnits) {
+    for (size_t ii = 0; ii < testUnits.size(); ++ii) {
+        if ((candidates[test_divided_by] & (uint32_t{1} << ii)) == 0) {
+            continue;
+        }
+        const auto& tu = testUnits[ii];
         auto ext = un / tu.first;
         auto base = unit(ext.base_units());
 
@@ -902,7 +1849,11 @@ static std::string to_string_internal(precise_unit un, uint32_t match_flags)
         }
     }
     // let's try inverse of common multiplier units on base units
-    for (auto& tu : testUnits) {
+    for (size_t ii = 0; ii < testUnits.size(); ++ii) {
+        if ((candidates[inverse_times_test] & (uint32_t{1} << ii)) == 0) {
+            continue;
+        }
+        const auto& tu = testUnits[ii];
         auto ext = un * tu.first;
         auto base = unit(ext.base_units());
         fnd = find_unit(base.inv());
@@ -939,9 +1890,40 @@ static std::string to_string_internal(precise_unit un, uint32_t match_flags)
         mino_unit.multiplier(), min_mult + generateRawUnitString(mino_unit));
 }
 
+/** check if the name of a commodity can only change through the functions which clear the format cache
+@details the names of unrecognized commodity strings are stored separately and can be evicted*/
+static bool isStableCommodityName(uint32_t commodity)
+{
+    auto code = ((commodity & 0x80000000U) == 0) ? commodity : (~commodity);
+    return (code & 0x60000000U) != 0x60000000U;
+}
+
+// get the key of a unit in the format cache
+static unitFormatKey formatKey(precise_unit un, uint32_t match_flags)
+{
+    auto base = un.base_units();
+    auto mult = un.multiplier();
+    unitFormatKey key{0, 0, un.commodity(), match_flags};
+    std::memcpy(&key.multiplier, &mult, sizeof(key.multiplier));
+    std::memcpy(&key.base_units, &base, sizeof(key.base_units));
+    return key;
+}
+
 std::string to_string(precise_unit un, uint32_t match_flags)
 {
-    return clean_unit_string(to_string_internal(un, match_flags), un.commodity());
+    auto& data = activeUnits();
+    if (!data.useFormatCache.load() || !isStableCommodityName(un.commodity())) {
+        return clean_unit_string(to_string_internal(un, match_flags), un.commodity());
+    }
+    auto key = formatKey(un, match_flags);
+    std::string result;
+    if (data.formatCache.find(key, result)) {
+        return result;
+    }
+    auto generation = data.formatCache.generation();
+    result = clean_unit_string(to_string_internal(un, match_flags), un.commodity());
+    data.formatCache.insert(key, result, generation);
+    return result;
 }
 
 std::string to_string(precision_measurement measure, uint32_t match_flags)
@@ -974,6 +1956,435 @@ std::string to_string(measurement_f measure, uint32_t match_flags)
     return ss.str();
 }
 
+namespace shortest {
+/** shortest round trip formatting of floating point numbers with the Grisu2 algorithm
+@details from "Printing Floating-Point Numbers Quickly and Accurately with Integers" by Florian Loitsch.
+The digits always convert back to the same number and are the shortest such digits in almost all cases*/
+
+/// a floating point number f*2^e with a 64 bit significand
+struct diyfp {
+    uint64_t f;
+    int e;
+};
+
+static inline diyfp sub(diyfp x, diyfp y)
+{
+    return {x.f - y.f, x.e};
+}
+
+// the upper 64 bits of the product of the significands,  rounded
+static inline diyfp mul(diyfp x, diyfp y)
+{
+    const uint64_t xlo = x.f & 0xFFFFFFFFU;
+    const uint64_t xhi = x.f >> 32U;
+    const uint64_t ylo = y.f & 0xFFFFFFFFU;
+    const uint64_t yhi = y.f >> 32U;
+    const uint64_t plolo = xlo * ylo;
+    const uint64_t plohi = xlo * yhi;
+    const uint64_t philo = xhi * ylo;
+    const uint64_t phihi = xhi * yhi;
+    uint64_t mid = (plolo >> 32U) + (plohi & 0xFFFFFFFFU) + (philo & 0xFFFFFFFFU);
+    mid += uint64_t{1} << 31U;
+    return {phihi + (plohi >> 32U) + (philo >> 32U) + (mid >> 32U), x.e + y.e + 64};
+}
+
+static inline diyfp normalize(diyfp x)
+{
+    while ((x.f >> 63U) == 0) {
+        x.f <<= 1U;
+        --x.e;
+    }
+    return x;
+}
+
+static inline diyfp normalizeTo(diyfp x, int e)
+{
+    return {x.f << static_cast<unsigned int>(x.e - e), e};
+}
+
+/// a number and the boundaries of the interval of numbers which round to it
+struct boundaries {
+    diyfp w;
+    diyfp minus;
+    diyfp plus;
+};
+
+template<typename FLOAT, typename BITS>
+static boundaries computeBoundaries(FLOAT value)
+{
+    constexpr int precision = std::numeric_limits<FLOAT>::digits;
+    constexpr int bias = std::numeric_limits<FLOAT>::max_exponent - 1 + (precision - 1);
+    constexpr int minExp = 1 - bias;
+    constexpr uint64_t hiddenBit = uint64_t{1} << static_cast<unsigned int>(precision - 1);
+
+    BITS bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint64_t F = bits & (hiddenBit - 1);
+    const auto E = static_cast<int>(bits >> static_cast<unsigned int>(precision - 1));
+
+    const diyfp v = (E == 0) ? diyfp{F, minExp} : diyfp{F + hiddenBit, E - bias};
+    const bool lowerCloser = (F == 0 && E > 1);
+    const diyfp plus{2 * v.f + 1, v.e - 1};
+    const diyfp minus = lowerCloser ? diyfp{4 * v.f - 1, v.e - 2} : diyfp{2 * v.f - 1, v.e - 1};
+
+    const diyfp wplus = normalize(plus);
+    return {normalize(v), normalizeTo(minus, wplus.e), wplus};
+}
+
+/// a normalized approximation of 10^k = f*2^e
+struct cachedPower {
+    uint64_t f;
+    int e;
+    int k;
+};
+
+// the range of the binary exponent of the scaled numbers for the digit generation
+constexpr int alpha{-60};
+constexpr int gamma{-32};
+
+static cachedPower getCachedPower(int e)
+{
+    static const std::array<cachedPower, 79> cachedPowers{{
+        {0xAB70FE17C79AC6CAULL, -1060, -300},
+        {0xFF77B1FCBEBCDC4FULL, -1034, -292},
+        {0xBE5691EF416BD60CULL, -1007, -284},
+        {0x8DD01FAD907FFC3CULL, -980, -276},
+        {0xD3515C2831559A83ULL, -954, -268},
+        {0x9D71AC8FADA6C9B5ULL, -927, -260},
+        {0xEA9C227723EE8BCBULL, -901, -252},
+        {0xAECC49914078536DULL, -874, -244},
+        {0x823C12795DB6CE57ULL, -847, -236},
+        {0xC21094364DFB5637ULL, -821, -228},
+        {0x9096EA6F3848984FULL, -794, -220},
+        {0xD77485CB25823AC7ULL, -768, -212},
+        {0xA086CFCD97BF97F4ULL, -741, -204},
+        {0xEF340A98172AACE5ULL, -715, -196},
+        {0xB23867FB2A35B28EULL, -688, -188},
+        {0x84C8D4DFD2C63F3BULL, -661, -180},
+        {0xC5DD44271AD3CDBAULL, -635, -172},
+        {0x936B9FCEBB25C996ULL, -608, -164},
+        {0xDBAC6C247D62A584ULL, -582, -156},
+        {0xA3AB66580D5FDAF6ULL, -555, -148},
+        {0xF3E2F893DEC3F126ULL, -529, -140},
+        {0xB5B5ADA8AAFF80B8ULL, -502, -132},
+        {0x87625F056C7C4A8BULL, -475, -124},
+        {0xC9BCFF6034C13053ULL, -449, -116},
+        {0x964E858C91BA2655ULL, -422, -108},
+        {0xDFF9772470297EBDULL, -396, -100},
+        {0xA6DFBD9FB8E5B88FULL, -369, -92},
+        {0xF8A95FCF88747D94ULL, -343, -84},
+        {0xB94470938FA89BCFULL, -316, -76},
+        {0x8A08F0F8BF0F156BULL, -289, -68},
+        {0xCDB02555653131B6ULL, -263, -60},
+        {0x993FE2C6D07B7FACULL, -236, -52},
+        {0xE45C10C42A2B3B06ULL, -210, -44},
+        {0xAA242499697392D3ULL, -183, -36},
+        {0xFD87B5F28300CA0EULL, -157, -28},
+        {0xBCE5086492111AEBULL, -130, -20},
+        {0x8CBCCC096F5088CCULL, -103, -12},
+        {0xD1B71758E219652CULL, -77, -4},
+        {0x9C40000000000000ULL, -50, 4},
+        {0xE8D4A51000000000ULL, -24, 12},
+        {0xAD78EBC5AC620000ULL, 3, 20},
+        {0x813F3978F8940984ULL, 30, 28},
+        {0xC097CE7BC90715B3ULL, 56, 36},
+        {0x8F7E32CE7BEA5C70ULL, 83, 44},
+        {0xD5D238A4ABE98068ULL, 109, 52},
+        {0x9F4F2726179A2245ULL, 136, 60},
+        {0xED63A231D4C4FB27ULL, 162, 68},
+        {0xB0DE65388CC8ADA8ULL, 189, 76},
+        {0x83C7088E1AAB65DBULL, 216, 84},
+        {0xC45D1DF942711D9AULL, 242, 92},
+        {0x924D692CA61BE758ULL, 269, 100},
+        {0xDA01EE641A708DEAULL, 295, 108},
+        {0xA26DA3999AEF774AULL, 322, 116},
+        {0xF209787BB47D6B85ULL, 348, 124},
+        {0xB454E4A179DD1877ULL, 375, 132},
+        {0x865B86925B9BC5C2ULL, 402, 140},
+        {0xC83553C5C8965D3DULL, 428, 148},
+        {0x952AB45CFA97A0B3ULL, 455, 156},
+        {0xDE469FBD99A05FE3ULL, 481, 164},
+        {0xA59BC234DB398C25ULL, 508, 172},
+        {0xF6C69A72A3989F5CULL, 534, 180},
+        {0xB7DCBF5354E9BECEULL, 561, 188},
+        {0x88FCF317F22241E2ULL, 588, 196},
+        {0xCC20CE9BD35C78A5ULL, 614, 204},
+        {0x98165AF37B2153DFULL, 641, 212},
+        {0xE2A0B5DC971F303AULL, 667, 220},
+        {0xA8D9D1535CE3B396ULL, 694, 228},
+        {0xFB9B7CD9A4A7443CULL, 720, 236},
+        {0xBB764C4CA7A44410ULL, 747, 244},
+        {0x8BAB8EEFB6409C1AULL, 774, 252},
+        {0xD01FEF10A657842CULL, 800, 260},
+        {0x9B10A4E5E9913129ULL, 827, 268},
+        {0xE7109BFBA19C0C9DULL, 853, 276},
+        {0xAC2820D9623BF429ULL, 880, 284},
+        {0x80444B5E7AA7CF85ULL, 907, 292},
+        {0xBF21E44003ACDD2DULL, 933, 300},
+        {0x8E679C2F5E44FF8FULL, 960, 308},
+        {0xD433179D9C8CB841ULL, 986, 316},
+        {0x9E19DB92B4E31BA9ULL, 1013, 324},
+    }};
+    constexpr int minDecExp{-300};
+    constexpr int decStep{8};
+    // find k with alpha <= e_c + e + 64 <= gamma,  log10(2) is approximately 78913/2^18
+    const int f = alpha - e - 1;
+    const int k = (f * 78913) / (1 << 18) + static_cast<int>(f > 0);
+    const int index = (-minDecExp + k + (decStep - 1)) / decStep;
+    return cachedPowers[static_cast<size_t>(index)];
+}
+
+// find the largest power of 10 <= n and return the number of digits of n
+static int largestPow10(uint32_t n, uint32_t& pow10)
+{
+    static const std::array<uint32_t, 10> powers{
+        {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000}};
+    int count = 10;
+    while (count > 1 && n < powers[static_cast<size_t>(count - 1)]) {
+        --count;
+    }
+    pow10 = powers[static_cast<size_t>(count - 1)];
+    return count;
+}
+
+// move the last digit closer to the number while it stays in the interval
+static void
+    roundDigit(char* buffer, int length, uint64_t dist, uint64_t delta, uint64_t rest, uint64_t tenk)
+{
+    while (rest < dist && delta - rest >= tenk &&
+           (rest + tenk < dist || dist - rest > rest + tenk - dist)) {
+        --buffer[length - 1];
+        rest += tenk;
+    }
+}
+
+// generate the digits of a number in [low, high] as close to w as possible
+static int generateDigits(char* buffer, int& decimalExponent, diyfp low, diyfp w, diyfp high)
+{
+    uint64_t delta = sub(high, low).f;
+    uint64_t dist = sub(high, w).f;
+
+    const diyfp one{uint64_t{1} << static_cast<unsigned int>(-high.e), high.e};
+    const auto shift = static_cast<unsigned int>(-one.e);
+    auto p1 = static_cast<uint32_t>(high.f >> shift);
+    uint64_t p2 = high.f & (one.f - 1);
+
+    int length = 0;
+    uint32_t pow10;
+    int n = largestPow10(p1, pow10);
+    while (n > 0) {
+        const uint32_t d = p1 / pow10;
+        p1 %= pow10;
+        buffer[length++] = static_cast<char>('0' + d);
+        --n;
+        const uint64_t rest = (static_cast<uint64_t>(p1) << shift) + p2;
+        if (rest <= delta) {
+            decimalExponent += n;
+            roundDigit(buffer, length, dist, delta, rest, static_cast<uint64_t>(pow10) << shift);
+            return length;
+        }
+        pow10 /= 10;
+    }
+    int m = 0;
+    while (true) {
+        p2 *= 10;
+        const uint64_t d = p2 >> shift;
+        p2 &= one.f - 1;
+        buffer[length++] = static_cast<char>('0' + d);
+        ++m;
+        delta *= 10;
+        dist *= 10;
+        if (p2 <= delta) {
+            break;
+        }
+    }
+    decimalExponent -= m;
+    roundDigit(buffer, length, dist, delta, p2, one.f);
+    return length;
+}
+
+/** generate the digits of a positive finite number,  they are the shortest digits that round trip in almost
+all cases
+@return the number of digits,  the number is digits*10^decimalExponent*/
+template<typename FLOAT, typename BITS>
+static int generateShortest(char* buffer, int& decimalExponent, FLOAT value)
+{
+    auto bounds = computeBoundaries<FLOAT, BITS>(value);
+    const cachedPower cached = getCachedPower(bounds.plus.e);
+    const diyfp c{cached.f, cached.e};
+    const diyfp w = mul(bounds.w, c);
+    const diyfp wminus = mul(bounds.minus, c);
+    const diyfp wplus = mul(bounds.plus, c);
+    // the products are accurate to 1 ulp so the interval is shrunk to stay inside the exact one
+    const diyfp low{wminus.f + 1, wminus.e};
+    const diyfp high{wplus.f - 1, wplus.e};
+    decimalExponent = -cached.k;
+    return generateDigits(buffer, decimalExponent, low, w, high);
+}
+
+// write a string if it fits
+static char* writeText(char* first, char* last, const char* text, size_t length)
+{
+    if (static_cast<size_t>(last - first) < length) {
+        return nullptr;
+    }
+    std::memcpy(first, text, length);
+    return first + length;
+}
+
+/** write a number given by its digits in plain notation if it is reasonably short and in exponent notation
+otherwise,  returns nullptr if it doesn't fit*/
+static char*
+    writeDigits(char* first, char* last, const char* digitText, int length, int decimalExponent)
+{
+    // the position of the decimal point relative to the first digit
+    const int point = length + decimalExponent;
+    const auto space = last - first;
+    if (length <= point && point <= 17) {
+        // digits[000]
+        if (space < point) {
+            return nullptr;
+        }
+        std::memcpy(first, digitText, static_cast<size_t>(length));
+        std::memset(first + length, '0', static_cast<size_t>(point - length));
+        return first + point;
+    }
+    if (0 < point && point <= 17) {
+        // dig.its
+        if (space < length + 1) {
+            return nullptr;
+        }
+        std::memcpy(first, digitText, static_cast<size_t>(point));
+        first[point] = '.';
+        std::memcpy(first + point + 1, digitText + point, static_cast<size_t>(length - point));
+        return first + length + 1;
+    }
+    if (-4 < point && point <= 0) {
+        // 0.[000]digits
+        if (space < 2 - point + length) {
+            return nullptr;
+        }
+        first[0] = '0';
+        first[1] = '.';
+        std::memset(first + 2, '0', static_cast<size_t>(-point));
+        std::memcpy(first + 2 - point, digitText, static_cast<size_t>(length));
+        return first + 2 - point + length;
+    }
+    // d.igitse[-]x
+    std::array<char, 8> exponent;
+    int expLength = 0;
+    int exp = point - 1;
+    bool negativeExp = (exp < 0);
+    exp = std::abs(exp);
+    do {
+        exponent[static_cast<size_t>(expLength++)] = static_cast<char>('0' + exp % 10);
+        exp /= 10;
+    } while (exp > 0);
+    const int mantissa = (length == 1) ? 1 : length + 1;
+    if (space < mantissa + 1 + (negativeExp ? 1 : 0) + expLength) {
+        return nullptr;
+    }
+    *first++ = digitText[0];
+    if (length > 1) {
+        *first++ = '.';
+        std::memcpy(first, digitText + 1, static_cast<size_t>(length - 1));
+        first += length - 1;
+    }
+    *first++ = 'e';
+    if (negativeExp) {
+        *first++ = '-';
+    }
+    while (expLength > 0) {
+        *first++ = exponent[static_cast<size_t>(--expLength)];
+    }
+    return first;
+}
+
+template<typename FLOAT, typename BITS>
+static char* format(char* first, char* last, FLOAT value)
+{
+    if (first == nullptr || last < first) {
+        return nullptr;
+    }
+    if (std::isnan(value)) {
+        return writeText(first, last, "nan", 3);
+    }
+    if (std::signbit(value)) {
+        if (first == last) {
+            return nullptr;
+        }
+        *first++ = '-';
+        value = -value;
+    }
+    if (std::isinf(value)) {
+        return writeText(first, last, "inf", 3);
+    }
+    if (value == FLOAT(0)) {
+        return writeText(first, last, "0", 1);
+    }
+    std::array<char, 24> digitText;
+    int decimalExponent;
+    int length = generateShortest<FLOAT, BITS>(digitText.data(), decimalExponent, value);
+    return writeDigits(first, last, digitText.data(), length, decimalExponent);
+}
+} // namespace shortest
+
+char* format_to(char* first, char* last, double value)
+{
+    return shortest::format<double, uint64_t>(first, last, value);
+}
+
+char* format_to(char* first, char* last, float value)
+{
+    return shortest::format<float, uint32_t>(first, last, value);
+}
+
+char* format_to(char* first, char* last, precise_unit units, uint32_t match_flags)
+{
+    if (first == nullptr || last < first) {
+        return nullptr;
+    }
+    auto& data = activeUnits();
+    if (data.useFormatCache.load() && isStableCommodityName(units.commodity())) {
+        char* end{nullptr};
+        auto write = [&end, first, last](const std::string& str) {
+            end = shortest::writeText(first, last, str.data(), str.size());
+        };
+        if (data.formatCache.visit(formatKey(units, match_flags), write)) {
+            return end;
+        }
+    }
+    auto str = to_string(units, match_flags);
+    return shortest::writeText(first, last, str.data(), str.size());
+}
+
+template<typename MEASUREMENT>
+static char*
+    formatMeasurement(char* first, char* last, const MEASUREMENT& measure, uint32_t match_flags)
+{
+    first = format_to(first, last, measure.value());
+    if (first == nullptr || first == last) {
+        return nullptr;
+    }
+    *first++ = ' ';
+    return format_to(first, last, measure.units(), match_flags);
+}
+
+char* format_to(char* first, char* last, precision_measurement measure, uint32_t match_flags)
+{
+    return formatMeasurement(first, last, measure, match_flags);
+}
+
+char* format_to(char* first, char* last, measurement measure, uint32_t match_flags)
+{
+    return formatMeasurement(first, last, measure, match_flags);
+}
+
+char* format_to(char* first, char* last, measurement_f measure, uint32_t match_flags)
+{
+    return formatMeasurement(first, last, measure, match_flags);
+}
+
 /// Generate the prefix multiplier for SI units
 static double getPrefixMultiplier(char p)
 {
@@ -1272,7 +2683,8 @@ bool clearEmptySegments(std::string& unit)
     }
     return changed;
 }
-// forward declaration of this function
+// forward declaration of these functions
+static precise_unit get_unit(const char* unit_string, size_t length);
 static precise_unit get_unit(const std::string& unit_string);
 
 inline bool ends_with(std::string const& value, std::string const& ending)
@@ -1408,6 +2820,258 @@ static bool wordModifiers(std::string& unit)
 }
 using ckpair = std::pair<const char*, const char*>;
 
+/** multi-pattern matcher (Aho-Corasick) for a table of replacement strings
+@details finds the occurrences of the patterns of a table in a single pass over the string and makes the
+replacements as it copies the string.  Bytes that do not appear in any pattern share one input class to keep
+the transition table small
+*/
+template<size_t N>
+class replacementMatcher {
+  public:
+    static_assert(N <= 64, "the pattern set is stored as a 64 bit mask");
+    explicit replacementMatcher(const std::array<ckpair, N>& replacements) : table(replacements)
+    {
+        for (size_t ii = 0; ii < N; ++ii) {
+            patternLength[ii] = strlen(table[ii].first);
+            replacementLength[ii] = strlen(table[ii].second);
+            maxLength = (std::max)(maxLength, patternLength[ii]);
+        }
+        for (size_t ii = 0; ii < N; ++ii) {
+            canFormPattern[ii] = formsPattern(ii);
+        }
+        classes.fill(0);
+        for (const auto& pattern : table) {
+            for (const char* ch = pattern.first; *ch != '\0'; ++ch) {
+                auto& cls = classes[static_cast<unsigned char>(*ch)];
+                if (cls == 0) {
+                    cls = static_cast<uint8_t>(classCount++);
+                }
+            }
+        }
+        // build the trie of the patterns
+        transitions.assign(classCount, 0);
+        matches.assign(1, 0);
+        for (size_t ii = 0; ii < N; ++ii) {
+            size_t state{0};
+            for (const char* ch = table[ii].first; *ch != '\0'; ++ch) {
+                auto index = state * classCount + classes[static_cast<unsigned char>(*ch)];
+                if (transitions[index] == 0) {
+                    transitions[index] = static_cast<uint16_t>(matches.size());
+                    transitions.resize(transitions.size() + classCount, 0);
+                    matches.push_back(0);
+                }
+                state = transitions[index];
+            }
+            matches[state] |= (uint64_t{1} << ii);
+        }
+        // convert the trie into a complete automaton following the failure links breadth first
+        std::vector<uint16_t> failure(matches.size(), 0);
+        std::vector<uint16_t> queue;
+        queue.reserve(matches.size());
+        for (size_t cc = 0; cc < classCount; ++cc) {
+            if (transitions[cc] != 0) {
+                queue.push_back(transitions[cc]);
+            }
+        }
+        for (size_t qq = 0; qq < queue.size(); ++qq) {
+            auto state = queue[qq];
+            matches[state] |= matches[failure[state]];
+            for (size_t cc = 0; cc < classCount; ++cc) {
+                auto& next = transitions[state * classCount + cc];
+                auto fallback = transitions[failure[state] * classCount + cc];
+                if (next != 0) {
+                    failure[next] = fallback;
+                    queue.push_back(next);
+                } else {
+                    next = fallback;
+                }
+            }
+        }
+    }
+    /// get a bit mask of the patterns that occur in a string
+    uint64_t find(const std::string& str) const
+    {
+        uint64_t found{0};
+        size_t state{0};
+        for (auto ch : str) {
+            state = transitions[state * classCount + classes[static_cast<unsigned char>(ch)]];
+            found |= matches[state];
+        }
+        return found;
+    }
+    /** replace the patterns of the table in a string
+    @details the result is the same as replacing every occurrence of each entry in table order
+    @param eraseEscapes remove a '\\' in front of a replaced pattern
+    @return true if any pattern was replaced*/
+    bool replace(std::string& str, bool eraseEscapes) const
+    {
+        return replaceInOnePass(str, eraseEscapes);
+    }
+    /** replace every occurrence of each entry in table order,  only the entries present are searched
+    @details this is the reference for replace and is used directly when the single pass cannot be used*/
+    bool replaceInTableOrder(std::string& str, bool eraseEscapes) const
+    {
+        bool changed{false};
+        auto present = find(str);
+        for (size_t ii = 0; ii < N && present != 0; ++ii) {
+            if ((present & (uint64_t{1} << ii)) == 0) {
+                continue;
+            }
+            auto fnd = str.find(table[ii].first);
+            while (fnd != std::string::npos) {
+                changed = true;
+                str.replace(fnd, patternLength[ii], table[ii].second);
+                if (eraseEscapes) {
+                    if (fnd > 0 && str[fnd - 1] == '\\') {
+                        str.erase(fnd - 1, 1);
+                        --fnd;
+                    }
+                    fnd = str.find(table[ii].first, fnd + replacementLength[ii]);
+                } else {
+                    fnd = str.find(table[ii].first, fnd + 1);
+                }
+            }
+            // a replacement can create or remove later patterns
+            present = find(str) & ~((uint64_t{2} << ii) - 1);
+        }
+        return changed;
+    }
+
+  private:
+    /// an occurrence of a pattern
+    struct occurrence {
+        size_t start;
+        size_t end;
+        size_t index;
+    };
+    /** replace the patterns with one pass to find them and one to copy the string
+    @details overlapping occurrences are resolved in table order,  the first entry in the table is replaced and
+    the occurrences it overlaps are left as they are.  Replacing the entries one after another can differ if a
+    replacement forms a new occurrence with the text around it,  such as "/sq.*" which becomes "/square*" and
+    then "/square",  those strings are left to replaceInTableOrder*/
+    bool replaceInOnePass(std::string& str, bool eraseEscapes) const
+    {
+        std::vector<occurrence> found = occurrences(str);
+        if (found.empty()) {
+            return false;
+        }
+        // claim the characters of the occurrences in table order
+        std::sort(
+            found.begin(), found.end(), [](const occurrence& occ1, const occurrence& occ2) {
+                return (occ1.index != occ2.index) ? (occ1.index < occ2.index) :
+                                                    (occ1.start < occ2.start);
+            });
+        std::vector<char> claimed(str.size(), 0);
+        std::vector<occurrence> chosen;
+        for (const auto& occ : found) {
+            if (std::find(claimed.begin() + occ.start, claimed.begin() + occ.end, 1) !=
+                claimed.begin() + occ.end) {
+                continue;
+            }
+            std::fill(claimed.begin() + occ.start, claimed.begin() + occ.end, 1);
+            chosen.push_back(occ);
+        }
+        std::sort(
+            chosen.begin(), chosen.end(), [](const occurrence& occ1, const occurrence& occ2) {
+                return occ1.start < occ2.start;
+            });
+        // copy the string with the replacements,  noting where the replacements that can be part of a
+        // pattern end up
+        std::string result;
+        result.reserve(str.size() + 8);
+        std::vector<occurrence> placed;
+        size_t copied{0};
+        for (size_t ii = 0; ii < chosen.size(); ++ii) {
+            const auto& occ = chosen[ii];
+            result.append(str, copied, occ.start - copied);
+            if (eraseEscapes && !result.empty() && result.back() == '\\') {
+                return replaceInTableOrder(str, eraseEscapes);
+            }
+            if (canFormPattern[occ.index]) {
+                // the text around the replacement must be text of the original string
+                if ((ii > 0 && chosen[ii - 1].end + maxLength > occ.start) ||
+                    (ii + 1 < chosen.size() && occ.end + maxLength > chosen[ii + 1].start)) {
+                    return replaceInTableOrder(str, eraseEscapes);
+                }
+                placed.push_back(occurrence{
+                    result.size(), result.size() + replacementLength[occ.index], occ.index});
+            }
+            result.append(table[occ.index].second, replacementLength[occ.index]);
+            copied = occ.end;
+        }
+        result.append(str, copied, std::string::npos);
+        // a replacement that is part of an occurrence in the result would be replaced again in table order
+        if (!placed.empty()) {
+            for (const auto& occ : occurrences(result)) {
+                for (const auto& region : placed) {
+                    bool overlaps = (region.start == region.end) ?
+                        (occ.start < region.start && occ.end > region.start) :
+                        (occ.start < region.end && occ.end > region.start);
+                    if (overlaps) {
+                        return replaceInTableOrder(str, eraseEscapes);
+                    }
+                }
+            }
+        }
+        str = std::move(result);
+        return true;
+    }
+    /// find all the occurrences of the patterns in a string
+    std::vector<occurrence> occurrences(const std::string& str) const
+    {
+        std::vector<occurrence> found;
+        size_t state{0};
+        for (size_t pos = 0; pos < str.size(); ++pos) {
+            state =
+                transitions[state * classCount + classes[static_cast<unsigned char>(str[pos])]];
+            auto mask = matches[state];
+            for (size_t ii = 0; mask != 0; ++ii, mask >>= 1U) {
+                if ((mask & 1U) != 0) {
+                    found.push_back(occurrence{pos + 1 - patternLength[ii], pos + 1, ii});
+                }
+            }
+        }
+        return found;
+    }
+    /// check if the replacement of an entry can be part of an occurrence of any pattern in some text
+    bool formsPattern(size_t index) const
+    {
+        const char* text = table[index].second;
+        auto length = static_cast<std::ptrdiff_t>(replacementLength[index]);
+        if (length == 0) {
+            // removing text joins the text on either side
+            return true;
+        }
+        for (size_t jj = 0; jj < N; ++jj) {
+            const char* pattern = table[jj].first;
+            auto plength = static_cast<std::ptrdiff_t>(patternLength[jj]);
+            // try every placement of the replacement overlapping the pattern
+            for (std::ptrdiff_t offset = 1 - length; offset < plength; ++offset) {
+                auto first = (std::max)(offset, std::ptrdiff_t{0});
+                auto last = (std::min)(offset + length, plength);
+                bool same{true};
+                for (auto pp = first; pp < last && same; ++pp) {
+                    same = (pattern[pp] == text[pp - offset]);
+                }
+                if (same) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    const std::array<ckpair, N>& table;
+    std::array<size_t, N> patternLength;
+    std::array<size_t, N> replacementLength;
+    std::array<bool, N> canFormPattern;
+    size_t maxLength{0};
+    std::array<uint8_t, 256> classes;
+    size_t classCount{1};
+    std::vector<uint16_t> transitions;
+    std::vector<uint64_t> matches;
+};
+
 static precise_unit localityModifiers(std::string unit, std::uint32_t match_flags)
 {
     static UPTCONST std::array<ckpair, 39> internationlReplacements{{
@@ -1514,11 +3178,13 @@ static std::pair<double, size_t> getPrefixMultiplierWord(const std::string& unit
     return {0.0, 0};
 }
 
+using unitpair = std::pair<const char*, precise_unit>;
+
 /** units from several locations
 http://vizier.u-strasbg.fr/vizier/doc/catstd-3.2.htx
 http://unitsofmeasure.org/ucum.html#si
 */
-static const smap base_unit_vals{
+static UPTCONST unitpair base_unit_vals[]{
     {"", precise::defunit},
     {"[]", precise::defunit},
     {"def", precise::defunit},
@@ -3462,6 +5128,65 @@ static const smap base_unit_vals{
     {"[PH]", precise::laboratory::pH},
 };
 
+static_assert(
+    sizeof(base_unit_vals) / sizeof(base_unit_vals[0]) == base_unit_index::count,
+    "base_unit_index.hpp is out of date, run scripts/generate_base_unit_index.py");
+
+// the content check needs C++14 constexpr and about 400000 operations of constant evaluation which is
+// within the default limits of gcc and clang, MSVC defaults to 100000 steps so it is skipped there
+#if __cplusplus >= 201402L && !defined(_MSC_VER)
+/// FNV-1a hash of all the strings in a table with their null terminators
+template<size_t N>
+static constexpr uint64_t tableStringHash(const unitpair (&table)[N])
+{
+    uint64_t hash{14695981039346656037ULL};
+    for (const auto& entry : table) {
+        const char* str = entry.first;
+        do {
+            hash = (hash ^ static_cast<unsigned char>(*str)) * 1099511628211ULL;
+        } while (*str++ != '\0');
+    }
+    return hash;
+}
+// catches a changed string when the number of entries is unchanged
+static_assert(
+    tableStringHash(base_unit_vals) == base_unit_index::tableHash,
+    "base_unit_index.hpp is out of date, run scripts/generate_base_unit_index.py");
+#endif
+
+/// FNV-1a hash of a string segment, used to index the unit string tables
+static uint64_t unitStringHash(const char* str, size_t length)
+{
+    uint64_t hash{14695981039346656037ULL};
+    for (size_t ii = 0; ii < length; ++ii) {
+        hash = (hash ^ static_cast<unsigned char>(str[ii])) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/** find a unit string in the base unit table, returns nullptr if not found
+@details the table is indexed by a hash and displace perfect hash generated offline (see
+base_unit_index.hpp), so a lookup is one hash, one slot read, and one string comparison
+*/
+static const precise_unit* findBaseUnit(const char* str, size_t length)
+{
+    auto hash = unitStringHash(str, length);
+    auto bucket = static_cast<size_t>(hash & (base_unit_index::bucketCount - 1));
+    auto disp = static_cast<uint64_t>(base_unit_index::displacement[bucket]);
+    auto slot = static_cast<size_t>(
+        ((hash >> 16U) + disp * (((hash >> 40U) << 1U) | 1U)) & (base_unit_index::slotCount - 1));
+    size_t entry = base_unit_index::slots[slot];
+    if (entry == 0) {
+        return nullptr;
+    }
+    --entry;
+    if (base_unit_index::lengths[entry] != length ||
+        (length > 0 && std::memcmp(base_unit_vals[entry].first, str, length) != 0)) {
+        return nullptr;
+    }
+    return &(base_unit_vals[entry].second);
+}
+
 // this function is pulled from elsewhere and the coverage is not important for error control
 // LCOV_EXCL_START
 // get a matching character for the sequence
@@ -3613,50 +5338,95 @@ static precise_unit commoditizedUnit(const std::string& unit_string, uint32_t ma
         return {1.0, precise::one, getCommodity(cstring)};
     }
 
-    auto bunit = unit_from_string_internal(
-        unit_string.substr(0, static_cast<size_t>(ccindex) + 1), match_flags + no_commodities);
+    auto bunit = unit_from_string_segment(
+        unit_string, 0, static_cast<size_t>(ccindex) + 1, match_flags + no_commodities);
     if (!is_error(bunit)) {
         return {1.0, bunit, getCommodity(cstring)};
     }
     return precise::invalid;
 }
 
-static precise_unit get_unit(const std::string& unit_string)
+// look up a unit in the base unit table or from the custom unit codes
+static precise_unit get_base_unit(const char* unit_string, size_t length)
 {
-    if (!user_defined_units.empty()) {
-        auto fnd2 = user_defined_units.find(unit_string);
-        if (fnd2 != user_defined_units.end()) {
-            return fnd2->second;
-        }
-    }
-    auto fnd = base_unit_vals.find(unit_string);
-    if (fnd != base_unit_vals.end()) {
-        return fnd->second;
+    const auto* fnd = findBaseUnit(unit_string, length);
+    if (fnd != nullptr) {
+        return *fnd;
     }
-    auto c = unit_string.front();
-    if ((c == 'C' || c == 'E') && unit_string.size() >= 6) {
+    if (length >= 6 && (unit_string[0] == 'C' || unit_string[0] == 'E')) {
+        std::string ustring(unit_string, length);
         size_t index;
         // we want to make sure there are no operations before the commodity
-        if (unit_string.find_last_of("*^(/", unit_string.find_last_of('{')) == std::string::npos) {
-            if (unit_string.compare(0, 5, "CXUN[") == 0) {
-                auto num = static_cast<unsigned short>(atoi(unit_string.c_str() + 5));
-                return commoditizedUnit(unit_string, precise::generate_custom_unit(num), index);
+        if (ustring.find_last_of("*^(/", ustring.find_last_of('{')) == std::string::npos) {
+            if (ustring.compare(0, 5, "CXUN[") == 0) {
+                auto num = static_cast<unsigned short>(atoi(ustring.c_str() + 5));
+                return commoditizedUnit(ustring, precise::generate_custom_unit(num), index);
             }
-            if (unit_string.compare(0, 6, "CXCUN[") == 0) {
-                auto num = static_cast<unsigned short>(atoi(unit_string.c_str() + 6));
-                return commoditizedUnit(
-                    unit_string, precise::generate_custom_count_unit(num), index);
+            if (ustring.compare(0, 6, "CXCUN[") == 0) {
+                auto num = static_cast<unsigned short>(atoi(ustring.c_str() + 6));
+                return commoditizedUnit(ustring, precise::generate_custom_count_unit(num), index);
             }
-            if (unit_string.compare(0, 6, "EQXUN[") == 0) {
-                auto num = static_cast<unsigned short>(atoi(unit_string.c_str() + 6));
+            if (ustring.compare(0, 6, "EQXUN[") == 0) {
+                auto num = static_cast<unsigned short>(atoi(ustring.c_str() + 6));
                 return commoditizedUnit(
-                    unit_string, precise_unit(precise::custom::equation_unit(num)), index);
+                    ustring, precise_unit(precise::custom::equation_unit(num)), index);
             }
         }
     }
     return precise::invalid;
 }
 
+// get a unit from a segment of a string, a copy is only made if user defined units are present
+static precise_unit get_unit(const char* unit_string, size_t length)
+{
+    if (!allowParseProbe()) {
+        return precise::invalid;
+    }
+    const auto* registry = userUnits();
+    if (registry != nullptr) {
+        auto fnd2 = registry->units.find(std::string(unit_string, length));
+        if (fnd2 != registry->units.end()) {
+            return fnd2->second;
+        }
+    }
+    return get_base_unit(unit_string, length);
+}
+
+static precise_unit get_unit(const std::string& unit_string)
+{
+    if (!allowParseProbe()) {
+        return precise::invalid;
+    }
+    const auto* registry = userUnits();
+    if (registry != nullptr) {
+        auto fnd2 = registry->units.find(unit_string);
+        if (fnd2 != registry->units.end()) {
+            return fnd2->second;
+        }
+    }
+    return get_base_unit(unit_string.c_str(), unit_string.size());
+}
+
+/** convert a segment of a unit string,  a direct match is checked in place before making a substring for the
+full conversion*/
+static precise_unit unit_from_string_segment(
+    const std::string& unit_string,
+    size_t start,
+    size_t length,
+    uint32_t match_flags)
+{
+    if (length == 0) {
+        return precise::one;
+    }
+    if ((match_flags & case_insensitive) == 0) {
+        auto retunit = get_unit(unit_string.c_str() + start, length);
+        if (is_valid(retunit)) {
+            return retunit;
+        }
+    }
+    return unit_from_string_internal(unit_string.substr(start, length), match_flags);
+}
+
 // Detect if a string looks like a number
 static bool looksLikeNumber(const std::string& string, size_t index)
 {
@@ -3748,16 +5518,22 @@ static void removeOuterParenthesis(std::string& ustring)
 }
 
 // Find the last multiply or divide operation in a string
-static size_t findOperatorSep(const std::string& ustring, std::string operators)
+static size_t findOperatorSep(const std::string& ustring, const char* operators)
 {
-    operators.append(")}]");
-    auto sep = ustring.find_last_of(operators);
+    // the operators plus the segment terminators,  a fixed buffer avoids building a string on each call
+    std::array<char, 8> opchars{};
+    auto oplen = strlen(operators);
+    std::copy(operators, operators + oplen, opchars.begin());
+    std::copy_n(")}]", 3, opchars.begin() + oplen);
+    const char* ops = opchars.data();
+
+    auto sep = ustring.find_last_of(ops);
 
     while (sep != std::string::npos && sep > 0 &&
            (ustring[sep] == ')' || ustring[sep] == '}' || ustring[sep] == ']')) {
         int index = static_cast<int>(sep) - 1;
         segmentcheckReverse(ustring, getMatchCharacter(ustring[sep]), index);
-        sep = (index > 0) ? ustring.find_last_of(operators, index) : std::string::npos;
+        sep = (index > 0) ? ustring.find_last_of(ops, index) : std::string::npos;
     }
     if (sep == 0) {
         // this should not happen
@@ -3769,11 +5545,12 @@ static size_t findOperatorSep(const std::string& ustring, std::string operators)
 }
 
 // find the next word operator adjusting for parenthesis and brackets and braces
-static size_t findWordOperatorSep(const std::string& ustring, const std::string& keyword)
+static size_t findWordOperatorSep(const std::string& ustring, const char* keyword)
 {
+    const size_t keysize = strlen(keyword);
     auto sep = ustring.rfind(keyword);
-    if (ustring.size() > sep + keyword.size() + 1) {
-        auto keychar = ustring[sep + keyword.size()];
+    if (ustring.size() > sep + keysize + 1) {
+        auto keychar = ustring[sep + keysize];
         while (keychar == '^' || keychar == '*' || keychar == '/') {
             if (sep == 0) {
                 sep = std::string::npos;
@@ -3783,7 +5560,7 @@ static size_t findWordOperatorSep(const std::string& ustring, const std::string&
             if (sep == std::string::npos) {
                 break;
             }
-            keychar = ustring[sep + keyword.size()];
+            keychar = ustring[sep + keysize];
         }
     }
     size_t findex = ustring.size();
@@ -3912,14 +5689,110 @@ static void ciConversion(std::string& unit_string)
             }
         }
     }
-    auto loc = unit_string.find("/S");
-    if (loc != std::string::npos) {
-        unit_string[loc + 1] = 's';
+    auto loc = unit_string.find("/S");
+    if (loc != std::string::npos) {
+        unit_string[loc + 1] = 's';
+    }
+    loc = unit_string.find("/G");
+    if (loc != std::string::npos) {
+        unit_string[loc + 1] = 'g';
+    }
+}
+
+/// check if a case insensitive string can be read as a UCUM case insensitive prefix and a unit
+static bool isPrefixedCaseInsensitiveUnit(const std::string& ci_string)
+{
+    static UPTCONST std::array<const char*, 20> ciPrefixes{
+        {"YA", "ZA", "EX", "PT", "TR", "GA", "MA", "K", "H", "DA",
+         "D",  "C",  "M",  "U",  "N",  "P",  "F",  "A", "ZO", "YO"}};
+    for (const auto* prefix : ciPrefixes) {
+        auto length = std::strlen(prefix);
+        if (ci_string.size() <= length ||
+            !std::equal(prefix, prefix + length, ci_string.begin(), [](char pc, char sc) {
+                return pc == static_cast<char>(::toupper(static_cast<unsigned char>(sc)));
+            })) {
+            continue;
+        }
+        auto remainder = ci_string.substr(length);
+        if (findBaseUnit(remainder.c_str(), remainder.size()) != nullptr) {
+            return true;
+        }
+        ciConversion(remainder);
+        if (findBaseUnit(remainder.c_str(), remainder.size()) != nullptr) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** generate an index of the base unit strings under their case insensitive form
+@details the index is built from the base unit table alone.  The key for each unit string is the
+result of ciConversion.  A string is left out if the conversion turns one of its upper case
+characters into lower case,  since in case insensitive codes that character has the lower case
+meaning (M is milli and P is pico in UCUM).  Keys that are unit strings themselves are matched
+directly.  Keys that read as a UCUM prefix and a unit, or are shared by strings defining different
+units, are ambiguous and are left out,  as are keys of 1 or 2 characters which would turn into
+factors of a product
+*/
+static std::unordered_map<std::string, precise_unit> generateCaseInsensitiveIndex()
+{
+    std::unordered_map<std::string, precise_unit> index;
+    std::vector<std::string> ambiguous;
+    for (const auto& entry : base_unit_vals) {
+        std::string key(entry.first);
+        if (key.size() <= 2 || !is_valid(entry.second)) {
+            continue;
+        }
+        ciConversion(key);
+        if (key.size() != std::strlen(entry.first) ||
+            findBaseUnit(key.c_str(), key.size()) != nullptr) {
+            continue;
+        }
+        bool consistent{true};
+        for (size_t ii = 0; ii < key.size(); ++ii) {
+            if (key[ii] != entry.first[ii] && (entry.first[ii] < 'a' || entry.first[ii] > 'z')) {
+                consistent = false;
+                break;
+            }
+        }
+        if (!consistent) {
+            continue;
+        }
+        auto fnd = index.find(key);
+        if (fnd == index.end()) {
+            index.emplace(key, entry.second);
+        } else if (fnd->second != entry.second) {
+            ambiguous.push_back(key);
+        }
+    }
+    for (const auto& entry : index) {
+        if (isPrefixedCaseInsensitiveUnit(entry.first)) {
+            ambiguous.push_back(entry.first);
+        }
     }
-    loc = unit_string.find("/G");
-    if (loc != std::string::npos) {
-        unit_string[loc + 1] = 'g';
+    for (const auto& key : ambiguous) {
+        index.erase(key);
+    }
+    return index;
+}
+
+// check if a string has any upper case characters
+static bool containsUpperCase(const std::string& str)
+{
+    return std::any_of(str.begin(), str.end(), [](char c) { return c >= 'A' && c <= 'Z'; });
+}
+
+/** match a token the case insensitive conversion did not resolve against the case insensitive index
+@param ci_string the token in its case insensitive form
+@return the unit of the index entry or precise::invalid*/
+static precise_unit caseInsensitiveIndexMatch(const std::string& ci_string)
+{
+    static const auto ciIndex = generateCaseInsensitiveIndex();
+    if (!allowParseProbe()) {
+        return precise::invalid;
     }
+    auto fnd = ciIndex.find(ci_string);
+    return (fnd != ciIndex.end()) ? fnd->second : precise::invalid;
 }
 
 // run a few checks on the string to verify it looks somewhat valid
@@ -4142,8 +6015,8 @@ static void htmlCodeReplacement(std::string& unit_string)
     }
 }
 
-/// do some unicode replacement (unicode in the loose sense any characters not in the basic ascii set)
-static bool unicodeReplacement(std::string& unit_string)
+/// the replacements of unicode characters and their matcher
+static const replacementMatcher<45>& unicodeMatcher()
 {
     static UPTCONST std::array<ckpair, 45> ucodeReplacements{{
         ckpair{u8"\u00d7", "*"},
@@ -4192,29 +6065,20 @@ static bool unicodeReplacement(std::string& unit_string)
         ckpair{"\xBC", "(0.25)"}, //(1/4) fraction
         ckpair{"\xBE", "(0.75)"}, //(3/4) fraction
     }};
-    bool changed{false};
-    for (auto& ucode : ucodeReplacements) {
-        auto fnd = unit_string.find(ucode.first);
-        while (fnd != std::string::npos) {
-            changed = true;
-            unit_string.replace(fnd, strlen(ucode.first), ucode.second);
-            if (fnd > 0 && unit_string[fnd - 1] == '\\') {
-                unit_string.erase(fnd - 1, 1);
-                --fnd;
-            }
-            fnd = unit_string.find(ucode.first, fnd + strlen(ucode.second));
-        }
-    }
-    return changed;
+    static const replacementMatcher<45> ucodeMatcher(ucodeReplacements);
+    return ucodeMatcher;
 }
 
-// do some cleaning on the unit string to standardize formatting and deal with some extended ascii and unicode
-// characters
-static bool cleanUnitString(std::string& unit_string, uint32_t match_flags)
+/// do some unicode replacement (unicode in the loose sense any characters not in the basic ascii set)
+static bool unicodeReplacement(std::string& unit_string)
 {
-    auto slen = unit_string.size();
-    bool skipcodereplacement = ((match_flags & skip_code_replacements) != 0);
+    // an escaped character is replaced along with its escape
+    return unicodeMatcher().replace(unit_string, true);
+}
 
+/// the replacements of abbreviations and other problematic codes and their matcher
+static const replacementMatcher<25>& codeMatcher()
+{
     static UPTCONST std::array<ckpair, 25> allCodeReplacements{{
         ckpair{"sq.", "square"},
         ckpair{"cu.", "cubic"},
@@ -4247,6 +6111,37 @@ static bool cleanUnitString(std::string& unit_string, uint32_t match_flags)
         ckpair{"degrees", "deg"},
         ckpair{"degree", "deg"},
     }};
+    static const replacementMatcher<25> allCodeMatcher(allCodeReplacements);
+    return allCodeMatcher;
+}
+
+namespace detail {
+    namespace testing {
+        // check the single pass replacements of both tables against replacing in table order
+        bool testCodeReplacements(const std::string& test)
+        {
+            std::string onePass(test);
+            std::string tableOrder(test);
+            bool changed = unicodeMatcher().replace(onePass, true);
+            if (changed != unicodeMatcher().replaceInTableOrder(tableOrder, true) ||
+                onePass != tableOrder) {
+                return false;
+            }
+            onePass = test;
+            tableOrder = test;
+            changed = codeMatcher().replace(onePass, false);
+            return (changed == codeMatcher().replaceInTableOrder(tableOrder, false)) &&
+                (onePass == tableOrder);
+        }
+    } // namespace testing
+} // namespace detail
+
+// do some cleaning on the unit string to standardize formatting and deal with some extended ascii and unicode
+// characters
+static bool cleanUnitString(std::string& unit_string, uint32_t match_flags)
+{
+    auto slen = unit_string.size();
+    bool skipcodereplacement = ((match_flags & skip_code_replacements) != 0);
 
     static const std::string spchar = std::string(" \t\n\r") + '\0';
     bool changed = false;
@@ -4354,13 +6249,8 @@ static bool cleanUnitString(std::string& unit_string, uint32_t match_flags)
             htmlCodeReplacement(unit_string);
         }
         // some abbreviations and other problematic code replacements
-        for (auto& acode : allCodeReplacements) {
-            auto fnd = unit_string.find(acode.first);
-            while (fnd != std::string::npos) {
-                changed = true;
-                unit_string.replace(fnd, strlen(acode.first), acode.second);
-                fnd = unit_string.find(acode.first, fnd + 1);
-            }
+        if (codeMatcher().replace(unit_string, false)) {
+            changed = true;
         }
     }
     if (unit_string.size() >= 2) {
@@ -4549,29 +6439,31 @@ static bool cleanUnitStringPhase2(std::string& unit_string)
     return (len != unit_string.length());
 }
 
-static precise_unit unit_quick_match(std::string unit_string, uint32_t match_flags)
+static precise_unit
+    unit_quick_match(const char* unit_string, size_t length, uint32_t match_flags)
 {
     if ((match_flags & case_insensitive) !=
         0) { // if not a ci matching process just do a quick scan first
-        cleanUnitString(unit_string, match_flags);
+        // the cleaning rewrites the string so it needs a copy
+        std::string ustring(unit_string, length);
+        cleanUnitString(ustring, match_flags);
+        return unit_quick_match(ustring.c_str(), ustring.size(), match_flags & (~case_insensitive));
     }
-    auto retunit = get_unit(unit_string);
+    auto retunit = get_unit(unit_string, length);
     if (is_valid(retunit)) {
         return retunit;
     }
-    if (unit_string.size() > 2 &&
-        unit_string.back() ==
+    if (length > 2 &&
+        unit_string[length - 1] ==
             's') { // if the string is of length two this is too risky to try since there would be many incorrect matches
-        unit_string.pop_back();
-        retunit = get_unit(unit_string);
+        retunit = get_unit(unit_string, length - 1);
         if (is_valid(retunit)) {
             return retunit;
         }
-    } else if (unit_string.front() == '[' && unit_string.back() == ']') {
-        unit_string.pop_back();
-        if (unit_string.back() != 'U' && unit_string.back() != 'u') {
-            unit_string.erase(unit_string.begin());
-            retunit = get_unit(unit_string);
+    } else if (length >= 2 && unit_string[0] == '[' && unit_string[length - 1] == ']') {
+        auto last = unit_string[length - 2];
+        if (last != 'U' && last != 'u') {
+            retunit = get_unit(unit_string + 1, length - 2);
             if (is_valid(retunit)) {
                 return retunit;
             }
@@ -4579,15 +6471,47 @@ static precise_unit unit_quick_match(std::string unit_string, uint32_t match_fla
     }
     return precise::invalid;
 }
+
+static precise_unit unit_quick_match(const std::string& unit_string, uint32_t match_flags)
+{
+    return unit_quick_match(unit_string.c_str(), unit_string.size(), match_flags);
+}
+
+/// generate the trie of the strings in the base unit table
+static unitPrefixTrie generateBaseUnitTrie()
+{
+    unitPrefixTrie trie;
+    for (size_t ii = 0; ii < base_unit_index::count; ++ii) {
+        trie.insert(base_unit_vals[ii].first, base_unit_index::lengths[ii]);
+    }
+    return trie;
+}
+
+/** get flags for the lengths of the leading substrings of a string that are a base or user defined unit
+@param unit_string the string to check
+@param first the character to use in place of the first character of the string
+*/
+static std::vector<bool> getUnitPrefixMatches(const std::string& unit_string, char first)
+{
+    static const unitPrefixTrie base_unit_trie = generateBaseUnitTrie();
+    std::vector<bool> matches(unit_string.size() + 1, false);
+    base_unit_trie.markPrefixes(unit_string, first, matches);
+    const auto* registry = userUnits();
+    if (registry != nullptr) {
+        registry->trie.markPrefixes(unit_string, first, matches);
+    }
+    return matches;
+}
 /** Under the assumption units were mashed together to for some new work or spaces were used as multiplies
 this function will progressively try to split apart units and combine them.
 */
 static precise_unit tryUnitPartitioning(const std::string& unit_string, uint32_t match_flags)
 {
-    std::string ustring = unit_string;
+    std::string ustring;
     // lets try checking for meter next which is one of the most common reasons for getting here
     auto fnd = findWordOperatorSep(unit_string, "meter");
     if (fnd != std::string::npos) {
+        ustring = unit_string;
         ustring.erase(fnd, 5);
         auto bunit = unit_from_string_internal(ustring, match_flags);
         if (is_valid(bunit)) {
@@ -4596,16 +6520,16 @@ static precise_unit tryUnitPartitioning(const std::string& unit_string, uint32_t
     }
     // detect another somewhat common situation often amphour or ampsecond
     if (unit_string.compare(0, 3, "amp") == 0) {
-        auto bunit = unit_from_string_internal(unit_string.substr(3), match_flags);
+        auto bunit =
+            unit_from_string_segment(unit_string, 3, unit_string.size() - 3, match_flags);
         if (is_valid(bunit)) {
             return precise::A * bunit;
         }
     }
     auto mret = getPrefixMultiplierWord(unit_string);
     if (mret.first != 0.0) {
-        ustring = unit_string.substr(mret.second);
-
-        auto retunit = unit_from_string_internal(ustring, match_flags);
+        auto retunit = unit_from_string_segment(
+            unit_string, mret.second, unit_string.size() - mret.second, match_flags);
         if (is_valid(retunit)) {
             return {mret.first, retunit};
         }
@@ -4620,20 +6544,41 @@ static precise_unit tryUnitPartitioning(const std::string& unit_string, uint32_t
         part = 1;
         ustring.pop_back();
     }
+    // the leading substrings that are units are found in a single pass so only those need to be checked,
+    // commodity codes and case insensitive matching use the full check
+    bool usePrefixes = ((match_flags & case_insensitive) == 0) && unit_string.front() != 'C' &&
+        unit_string.front() != 'E';
+    std::vector<bool> prefixes;
+    std::vector<bool> lowerPrefixes;
+    if (usePrefixes) {
+        prefixes = getUnitPrefixMatches(unit_string, unit_string.front());
+        if (unit_string.front() >= 'A' && unit_string.front() <= 'Z') {
+            lowerPrefixes = getUnitPrefixMatches(unit_string, unit_string.front() + 32);
+        }
+    }
+    auto possibleMatch = [&](const std::string& segment) {
+        if (!usePrefixes || segment.size() != part || segment.front() == '[') {
+            return true;
+        }
+        const auto& matches = (segment.front() == unit_string.front()) ? prefixes : lowerPrefixes;
+        return matches[part] || (part > 2 && segment.back() == 's' && matches[part - 1]);
+    };
     std::vector<std::string> valid;
     while (part < unit_string.size() - 1) {
-        auto res = unit_quick_match(ustring, match_flags);
+        auto res = possibleMatch(ustring) ? unit_quick_match(ustring, match_flags) : precise::invalid;
         if (!is_valid(res) && ustring.size() >= 3) {
             if (ustring.front() >= 'A' &&
                 ustring.front() <=
                     'Z') { // check the lower case version since we skipped partitioning when we did this earlier
                 ustring[0] += 32;
-                res = unit_quick_match(ustring, match_flags);
+                if (possibleMatch(ustring)) {
+                    res = unit_quick_match(ustring, match_flags);
+                }
             }
         }
         if (is_valid(res)) {
-            auto bunit = unit_from_string_internal(
-                unit_string.substr(part), match_flags | skip_partition_check);
+            auto bunit = unit_from_string_segment(
+                unit_string, part, unit_string.size() - part, match_flags | skip_partition_check);
             if (is_valid(bunit)) {
                 return res * bunit;
             }
@@ -4662,7 +6607,7 @@ static precise_unit tryUnitPartitioning(const std::string& unit_string, uint32_t
         }
     }
     // now do a quick check with a 2 character string since we skipped that earlier
-    auto qm2 = unit_quick_match(unit_string.substr(0, 2), match_flags);
+    auto qm2 = unit_quick_match(unit_string.c_str(), 2, match_flags);
     if (is_valid(qm2)) {
         valid.insert(valid.begin(), unit_string.substr(0, 2));
     }
@@ -4670,12 +6615,18 @@ static precise_unit tryUnitPartitioning(const std::string& unit_string, uint32_t
     if (unit_string.front() == 'V' || unit_string.front() == 'A') {
         valid.insert(valid.begin(), unit_string.substr(0, 1));
     }
-    // start with the biggest
+    // start with the biggest, a remainder is only converted once
     std::reverse(valid.begin(), valid.end());
+    std::vector<size_t> checked;
     for (auto& vd : valid) {
+        if (std::find(checked.begin(), checked.end(), vd.size()) != checked.end()) {
+            continue;
+        }
+        checked.push_back(vd.size());
         auto res = unit_quick_match(vd, match_flags);
 
-        auto bunit = unit_from_string_internal(unit_string.substr(vd.size()), match_flags);
+        auto bunit = unit_from_string_segment(
+            unit_string, vd.size(), unit_string.size() - vd.size(), match_flags);
         if (is_valid(bunit)) {
             return res * bunit;
         }
@@ -4724,11 +6675,403 @@ static precise_unit checkForCustomUnit(const std::string& unit_string)
     return precise::invalid;
 }
 
+static precise_unit unit_from_string_cached(std::string unit_string, uint32_t match_flags)
+{
+    auto& data = activeUnits();
+    if (data.useCache.load()) {
+        unitStringKey key{std::move(unit_string), match_flags};
+        precise_unit retunit;
+        if (data.cache.find(key, retunit)) {
+            recordParseStage(parse_stage::cached, retunit);
+            return retunit;
+        }
+        auto generation = data.cache.generation();
+        retunit = unit_from_string_internal(key.unit_string, match_flags);
+        // a conversion cut off by the budget is not a real result
+        if (activeSession == nullptr || !activeSession->exceeded) {
+            data.cache.insert(std::move(key), retunit, generation);
+        }
+        return retunit;
+    }
+    return unit_from_string_internal(std::move(unit_string), match_flags);
+}
+
 precise_unit unit_from_string(std::string unit_string, uint32_t match_flags)
 {
     // always allow the code replacements on first run
     match_flags &= (~skip_code_replacements);
-    return unit_from_string_internal(std::move(unit_string), match_flags);
+    if (activeSession != nullptr) {
+        // a nested conversion is limited by the session it is part of
+        return unit_from_string_cached(std::move(unit_string), match_flags);
+    }
+    parseSessionScope scope(unit_string, true, getParseBudget());
+    return scope.finish(unit_from_string_cached(std::move(unit_string), match_flags));
+}
+
+precise_unit
+    unit_from_string(std::string unit_string, const parse_budget& budget, uint32_t match_flags)
+{
+    match_flags &= (~skip_code_replacements);
+    if (activeSession != nullptr) {
+        // a nested conversion is limited by the session it is part of
+        return unit_from_string_cached(std::move(unit_string), match_flags);
+    }
+    parseSessionScope scope(unit_string, true, budget);
+    return scope.finish(unit_from_string_cached(std::move(unit_string), match_flags));
+}
+
+namespace {
+/// a string in a column given by its pointer and length, used to deduplicate strings without copying them
+struct textKey {
+    const char* str;
+    size_t length;
+    bool operator==(const textKey& other) const
+    {
+        return length == other.length && std::memcmp(str, other.str, length) == 0;
+    }
+};
+struct textKeyHash {
+    size_t operator()(const textKey& key) const
+    {
+        uint64_t hash{14695981039346656037ULL};
+        for (size_t ii = 0; ii < key.length; ++ii) {
+            hash = (hash ^ static_cast<unsigned char>(key.str[ii])) * 1099511628211ULL;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+} // namespace
+
+void unit_from_string_batch(
+    const char* const* unit_strings,
+    const size_t* lengths,
+    precise_unit* units,
+    size_t size,
+    uint32_t match_flags)
+{
+    // the number of distinct strings needed before spreading the conversion over multiple threads
+    static constexpr size_t parallelThreshold{128};
+    // the number of strings a thread claims at a time
+    static constexpr size_t chunkSize{16};
+
+    std::unordered_map<textKey, size_t, textKeyHash> index;
+    std::vector<textKey> distinct;
+    std::vector<size_t> rowIndex(size);
+    for (size_t ii = 0; ii < size; ++ii) {
+        textKey key{unit_strings[ii], lengths[ii]};
+        auto res = index.emplace(key, distinct.size());
+        if (res.second) {
+            distinct.push_back(key);
+        }
+        rowIndex[ii] = res.first->second;
+    }
+
+    std::vector<precise_unit> results(distinct.size());
+    auto convertDistinct = [&](size_t ii) {
+        results[ii] =
+            unit_from_string(std::string(distinct[ii].str, distinct[ii].length), match_flags);
+    };
+    size_t threadCount = std::thread::hardware_concurrency();
+    if (threadCount > distinct.size() / parallelThreshold) {
+        threadCount = distinct.size() / parallelThreshold;
+    }
+    if (threadCount <= 1) {
+        for (size_t ii = 0; ii < distinct.size(); ++ii) {
+            convertDistinct(ii);
+        }
+    } else {
+        std::atomic<size_t> next{0};
+        std::mutex errorLock;
+        std::exception_ptr workerError;
+        auto worker = [&]() {
+            try {
+                size_t start = next.fetch_add(chunkSize);
+                while (start < distinct.size()) {
+                    auto finish = (std::min)(start + chunkSize, distinct.size());
+                    for (size_t ii = start; ii < finish; ++ii) {
+                        convertDistinct(ii);
+                    }
+                    start = next.fetch_add(chunkSize);
+                }
+            }
+            catch (...) {
+                // stop the other threads at their next chunk
+                next.store(distinct.size());
+                std::lock_guard<std::mutex> guard(errorLock);
+                if (!workerError) {
+                    workerError = std::current_exception();
+                }
+            }
+        };
+        // the conversions on the other threads use the context of the calling thread
+        const auto* ctx = context::current();
+        std::vector<std::thread> workers;
+        workers.reserve(threadCount - 1);
+        try {
+            for (size_t ii = 1; ii < threadCount; ++ii) {
+                workers.emplace_back([&worker, ctx]() {
+                    if (ctx != nullptr) {
+                        context::scope active(*ctx);
+                        worker();
+                    } else {
+                        worker();
+                    }
+                });
+            }
+        }
+        catch (...) {
+            // the threads that started finish the work
+        }
+        worker();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+        if (workerError) {
+            std::rethrow_exception(workerError);
+        }
+    }
+    for (size_t ii = 0; ii < size; ++ii) {
+        units[ii] = results[rowIndex[ii]];
+    }
+}
+
+void unit_from_string_batch(
+    const std::string* unit_strings,
+    precise_unit* units,
+    size_t size,
+    uint32_t match_flags)
+{
+    std::vector<const char*> strings(size);
+    std::vector<size_t> lengths(size);
+    for (size_t ii = 0; ii < size; ++ii) {
+        strings[ii] = unit_strings[ii].data();
+        lengths[ii] = unit_strings[ii].size();
+    }
+    unit_from_string_batch(strings.data(), lengths.data(), units, size, match_flags);
+}
+
+// check if cleanUnitString would insert a '^' before a trailing 2 or 3 of a token with no operators
+// or '+' signs in it
+static bool trailingPowerInsertion(const char* str, size_t length)
+{
+    if (length < 2 || (str[length - 1] != '2' && str[length - 1] != '3')) {
+        return false;
+    }
+    switch (str[length - 2]) {
+        case '^':
+        case 'e':
+        case 'E':
+        case '-':
+            return false;
+        default:
+            return !isDigitCharacter(str[length - 2]);
+    }
+}
+
+// evaluate a single token the same way the recursive split of the string would evaluate it. A known
+// unit or a known unit raised to a single digit power is handled directly,  anything else goes through
+// the full conversion process
+static precise_unit tokenUnit(
+    const std::string& unit_string,
+    size_t start,
+    size_t length,
+    bool powerInserted,
+    uint32_t match_flags)
+{
+    const char* str = unit_string.c_str() + start;
+    std::string powerToken;
+    if (powerInserted) {
+        // the trailing power was inserted before the token was split off
+        powerToken.assign(str, length - 1);
+        powerToken.push_back('^');
+        powerToken.push_back(str[length - 1]);
+        str = powerToken.c_str();
+        length = powerToken.size();
+    }
+    auto retunit = get_unit(str, length);
+    if (is_valid(retunit)) {
+        return retunit;
+    }
+    if (isNumericalCharacter(str[0])) {
+        return (powerInserted) ?
+            unit_from_string_internal(powerToken, match_flags) :
+            unit_from_string_internal(unit_string.substr(start, length), match_flags);
+    }
+    const char* pstr = str;
+    size_t plength = length;
+    std::string cleanToken;
+    if (trailingPowerInsertion(str, length)) {
+        cleanToken.assign(str, length - 1);
+        cleanToken.push_back('^');
+        cleanToken.push_back(str[length - 1]);
+        retunit = get_unit(cleanToken);
+        if (is_valid(retunit)) {
+            return retunit;
+        }
+        pstr = cleanToken.c_str();
+        plength = cleanToken.size();
+    }
+    int power{0};
+    size_t baseLength{0};
+    if (plength >= 3 && pstr[plength - 2] == '^' && isDigitCharacter(pstr[plength - 1])) {
+        power = pstr[plength - 1] - '0';
+        baseLength = plength - 2;
+    } else if (
+        plength >= 4 && pstr[plength - 3] == '^' && pstr[plength - 2] == '-' &&
+        isDigitCharacter(pstr[plength - 1])) {
+        power = -(pstr[plength - 1] - '0');
+        baseLength = plength - 3;
+    }
+    if (baseLength > 0 && pstr[baseLength - 1] != '^') {
+        retunit = get_unit(pstr, baseLength);
+        if (is_valid(retunit)) {
+            if (power == 1) {
+                return retunit;
+            }
+            return (power == -1) ? retunit.inv() : retunit.pow(power);
+        }
+    }
+    return (powerInserted) ? unit_from_string_internal(powerToken, match_flags) :
+                             unit_from_string_internal(unit_string.substr(start, length), match_flags);
+}
+
+/** convert a flat sequence of tokens separated by '*' and '/' in a single pass
+@details this is a narrow fast path in front of the recursive split at the last operator,  not a parser.
+The string is tokenized once and the tokens are combined left to right,  only tokens that are not a known
+unit or a simple power of one go through the full conversion process.  The result is the same as
+splitting the string at the last operator and recursing,  including checking the leading sequences of
+tokens against the unit tables first and the power insertion the cleaning does for a trailing digit.
+Anything else,  parentheses, braces, numbers, spaces, signs, case insensitive matching or features the
+cleaning of a partial string would alter,  is left to the recursive process.  The skip_token_sequence flag
+turns it off,  which the tests use to compare the two
+@return true if the string was handled and result contains the unit
+*/
+static bool unit_from_token_sequence(
+    const std::string& unit_string,
+    uint32_t match_flags,
+    precise_unit& result)
+{
+    static constexpr size_t maxOperators{32};
+    if ((match_flags & (case_insensitive | skip_token_sequence)) != 0) {
+        return false;
+    }
+    // position of each operator, the tokens lie between them
+    std::array<size_t, maxOperators + 1> ops;
+    size_t opCount{0};
+    bool inBracket{false};
+    char prev{'\0'};
+    for (size_t ii = 0; ii < unit_string.size(); ++ii) {
+        char current = unit_string[ii];
+        switch (current) {
+            case '[':
+                if (inBracket) {
+                    return false;
+                }
+                inBracket = true;
+                break;
+            case ']':
+                if (!inBracket) {
+                    return false;
+                }
+                inBracket = false;
+                break;
+            case '*':
+            case '/':
+                if (inBracket || opCount == maxOperators) {
+                    return false;
+                }
+                ops[opCount++] = ii;
+                break;
+            case '^':
+                if (inBracket || prev == '^') {
+                    return false;
+                }
+                break;
+            case '-':
+                if (prev != '^') {
+                    return false;
+                }
+                break;
+            case '(':
+            case ')':
+            case '{':
+            case '}':
+            case '"':
+            case '\\':
+            case '+':
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+            case '\0':
+                return false;
+            default:
+                break;
+        }
+        prev = current;
+    }
+    if (inBracket || opCount == 0) {
+        return false;
+    }
+    ops[opCount] = unit_string.size();
+    const char* str = unit_string.c_str();
+    if (isNumericalCharacter(str[0])) {
+        return false;
+    }
+    // check the token boundaries for anything the cleaning of a partial string would alter
+    size_t start{0};
+    for (size_t ii = 0; ii <= opCount; ++ii) {
+        auto length = ops[ii] - start;
+        if (length == 0 || str[start] == '^' || str[ops[ii] - 1] == '^' || str[ops[ii] - 1] == '.') {
+            return false;
+        }
+        if (length == 1 && ii < opCount && (str[start] == '2' || str[start] == '3')) {
+            return false;
+        }
+        start = ops[ii] + 1;
+    }
+    precise_unit retunit;
+    // the longest leading sequence of tokens that matches a unit directly takes precedence
+    size_t token{0};
+    bool limitLength = (userUnits() == nullptr);
+    std::string powerSequence;
+    for (size_t ii = opCount - 1; ii >= 1; --ii) {
+        auto length = ops[ii];
+        if (limitLength && length > base_unit_index::maxLength) {
+            continue;
+        }
+        retunit = get_unit(str, length);
+        if (!is_valid(retunit) && trailingPowerInsertion(str, length)) {
+            powerSequence.assign(str, length - 1);
+            powerSequence.push_back('^');
+            powerSequence.push_back(str[length - 1]);
+            retunit = get_unit(powerSequence);
+        }
+        if (is_valid(retunit)) {
+            token = ii;
+            break;
+        }
+    }
+    if (token == 0) {
+        retunit = tokenUnit(unit_string, 0, ops[0], false, match_flags);
+        if (!is_valid(retunit)) {
+            result = precise::invalid;
+            return true;
+        }
+    }
+    for (size_t ii = token + 1; ii <= opCount; ++ii) {
+        start = ops[ii - 1] + 1;
+        auto length = ops[ii] - start;
+        bool powerInserted = (ii < opCount && trailingPowerInsertion(str + start, length));
+        auto tunit = tokenUnit(unit_string, start, length, powerInserted, match_flags);
+        if (!is_valid(tunit)) {
+            result = precise::invalid;
+            return true;
+        }
+        retunit = (str[start - 1] == '/') ? (retunit / tunit) : (retunit * tunit);
+    }
+    result = retunit;
+    return true;
 }
 
 // Step 1.  Check if the string matches something in the map
@@ -4739,7 +7082,7 @@ precise_unit unit_from_string(std::string unit_string, uint32_t match_flags)
 // found goto step 1 Step 7.  Check for a SI prefix on the unit Step 8.  Check if the first character is upper
 // case and if so and the string is long make it lower case Step 9.  Check to see if it is a number of some
 // kind and make numerical unit Step 10.  Return an error unit
-static precise_unit unit_from_string_internal(std::string unit_string, uint32_t match_flags)
+static precise_unit unit_from_string_steps(std::string unit_string, uint32_t match_flags)
 {
     if (unit_string.empty()) {
         return precise::one;
@@ -4748,6 +7091,11 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
         1024) { // there is no reason whatsoever that a unit string would be longer than 1024 characters
         return precise::invalid;
     }
+    parseDepthGuard depthGuard;
+    if (depthGuard.exhausted()) {
+        return precise::invalid;
+    }
+    markParseStage(parse_stage::quick_match);
     precise_unit retunit;
     if ((match_flags & case_insensitive) ==
         0) { // if not a ci matching process just do a quick scan first
@@ -4756,6 +7104,7 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
             return retunit;
         }
     }
+    markParseStage(parse_stage::clean_string);
     if (cleanUnitString(unit_string, match_flags)) {
         retunit = get_unit(unit_string);
         if (is_valid(retunit)) {
@@ -4777,6 +7126,7 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
         match_flags |= not_first_pass;
         match_flags += partition_check1; // only allow 3 deep for unit_partitioning
     }
+    markParseStage(parse_stage::custom_unit);
     if (unit_string.front() == '{' && unit_string.back() == '}') {
         if (unit_string.find_last_of("}", unit_string.size() - 2) == std::string::npos) {
             retunit = checkForCustomUnit(unit_string);
@@ -4787,8 +7137,9 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
             return commoditizedUnit(unit_string, precise::one, index);
         }
     }
-    auto ustring = unit_string;
+    std::string ustring;
     // catch a preceding number on the unit
+    markParseStage(parse_stage::leading_number);
     if (looksLikeNumber(unit_string)) {
         if (unit_string.front() != '1' ||
             unit_string[1] != '/') { // this catches 1/ which should be handled differently
@@ -4813,8 +7164,8 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
                 }
             }
             // don't do as many partition check levels for this
-            retunit = unit_from_string_internal(
-                unit_string.substr(index), match_flags + partition_check1);
+            retunit = unit_from_string_segment(
+                unit_string, index, unit_string.size() - index, match_flags + partition_check1);
             if (is_error(retunit)) {
                 if (unit_string[index] == '(' || unit_string[index] == '[') {
                     auto cparen = index + 1;
@@ -4826,8 +7177,8 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
                         getCommodity(unit_string.substr(index + 1, cparen - index - 1));
                     front_unit.commodity(commodity);
                     if (cparen < unit_string.size()) {
-                        retunit =
-                            unit_from_string_internal(unit_string.substr(cparen), match_flags);
+                        retunit = unit_from_string_segment(
+                            unit_string, cparen, unit_string.size() - cparen, match_flags);
                         if (!is_valid(retunit)) {
                             return precise::invalid;
                         }
@@ -4844,30 +7195,33 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
         }
     }
 
+    markParseStage(parse_stage::operator_split);
+    if (unit_from_token_sequence(unit_string, match_flags - recursion_modifier, retunit)) {
+        return retunit;
+    }
     auto sep = findOperatorSep(unit_string, "*/");
     if (sep != std::string::npos) {
         precise_unit a_unit, b_unit;
+        auto bsize = unit_string.size() - sep - 1;
         if (sep + 1 > unit_string.size() / 2) {
-            b_unit = unit_from_string_internal(
-                unit_string.substr(sep + 1), match_flags - recursion_modifier);
+            b_unit = unit_from_string_segment(
+                unit_string, sep + 1, bsize, match_flags - recursion_modifier);
             if (!is_valid(b_unit)) {
                 return precise::invalid;
             }
-            a_unit = unit_from_string_internal(
-                unit_string.substr(0, sep), match_flags - recursion_modifier);
+            a_unit = unit_from_string_segment(unit_string, 0, sep, match_flags - recursion_modifier);
 
             if (!is_valid(a_unit)) {
                 return precise::invalid;
             }
         } else {
-            a_unit = unit_from_string_internal(
-                unit_string.substr(0, sep), match_flags - recursion_modifier);
+            a_unit = unit_from_string_segment(unit_string, 0, sep, match_flags - recursion_modifier);
 
             if (!is_valid(a_unit)) {
                 return precise::invalid;
             }
-            b_unit = unit_from_string_internal(
-                unit_string.substr(sep + 1), match_flags - recursion_modifier);
+            b_unit = unit_from_string_segment(
+                unit_string, sep + 1, bsize, match_flags - recursion_modifier);
             if (!is_valid(b_unit)) {
                 return precise::invalid;
             }
@@ -4876,6 +7230,7 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
     }
     // flag that is used to circumvent a few checks
     bool containsPer = (findWordOperatorSep(unit_string, "per") != std::string::npos);
+    markParseStage(parse_stage::power);
     sep = findOperatorSep(unit_string, "^");
     if (sep != std::string::npos) {
         auto pchar = static_cast<int>(sep) - 1;
@@ -4915,8 +7270,10 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
             if (!is_valid(retunit)) {
                 if (index >= 0) {
                     if (ustring.find_first_of("(*/^{[") == std::string::npos) {
-                        retunit = unit_from_string_internal(
-                            unit_string.substr(0, static_cast<size_t>(pchar) + 1),
+                        retunit = unit_from_string_segment(
+                            unit_string,
+                            0,
+                            static_cast<size_t>(pchar) + 1,
                             match_flags - recursion_modifier);
                         if (!is_valid(retunit)) {
                             return precise::invalid;
@@ -4939,19 +7296,19 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
             if (index < 0) {
                 return retunit;
             }
-            auto a_unit = unit_from_string_internal(
-                unit_string.substr(0, index), match_flags - recursion_modifier);
+            auto a_unit = unit_from_string_segment(
+                unit_string, 0, static_cast<size_t>(index), match_flags - recursion_modifier);
             if (!is_error(a_unit)) {
                 return a_unit * retunit;
             }
         } else {
-            // auto ustring = unit_string.substr(0, pchar + 1);
-            ustring.assign(unit_string.begin(), unit_string.begin() + pchar + 1);
             if ((match_flags & case_insensitive) != 0) {
+                ustring.assign(unit_string.begin(), unit_string.begin() + pchar + 1);
                 cleanUnitString(ustring, match_flags);
+                retunit = get_unit(ustring);
+            } else {
+                retunit = get_unit(unit_string.c_str(), static_cast<size_t>(pchar) + 1);
             }
-
-            retunit = get_unit(ustring);
             if (is_valid(retunit)) {
                 if (power == 1) {
                     return retunit;
@@ -4963,9 +7320,8 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
             }
             // auto fnd = findWordOperatorSep(unit_string, "per");
             if (!containsPer) {
-                retunit = unit_from_string_internal(
-                    unit_string.substr(0, static_cast<size_t>(pchar) + 1),
-                    match_flags - recursion_modifier);
+                retunit = unit_from_string_segment(
+                    unit_string, 0, static_cast<size_t>(pchar) + 1, match_flags - recursion_modifier);
                 if (!is_valid(retunit)) {
                     return precise::invalid;
                 }
@@ -4979,20 +7335,21 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
             }
         }
     }
+    markParseStage(parse_stage::commodity);
     if ((match_flags & no_commodities) == 0 && unit_string.back() == '}') {
         return commoditizedUnit(unit_string, match_flags);
     }
+    markParseStage(parse_stage::si_prefix);
     if (unit_string.size() >= 3) {
         auto mux = getPrefixMultiplier2Char(unit_string[0], unit_string[1]);
         if (mux != 0.0) {
-            ustring = unit_string.substr(2);
-            if (ustring == "B") {
+            if (unit_string.compare(2, std::string::npos, "B") == 0) {
                 return {mux, precise::data::byte};
             }
-            if (ustring == "b") {
+            if (unit_string.compare(2, std::string::npos, "b") == 0) {
                 return {mux, precise::data::bit};
             }
-            retunit = unit_quick_match(ustring, match_flags);
+            retunit = unit_quick_match(unit_string.c_str() + 2, unit_string.size() - 2, match_flags);
             if (is_valid(retunit)) {
                 return {mux, retunit};
             }
@@ -5005,14 +7362,13 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
         }
         auto mux = getPrefixMultiplier(c);
         if (mux != 0.0) {
-            ustring = unit_string.substr(1);
-            if (ustring == "B") {
+            if (unit_string.compare(1, std::string::npos, "B") == 0) {
                 return {mux, precise::data::byte};
             }
-            if (ustring == "b") {
+            if (unit_string.compare(1, std::string::npos, "b") == 0) {
                 return {mux, precise::data::bit};
             }
-            retunit = unit_quick_match(ustring, match_flags);
+            retunit = unit_quick_match(unit_string.c_str() + 1, unit_string.size() - 1, match_flags);
             if (!is_error(retunit)) {
                 return {mux, retunit};
             }
@@ -5020,8 +7376,10 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
     }
     // don't do any further steps if recursion is not available
     if ((match_flags & no_recursion) != 0) {
+        markParseStage(parse_stage::quick_match);
         return unit_quick_match(unit_string, match_flags);
     }
+    markParseStage(parse_stage::power);
     if (unit_string.size() <= 2) {
         if (isDigitCharacter(unit_string.back())) {
             unit_string.insert(1, 1, '^');
@@ -5030,6 +7388,7 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
         return precise::invalid;
     }
     // in a few select cases make the first character lower case
+    markParseStage(parse_stage::capitalization);
     if ((unit_string.size() >= 3) && (!containsPer) && (!isDigitCharacter(unit_string.back()))) {
         if (unit_string[0] >= 'A' && unit_string[0] <= 'Z') {
             if (unit_string.size() > 5 || unit_string[0] != 'N') {
@@ -5046,15 +7405,16 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
         }
     }
 
+    markParseStage(parse_stage::word_prefix);
     auto mret = getPrefixMultiplierWord(unit_string);
     if (mret.first != 0.0) {
-        ustring = unit_string.substr(mret.second);
-
-        retunit = unit_quick_match(ustring, match_flags);
+        retunit = unit_quick_match(
+            unit_string.c_str() + mret.second, unit_string.size() - mret.second, match_flags);
         if (!is_error(retunit)) {
             return {mret.first, retunit};
         }
-        if (ustring[0] >= 'A' && ustring[0] <= 'Z') {
+        if (unit_string[mret.second] >= 'A' && unit_string[mret.second] <= 'Z') {
+            ustring = unit_string.substr(mret.second);
             if (ustring.size() > 4 || ustring[0] != 'N') {
                 if (ustring.find_first_of("*/^") == std::string::npos) {
                     ustring[0] += 32;
@@ -5066,12 +7426,11 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
             }
         }
     }
+    markParseStage(parse_stage::alternate_spelling);
     if (unit_string.front() == '[' && unit_string.back() == ']') {
-        ustring = unit_string.substr(1);
-        ustring.pop_back();
-        if (ustring.back() != 'U') // this means custom unit code
+        if (unit_string[unit_string.size() - 2] != 'U') // this means custom unit code
         {
-            retunit = get_unit(ustring);
+            retunit = get_unit(unit_string.c_str() + 1, unit_string.size() - 2);
             if (!is_error(retunit)) {
                 return retunit;
             }
@@ -5155,17 +7514,16 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
         }
     }
     if (unit_string.front() == '[' && unit_string.back() == ']') {
-        ustring = unit_string.substr(1);
-        ustring.pop_back();
-        if (ustring.back() != 'U') // this means custom unit code
+        if (unit_string[unit_string.size() - 2] != 'U') // this means custom unit code
         {
-            retunit = get_unit(ustring);
+            retunit = get_unit(unit_string.c_str() + 1, unit_string.size() - 2);
             if (!is_error(retunit)) {
                 return retunit;
             }
         }
     }
     // try changing out any "per" words for division sign
+    markParseStage(parse_stage::per_rewrite);
     if (containsPer && (match_flags & no_per_operators) == 0) {
         auto fnd = findWordOperatorSep(unit_string, "per");
         if (fnd != std::string::npos) {
@@ -5183,18 +7541,19 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
     }
 
     // remove trailing 's'
+    markParseStage(parse_stage::alternate_spelling);
     if (unit_string.back() == 's') {
-        ustring = unit_string;
-        ustring.pop_back();
-        retunit = get_unit(ustring);
+        retunit = get_unit(unit_string.c_str(), unit_string.size() - 1);
         if (!is_error(retunit)) {
             return retunit;
         }
     }
 
+    markParseStage(parse_stage::word_modifiers);
     if (wordModifiers(unit_string)) {
         return unit_from_string_internal(unit_string, match_flags);
     }
+    markParseStage(parse_stage::commodity);
     if ((match_flags & no_commodities) == 0 && (match_flags & no_of_operator) == 0) {
         // try changing out and words indicative of a unit commodity
         auto fnd = findWordOperatorSep(unit_string, "of");
@@ -5215,6 +7574,7 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
         }
     }
     // make lower case
+    markParseStage(parse_stage::alternate_spelling);
     {
         ustring = unit_string;
         std::transform(ustring.begin(), ustring.end(), ustring.begin(), ::tolower);
@@ -5225,33 +7585,79 @@ static precise_unit unit_from_string_internal(std::string unit_string, uint32_t
             }
         }
     }
+    markParseStage(parse_stage::custom_unit);
     retunit = checkForCustomUnit(unit_string);
     if (!is_error(retunit)) {
         return retunit;
     }
     // check for some international modifiers
+    markParseStage(parse_stage::locality_modifiers);
     if ((match_flags & no_locality_modifiers) == 0) {
-        retunit = localityModifiers(unit_string, match_flags | skip_partition_check);
+        retunit = localityModifiers(
+            unit_string, match_flags | skip_partition_check | skip_case_insensitive_index);
         if (!is_error(retunit)) {
             return retunit;
         }
     }
 
+    markParseStage(parse_stage::partitioning);
     if ((match_flags & skip_partition_check) == 0) {
         // maybe some things got merged together so lets try splitting them up in various ways
         // but only allow 3 layers deep
-        retunit = tryUnitPartitioning(unit_string, match_flags + partition_check1);
+        retunit = tryUnitPartitioning(
+            unit_string, (match_flags | skip_case_insensitive_index) + partition_check1);
         if (!is_error(retunit)) {
             return retunit;
         }
     }
     return precise::invalid;
-} // namespace units
+}
 
-precision_measurement measurement_from_string(std::string measurement_string, uint32_t match_flags)
+// run the steps and record the stage that produced the result
+static precise_unit unit_from_string_stage(std::string unit_string, uint32_t match_flags)
+{
+    auto retunit = unit_from_string_steps(std::move(unit_string), match_flags);
+    if (activeSession != nullptr) {
+        recordParseStage(activeSession->stageTried, retunit);
+    }
+    return retunit;
+}
+
+/** convert a unit string or a token of one
+@details with case insensitive matching a string or token the steps do not resolve is matched
+against the case insensitive index of the unit strings,  so the index never changes a result the
+steps produce.  The index is not used for the pieces the partitioning and locality steps try,  and
+not at all for input that is already lower case
+*/
+static precise_unit unit_from_string_internal(std::string unit_string, uint32_t match_flags)
+{
+    if ((match_flags & (case_insensitive | skip_case_insensitive_index)) != case_insensitive) {
+        return unit_from_string_stage(std::move(unit_string), match_flags);
+    }
+    if ((match_flags & not_first_pass) == 0 && !containsUpperCase(unit_string)) {
+        return unit_from_string_stage(
+            std::move(unit_string), match_flags | skip_case_insensitive_index);
+    }
+    std::string ciString(unit_string);
+    auto retunit = unit_from_string_stage(std::move(unit_string), match_flags);
+    if (is_valid(retunit)) {
+        return retunit;
+    }
+    cleanUnitString(ciString, match_flags);
+    retunit = caseInsensitiveIndexMatch(ciString);
+    recordParseStage(parse_stage::alternate_spelling, retunit);
+    return retunit;
+}
+
+static precision_measurement
+    measurement_from_string_internal(std::string measurement_string, uint32_t match_flags)
 {
     // do a cleaning first to get rid of spaces and other issues
     match_flags &= (~skip_code_replacements);
+    if ((match_flags & case_insensitive) != 0 && !containsUpperCase(measurement_string)) {
+        // the cleaning puts the string in the case insensitive form
+        match_flags |= skip_case_insensitive_index;
+    }
     cleanUnitString(measurement_string, match_flags);
     match_flags |= skip_code_replacements;
 
@@ -5263,7 +7669,8 @@ precision_measurement measurement_from_string(std::string measurement_string, ui
     }
     bool checkCurrency = (loc == 0);
 
-    auto un = unit_from_string_internal(measurement_string.substr(loc), match_flags);
+    auto un = unit_from_string_segment(
+        measurement_string, loc, measurement_string.size() - loc, match_flags);
     if (!is_error(un)) {
         if (checkCurrency) {
             if (un.base_units() == precise::currency.base_units()) {
@@ -5272,9 +7679,10 @@ precision_measurement measurement_from_string(std::string measurement_string, ui
         }
         return {val, un};
     } else if (checkCurrency) {
-        auto c = get_unit(measurement_string.substr(0, 1));
+        auto c = get_unit(measurement_string.c_str(), 1);
         if (c == precise::currency) {
-            auto mstr = measurement_from_string(measurement_string.substr(1), match_flags);
+            auto mstr =
+                measurement_from_string_internal(measurement_string.substr(1), match_flags);
             return mstr * c;
         }
     }
@@ -5293,6 +7701,29 @@ precision_measurement measurement_from_string(std::string measurement_string, ui
     return {val, precise::invalid};
 }
 
+precision_measurement measurement_from_string(std::string measurement_string, uint32_t match_flags)
+{
+    if (activeSession != nullptr) {
+        return measurement_from_string_internal(std::move(measurement_string), match_flags);
+    }
+    parseSessionScope scope(measurement_string, false, getParseBudget());
+    auto meas = measurement_from_string_internal(std::move(measurement_string), match_flags);
+    return {meas.value(), scope.finish(meas.units())};
+}
+
+precision_measurement measurement_from_string(
+    std::string measurement_string,
+    const parse_budget& budget,
+    uint32_t match_flags)
+{
+    if (activeSession != nullptr) {
+        return measurement_from_string_internal(std::move(measurement_string), match_flags);
+    }
+    parseSessionScope scope(measurement_string, false, budget);
+    auto meas = measurement_from_string_internal(std::move(measurement_string), match_flags);
+    return {meas.value(), scope.finish(meas.units())};
+}
+
 // Mostly from https://en.wikipedia.org/wiki/International_System_of_Units
 static const std::unordered_map<std::string, precise_unit> measurement_types{
     {"", precise::defunit},
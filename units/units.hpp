@@ -8,8 +8,11 @@ SPDX-License-Identifier: BSD-3-Clause
 #include "unit_definitions.hpp"
 
 #include <cmath>
+#include <memory>
 #include <string>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace units {
 /// Generate a conversion factor between two units in a constexpr function, the units will only convert if they
@@ -211,6 +214,564 @@ double convert(double val, UX start, UX2 result, double basePower, double baseVo
     return convert(val, start, result * pu) * base;
 }
 
+/** The accuracy of array conversions involving equation units
+@details the fast conversions use vectorized exp and log approximations.  Conversions to linear values are
+within 1 ulp of the exact conversion, conversions to logarithmic units within 3 ulp.  The moment and energy
+magnitude scales subtract an offset from the logarithm so their error is 3 ulp of the logarithm.  The wind
+scale polynomials are exact in both modes and the Fujita scale and prism diopter always use the exact functions*/
+enum class equation_accuracy : uint8_t {
+    exact = 0,  //!< the same functions as the scalar conversion so the results are identical
+    fast = 1,  //!< vectorized approximations of the exponential and logarithmic functions
+};
+
+namespace precise {
+    namespace equations {
+        /** Convert an array of equation unit values to their linear values
+        @details the equation type is resolved once for the array, results may be the same array as values*/
+        void convert_equnit_to_value(
+            const double* values,
+            double* results,
+            size_t size,
+            detail::unit_data UT,
+            equation_accuracy accuracy = equation_accuracy::fast);
+        /** Convert an array of linear values to an equation unit
+        @details the equation type is resolved once for the array, results may be the same array as values*/
+        void convert_value_to_equnit(
+            const double* values,
+            double* results,
+            size_t size,
+            detail::unit_data UT,
+            equation_accuracy accuracy = equation_accuracy::fast);
+    }  // namespace equations
+}  // namespace precise
+
+/** Class holding a conversion between a fixed pair of units
+@details the dispatch done by convert is resolved once on construction and the conversion is stored as a
+kind and a set of coefficients, so converting a value is a straight sequence of arithmetic matching the
+operations convert would perform on the same value.  The per unit base values are fixed on construction as
+well.  A temperature conversion runs the same expressions as convert,  so the two agree even if the compiler
+contracts a multiply and an add into a fused multiply add.  The array conversions are compiled in the library
+and match the scalar conversions of code built without that contraction*/
+class unit_converter {
+  public:
+    /// the kinds of conversion a unit_converter can hold
+    enum class kind : uint8_t {
+        unconvertible = 0,  //!< the units cannot be converted
+        linear = 1,  //!< a scale factor including same units and per unit scaling
+        temperature = 2,  //!< an affine conversion of temperatures
+        equation = 3,  //!< one or both of the units is an equation unit
+        inverse = 4,  //!< the units are inverses of each other
+        counting = 5,  //!< a scale factor between counting units (radians, count, mole)
+        general = 6,  //!< a power system conversion with no fixed form, convert is called directly
+    };
+    /// Default constructor: an invalid conversion
+    unit_converter() = default;
+    /// Construct a converter equivalent to convert(val, start, result)
+    template<typename UX, typename UX2>
+    unit_converter(UX start, UX2 result)
+    {
+        check_types<UX, UX2>();
+        classify(start, result);
+    }
+    /// Construct a converter equivalent to convert(val, start, result, baseValue)
+    template<typename UX, typename UX2>
+    unit_converter(UX start, UX2 result, double baseValue)
+    {
+        check_types<UX, UX2>();
+        classify(start, result, baseValue);
+    }
+    /// Construct a converter equivalent to convert(val, start, result, basePower, baseVoltage)
+    template<typename UX, typename UX2>
+    unit_converter(UX start, UX2 result, double basePower, double baseVoltage)
+    {
+        check_types<UX, UX2>();
+        classify(start, result, basePower, baseVoltage);
+    }
+    /// Convert a value from the start unit to the result unit
+    double convert(double val) const
+    {
+        switch (kind_) {
+            case kind::linear:
+            case kind::counting:
+                return val * c_[0] * c_[1] / c_[2] / c_[3];
+            case kind::temperature:
+                return detail::convertTemperature(val, start_, result_);
+            case kind::equation:
+                val = precise::equations::convert_equnit_to_value(val, start_.base_units());
+                val = val * c_[1] / c_[2];
+                return precise::equations::convert_value_to_equnit(val, result_.base_units());
+            case kind::inverse:
+                return c_[2] / (val * c_[1]);
+            case kind::general:
+                return general_(*this, val);
+            default:
+                return constants::invalid_conversion;
+        }
+    }
+    /// Convert a value from the start unit to the result unit
+    double operator()(double val) const { return convert(val); }
+    /** Convert an array of values, results may be the same array as values
+    @details linear, temperature and inverse conversions run in SIMD kernels chosen for the processor and
+    give exactly the values of the scalar conversion in code built without floating point contraction,
+    equation units are converted with the given accuracy*/
+    void convert(
+        const double* values,
+        double* results,
+        size_t size,
+        equation_accuracy accuracy = equation_accuracy::exact) const;
+    /// Convert an array of float values, each value is converted in double precision as in the scalar case
+    void convert(
+        const float* values,
+        float* results,
+        size_t size,
+        equation_accuracy accuracy = equation_accuracy::exact) const;
+    /// Get the kind of the conversion
+    kind conversion_kind() const { return kind_; }
+    /// Check if the converter holds a valid conversion
+    bool is_valid() const { return kind_ != kind::unconvertible; }
+
+  private:
+    template<typename UX, typename UX2>
+    static void check_types()
+    {
+        static_assert(
+            std::is_same<UX, unit>::value || std::is_same<UX, precise_unit>::value,
+            "unit_converter argument types must be unit or precise_unit");
+        static_assert(
+            std::is_same<UX2, unit>::value || std::is_same<UX2, precise_unit>::value,
+            "unit_converter argument types must be unit or precise_unit");
+    }
+    /// set up a linear conversion (((val*pre)*startMult)/resultMult)/post
+    void set_linear(
+        double pre,
+        double startMult,
+        double resultMult,
+        double post,
+        kind type = kind::linear)
+    {
+        kind_ = type;
+        c_[0] = pre;
+        c_[1] = startMult;
+        c_[2] = resultMult;
+        c_[3] = post;
+    }
+    void set_identity() { set_linear(1.0, 1.0, 1.0, 1.0); }
+
+    /// mirror the dispatch of convert(val, start, result)
+    template<typename UX, typename UX2>
+    void classify(UX start, UX2 result)
+    {
+        if (start == result || is_default(start) || is_default(result)) {
+            set_identity();
+            return;
+        }
+        if ((is_temperature(start) || is_temperature(result)) &&
+            start.has_same_base(result.base_units())) {
+            set_temperature(start, result);
+            return;
+        }
+        if (start.is_equation() || result.is_equation()) {
+            if (start.base_units().equivalent_non_counting(result.base_units())) {
+                kind_ = kind::equation;
+                start_ = precise_unit(start);
+                result_ = precise_unit(result);
+                c_[1] = start.multiplier();
+                c_[2] = result.multiplier();
+            }
+            return;
+        }
+        if (start.base_units() == result.base_units()) {
+            set_linear(1.0, start.multiplier(), result.multiplier(), 1.0);
+            return;
+        }
+        if (start.is_per_unit() && result.is_per_unit()) {
+            if (unit_cast(start) == pu || unit_cast(result) == pu) {
+                set_identity();
+                return;
+            }
+            // knownConversions produces either the value or its inverse
+            double known =
+                puconversion::knownConversions(2.0, start.base_units(), result.base_units());
+            if (known == 2.0) {
+                set_identity();
+                return;
+            }
+            if (known == 0.5) {
+                kind_ = kind::inverse;
+                c_[1] = 1.0;
+                c_[2] = 1.0;
+                return;
+            }
+        } else if (start.is_per_unit() || result.is_per_unit()) {
+            double genBase = puconversion::assumedBase(unit_cast(start), unit_cast(result));
+            if (!std::isnan(genBase)) {
+                classify(start, result, genBase);
+            }
+            return;
+        }
+        auto base_start = start.base_units();
+        auto base_result = result.base_units();
+        if (base_start.has_same_base(base_result)) {
+            set_linear(1.0, start.multiplier(), result.multiplier(), 1.0);
+            return;
+        }
+        if (base_start.equivalent_non_counting(base_result) &&
+            set_counting(start, result)) {
+            return;
+        }
+        if (base_start.has_same_base(base_result.inv())) {
+            kind_ = kind::inverse;
+            c_[1] = start.multiplier();
+            c_[2] = result.multiplier();
+        }
+    }
+
+    /// mirror the dispatch of convert(val, start, result, baseValue)
+    template<typename UX, typename UX2>
+    void classify(UX start, UX2 result, double baseValue)
+    {
+        if (start == result || is_default(start) || is_default(result)) {
+            set_identity();
+            return;
+        }
+        if (start.base_units() == result.base_units()) {
+            set_linear(1.0, start.multiplier(), result.multiplier(), 1.0);
+            return;
+        }
+        if (start.is_per_unit() == result.is_per_unit()) {
+            classify(start, result);
+            return;
+        }
+        if (start.has_same_base(result.base_units()) || pu == unit_cast(start) ||
+            pu == unit_cast(result)) {
+            set_linear(
+                start.is_per_unit() ? baseValue : 1.0,
+                start.multiplier(),
+                result.multiplier(),
+                result.is_per_unit() ? baseValue : 1.0);
+        }
+    }
+
+    /// mirror the dispatch of convert(val, start, result, basePower, baseVoltage)
+    template<typename UX, typename UX2>
+    void classify(UX start, UX2 result, double basePower, double baseVoltage)
+    {
+        if (is_default(start) || is_default(result)) {
+            set_identity();
+            return;
+        }
+        if (start.is_per_unit() == result.is_per_unit()) {
+            auto base = puconversion::generate_base(start.base_units(), basePower, baseVoltage);
+            if (std::isnan(base)) {
+                if (start.is_per_unit() && start == result) {
+                    set_linear(basePower, 1.0, baseVoltage, 1.0);
+                    return;
+                }
+                if (start.is_per_unit() && start.has_same_base(result.base_units())) {
+                    set_linear(basePower, start.multiplier(), baseVoltage, result.multiplier());
+                    return;
+                }
+            }
+            classify(start, result);
+            return;
+        }
+        if (start.has_same_base(result.base_units())) {
+            auto base = puconversion::generate_base(result.base_units(), basePower, baseVoltage);
+            set_linear(
+                start.is_per_unit() ? base : 1.0,
+                start.multiplier(),
+                result.multiplier(),
+                result.is_per_unit() ? base : 1.0);
+            return;
+        }
+        if (!result.is_per_unit() && pu == unit_cast(start)) {
+            auto base = puconversion::generate_base(result.base_units(), basePower, baseVoltage);
+            set_linear(base * start.multiplier(), 1.0, 1.0, 1.0);
+            return;
+        }
+        // the remaining conversions nest a second conversion so are left to convert itself
+        kind_ = kind::general;
+        c_[0] = basePower;
+        c_[1] = baseVoltage;
+        start_ = precise_unit(start);
+        result_ = precise_unit(result);
+        general_ = &general_conversion<UX, UX2>;
+    }
+
+    /** store the temperature conversion
+    @details the scalar conversion calls detail::convertTemperature with the stored units,  the coefficients
+    give the same sequence of operations with each multiply followed by a division for the array kernels*/
+    template<typename UX, typename UX2>
+    void set_temperature(UX start, UX2 result)
+    {
+        kind_ = kind::temperature;
+        start_ = precise_unit(start);
+        result_ = precise_unit(result);
+        // adding -0.0 leaves every value including -0.0 unchanged
+        c_[0] = 0.0;
+        c_[1] = start.multiplier();
+        c_[2] = 1.0;
+        c_[3] = -0.0;
+        if (is_temperature(start)) {
+            if (units::degF == unit_cast(start)) {
+                c_[0] = 32.0;
+                c_[1] = 5.0;
+                c_[2] = 9.0;
+            }
+            c_[3] = 273.15;
+        }
+        c_[4] = 0.0;
+        c_[5] = 1.0;
+        c_[6] = result.multiplier();
+        c_[7] = -0.0;
+        if (is_temperature(result)) {
+            c_[4] = 273.15;
+            if (units::degF == unit_cast(result)) {
+                c_[5] = 9.0 / 5.0;
+                c_[6] = 1.0;
+                c_[7] = 32.0;
+            }
+        }
+    }
+
+    /// mirror the counting unit factors of detail::convertCountingUnits
+    template<typename UX, typename UX2>
+    bool set_counting(UX start, UX2 result)
+    {
+        // with unit multipliers the conversion of the bare bases is exactly the counting factor
+        double mux = detail::convertCountingUnits(
+            1.0, precise_unit(start.base_units()), precise_unit(result.base_units()));
+        if (std::isnan(mux)) {
+            return false;
+        }
+        set_linear(mux, start.multiplier(), result.multiplier(), 1.0, kind::counting);
+        return true;
+    }
+
+    static unit restore(const precise_unit& stored, const unit* /*type*/)
+    {
+        return unit_cast(stored);
+    }
+    static precise_unit restore(const precise_unit& stored, const precise_unit* /*type*/)
+    {
+        return stored;
+    }
+    template<typename UX, typename UX2>
+    static double general_conversion(const unit_converter& conv, double val)
+    {
+        return units::convert(
+            val,
+            restore(conv.start_, static_cast<const UX*>(nullptr)),
+            restore(conv.result_, static_cast<const UX2*>(nullptr)),
+            conv.c_[0],
+            conv.c_[1]);
+    }
+
+    kind kind_{kind::unconvertible};
+    double c_[8]{0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    precise_unit start_;
+    precise_unit result_;
+    double (*general_)(const unit_converter&, double){nullptr};
+};
+
+/// Convert an array of values from one unit to another, results may be the same array as values
+template<typename UX, typename UX2>
+void convert(const double* values, double* results, size_t size, UX start, UX2 result)
+{
+    unit_converter(start, result).convert(values, results, size);
+}
+
+/// Convert an array of float values from one unit to another, results may be the same array as values
+template<typename UX, typename UX2>
+void convert(const float* values, float* results, size_t size, UX start, UX2 result)
+{
+    unit_converter(start, result).convert(values, results, size);
+}
+
+/// The instruction sets used for the array conversions
+enum class simd_level : uint8_t {
+    scalar = 0,
+    sse2 = 1,
+    avx2 = 2,
+    avx512 = 3,
+};
+/// Get the instruction set in use for array conversions
+simd_level getSimdLevel();
+/** Set the instruction set to use for array conversions
+@return the level in use, which is limited to the best level the processor supports*/
+simd_level setSimdLevel(simd_level level);
+
+/** Convert arrays of values between per unit and physical units for a network of buses with their own bases
+@details the base of each bus is computed from its base power and voltage once on construction, so each
+conversion is an array operation over the values and the stored bases.  The results are identical to calling
+convert(val, start, result, basePower, baseVoltage) for each bus, including buses whose base is not a number
+because a base value is missing or zero*/
+class per_unit_converter {
+  public:
+    /// Default constructor: no buses
+    per_unit_converter() = default;
+    /** Construct a converter for a number of buses each with its own base power and base voltage
+    @param start the units of the values to convert
+    @param result the units of the results
+    @param basePower pointer to the first of buses base powers
+    @param baseVoltage pointer to the first of buses base voltages
+    @param buses the number of buses
+    */
+    template<typename UX, typename UX2>
+    per_unit_converter(
+        UX start,
+        UX2 result,
+        const double* basePower,
+        const double* baseVoltage,
+        size_t buses)
+    {
+        classify(start, result);
+        set_bases(start.multiplier(), result.multiplier(), basePower, 0.0, baseVoltage, buses);
+    }
+    /// Construct a converter for buses with a shared base power and their own base voltages
+    template<typename UX, typename UX2>
+    per_unit_converter(
+        UX start,
+        UX2 result,
+        double basePower,
+        const double* baseVoltage,
+        size_t buses)
+    {
+        classify(start, result);
+        set_bases(start.multiplier(), result.multiplier(), nullptr, basePower, baseVoltage, buses);
+    }
+    /** Convert one value per bus
+    @param values pointer to the first of size() values
+    @param results pointer to the first of size() results, this may be the same array as values
+    @param threads the number of threads to split a large network over, 0 for the number of processors
+    */
+    void convert(const double* values, double* results, size_t threads = 1) const;
+    /// Get the number of buses
+    size_t size() const { return count_; }
+
+  private:
+    /// the sequence of operations convert performs for a bus
+    enum class form : uint8_t {
+        shared,  //!< the conversion does not depend on the bases
+        shared_unless_missing,  //!< shared, but buses whose base is not a number use the base ratio
+        base_ratio,  //!< val*basePower*c1/baseVoltage/c2
+        same_base_ratio,  //!< val*basePower/baseVoltage, convert leaves out the multipliers of matching units
+        scale_first,  //!< val*base*c1/c2
+        scale_last,  //!< val*c1/c2/base
+        divide_first,  //!< val/base*c1
+        multiply,  //!< val*base where base includes c1
+        nested_divide,  //!< inner(val/base)/c2
+        nested_multiply,  //!< inner(val)*base where base includes c1
+    };
+
+    /// mirror the dispatch of convert(val, start, result, basePower, baseVoltage)
+    template<typename UX, typename UX2>
+    void classify(UX start, UX2 result)
+    {
+        static_assert(
+            std::is_same<UX, unit>::value || std::is_same<UX, precise_unit>::value,
+            "per_unit_converter argument types must be unit or precise_unit");
+        static_assert(
+            std::is_same<UX2, unit>::value || std::is_same<UX2, precise_unit>::value,
+            "per_unit_converter argument types must be unit or precise_unit");
+        if (is_default(start) || is_default(result)) {
+            form_ = form::shared;
+            inner_ = unit_converter(start, result);
+            return;
+        }
+        if (start.is_per_unit() == result.is_per_unit()) {
+            base_ = start.base_units();
+            sameUnits_ = (start == result);
+            inner_ = unit_converter(start, result);
+            if (!start.is_per_unit() || !start.has_same_base(result.base_units())) {
+                form_ = form::shared;
+                return;
+            }
+            // units with no power system base never have a base, the others only if a base value is missing
+            if (std::isnan(puconversion::generate_base(base_, 1.0, 1.0))) {
+                form_ = sameUnits_ ? form::same_base_ratio : form::base_ratio;
+                return;
+            }
+            form_ = form::shared_unless_missing;
+            return;
+        }
+        base_ = result.base_units();
+        if (start.has_same_base(result.base_units())) {
+            form_ = start.is_per_unit() ? form::scale_first : form::scale_last;
+            return;
+        }
+        if (result.is_per_unit()) {
+            base_ = start.base_units();
+            if (pu == unit_cast(result)) {
+                form_ = form::divide_first;
+                return;
+            }
+            form_ = form::nested_divide;
+            inner_ = unit_converter(start * pu, result);
+            return;
+        }
+        if (pu == unit_cast(start)) {
+            form_ = form::multiply;
+            return;
+        }
+        form_ = form::nested_multiply;
+        inner_ = unit_converter(start, result * pu);
+    }
+    /** store the multipliers and compute the base of each bus, basePower is used for every bus if powers is
+    nullptr*/
+    void set_bases(
+        double startMultiplier,
+        double resultMultiplier,
+        const double* powers,
+        double basePower,
+        const double* baseVoltage,
+        size_t buses);
+    /// convert the values of length buses starting at first
+    void convert_range(const double* values, double* results, size_t first, size_t length) const;
+
+    form form_{form::shared};
+    detail::unit_data base_{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    double c1_{1.0};
+    double c2_{1.0};
+    unit_converter inner_;
+    size_t count_{0};
+    bool sameUnits_{false};
+    std::vector<double> bases_;
+    std::vector<double> voltages_;
+    /// the buses of a shared_unless_missing converter whose base is not a number, in increasing order
+    std::vector<size_t> ratioBuses_;
+};
+
+/** Convert an array of values with one base power and base voltage per value
+@details the same as convert(values[i], start, result, basePower[i], baseVoltage[i]) for each value, results
+may be the same array as values*/
+template<typename UX, typename UX2>
+void convert(
+    const double* values,
+    double* results,
+    size_t size,
+    UX start,
+    UX2 result,
+    const double* basePower,
+    const double* baseVoltage)
+{
+    per_unit_converter(start, result, basePower, baseVoltage, size).convert(values, results);
+}
+
+/// Convert an array of values with a shared base power and one base voltage per value
+template<typename UX, typename UX2>
+void convert(
+    const double* values,
+    double* results,
+    size_t size,
+    UX start,
+    UX2 result,
+    double basePower,
+    const double* baseVoltage)
+{
+    per_unit_converter(start, result, basePower, baseVoltage, size).convert(values, results);
+}
+
 /// Class defining a measurement (value+unit)
 template<class X>
 class measurement_type {
@@ -878,6 +1439,10 @@ enum unit_conversion_flags : uint32_t {
     case_insensitive = 1u, //!< perform case insensitive matching for UCUM case insensitive matching
     single_slash =
         2u, //!< specify that there is a single numerator and denominator only a single slash in the unit operations
+    skip_case_insensitive_index =
+        (1u << 13), // don't match tokens against the case insensitive index of the unit strings
+    skip_token_sequence =
+        (1u << 14), // convert operator sequences by splitting at the last operator instead of in one pass
     recursion_depth1 = (1u << 15), // skip checking for SI prefixes
     // don't put anything at   16, 15 through 17 are connected to limit recursion depth
     no_recursion = (1u << 17), // don't recurse through the string
@@ -924,6 +1489,39 @@ inline unit unit_cast_from_string(std::string unit_string, uint32_t match_flags
     return unit_cast(unit_from_string(unit_string, match_flags));
 }
 
+/** Convert a column of unit strings
+@details each distinct string is converted once, so the cost of a repeated string is a hash lookup.  If
+there are a large number of distinct strings they are converted on multiple threads
+@param unit_strings pointer to the first of size string pointers to convert, the strings do not need to be
+null terminated so they can point directly into a file or column buffer
+@param lengths pointer to the first of size string lengths
+@param units pointer to the first of size units to store the results
+@param size the number of strings to convert
+@param match_flags see /ref unit_conversion_flags to control the matching process somewhat
+*/
+void unit_from_string_batch(
+    const char* const* unit_strings,
+    const size_t* lengths,
+    precise_unit* units,
+    size_t size,
+    uint32_t match_flags = 0);
+
+/// Convert a column of std::string unit strings
+void unit_from_string_batch(
+    const std::string* unit_strings,
+    precise_unit* units,
+    size_t size,
+    uint32_t match_flags = 0);
+
+/// Convert a vector of unit strings into a vector of precise units
+inline std::vector<precise_unit>
+    unit_from_string_batch(const std::vector<std::string>& unit_strings, uint32_t match_flags = 0)
+{
+    std::vector<precise_unit> units(unit_strings.size());
+    unit_from_string_batch(unit_strings.data(), units.data(), unit_strings.size(), match_flags);
+    return units;
+}
+
 /** Generate a unit object from the string definition of a type of measurement
 @param unit_type  string representing the type of measurement
 @return a precise unit corresponding to the SI unit for the measurement specified in unit_type
@@ -943,8 +1541,55 @@ std::string to_string(precision_measurement measure, uint32_t match_flags = 0);
 std::string to_string(measurement measure, uint32_t match_flags = 0);
 /// Convert a floating point measurement to a string
 std::string to_string(measurement_f measure, uint32_t match_flags = 0);
+
+/** Write text which converts back to the same number into a character buffer
+@details no locale is used and nothing is allocated.  The digits come from the Grisu2 algorithm,  they always
+round trip and are the shortest such digits in almost all cases,  occasionally there is one more digit than
+needed.  The text is in plain notation unless the number is below 1e-4 or has more than 17 digits before the
+decimal point,  then it is in exponent notation such as 1.5e-7.  Infinite values are written as inf and -inf
+and NaN as nan
+@param first the start of the buffer
+@param last one past the end of the buffer
+@param value the number to write
+@return a pointer one past the last character written,  nullptr if the text doesn't fit in the buffer
+*/
+char* format_to(char* first, char* last, double value);
+/// Write text which converts back to the same float into a character buffer,  see format_to for a double
+char* format_to(char* first, char* last, float value);
+/** Write the string representation of a unit into a character buffer,  this allocates unless the unit format
+cache is enabled and holds the unit
+@details the unit string is the same as to_string.  The unit format cache is off by default,  without it the
+string is generated with to_string and then copied into the buffer,  so the only saving is the result string.
+Enable it with enableUnitFormatCache to write cached unit strings without allocating
+@return a pointer one past the last character written,  nullptr if the text doesn't fit in the buffer
+*/
+char* format_to(char* first, char* last, precise_unit units, uint32_t match_flags = 0);
+/// Write the string representation of a unit into a character buffer
+inline char* format_to(char* first, char* last, unit units, uint32_t match_flags = 0)
+{
+    return format_to(first, last, precise_unit(units), match_flags);
+}
+/** Write a measurement into a character buffer,  the unit string allocates as in format_to for a unit
+@details the value is written with text which converts back to the same number as in format_to for a double,
+followed by a space and the unit string.  The value never allocates,  the unit string only avoids allocating
+if the unit format cache is enabled and holds the unit
+@return a pointer one past the last character written,  nullptr if the text doesn't fit in the buffer
+*/
+char* format_to(
+    char* first,
+    char* last,
+    precision_measurement measure,
+    uint32_t match_flags = 0);
+/// Write a measurement into a character buffer
+char* format_to(char* first, char* last, measurement measure, uint32_t match_flags = 0);
+/// Write a floating point measurement into a character buffer
+char* format_to(char* first, char* last, measurement_f measure, uint32_t match_flags = 0);
 /// Add a custom unit to be included in any string processing
 void addUserDefinedUnit(std::string name, precise_unit un);
+/** Add a set of custom units to be included in any string processing
+@details the user defined units are published as immutable snapshots so units can be added while other threads
+are converting strings,  adding a batch of units at once publishes a single snapshot*/
+void addUserDefinedUnits(const std::vector<std::pair<std::string, precise_unit>>& units);
 /// Clear all user defined units from memory
 void clearUserDefinedUnits();
 
@@ -968,6 +1613,329 @@ bool disableCustomCommodities();
 /// Enable the ability to add custom commodities for later access
 bool enableCustomCommodities();
 
+/// usage statistics of the custom commodities
+struct commodity_statistics {
+    size_t custom{0}; //!< the number of commodities added with addCustomCommodity
+    size_t names{0}; //!< the number of stored names of unrecognized commodity strings
+    size_t capacity{0}; //!< the maximum number of stored names
+    uint64_t evictions{0}; //!< the number of names removed to make room for new ones
+    uint64_t rejected{0}; //!< names not stored as they were written concurrently
+    size_t memory{0}; //!< the approximate number of bytes in use
+};
+
+/** Set the maximum number of names of unrecognized commodity strings to store
+@details getCommodity stores the name of an unrecognized commodity string so getCommodityName can find it
+from the generated code.  Beyond the capacity the oldest names are evicted and the code of an evicted name is
+shown as CXCOMM[code].  Names longer than 56 characters are stored in a separate allocation.  A capacity of 0
+stores no names,
+changing the capacity removes the stored names
+*/
+void setCommodityNameCapacity(size_t capacity);
+/// Get the number of custom commodities and stored names and the memory they use
+commodity_statistics getCommodityStatistics();
+
+/// usage statistics for one of the string or conversion caches
+struct cache_statistics {
+    uint64_t hits{0}; //!< the number of lookups found in the cache
+    uint64_t misses{0}; //!< the number of lookups not found in the cache
+    uint64_t evictions{0}; //!< the number of entries removed to make room for new ones
+    size_t size{0}; //!< the current number of entries
+    size_t capacity{0}; //!< the maximum number of entries
+};
+
+/** Turn on a cache of the results of unit_from_string
+@details the cache is keyed on the string and match flags, it is safe to use from multiple threads and is
+cleared automatically when user defined units or custom commodities are changed.  Enabling the cache resets
+the statistics
+@param capacity the maximum number of entries, the least recently used entries are evicted beyond this
+*/
+void enableUnitStringCache(size_t capacity = 4096);
+/// Turn off the unit string cache and release its memory
+void disableUnitStringCache();
+/// Remove all entries in the unit string cache
+void clearUnitStringCache();
+/// Get the hit and miss counts and size of the unit string cache
+cache_statistics getUnitStringCacheStatistics();
+
+/** Turn on a cache of the strings generated by to_string for precise units and measurements
+@details the cache is keyed on the exact bits of the unit, its commodity and the match flags.  It is safe to
+use from multiple threads and is cleared automatically when user defined units or custom commodities are
+changed.  Units with the commodity of an unrecognized commodity string are not cached.  Enabling the cache
+resets the statistics
+@param capacity the maximum number of entries, the least recently used entries are evicted beyond this
+*/
+void enableUnitFormatCache(size_t capacity = 1024);
+/// Turn off the unit format cache and release its memory
+void disableUnitFormatCache();
+/// Remove all entries in the unit format cache
+void clearUnitFormatCache();
+/// Get the hit and miss counts and size of the unit format cache
+cache_statistics getUnitFormatCacheStatistics();
+
+/** Turn on a cache of the converters resolved for pairs of precise units
+@details the cache is keyed on the exact bits of both units and holds the unit_converter built for the pair,
+so repeated calls to cached_convert skip classifying the conversion.  Lookups never lock and it is safe to
+use from multiple threads.  Enabling the cache resets the statistics
+@param capacity the number of entries, rounded up to a power of 2, entries are replaced when the slots
+near their hash are full
+*/
+void enableConversionCache(size_t capacity = 4096);
+/// Turn off the conversion cache, the memory is kept for reuse if it is enabled again
+void disableConversionCache();
+/// Remove all entries in the conversion cache
+void clearConversionCache();
+/// Get the hit and miss counts and size of the conversion cache
+cache_statistics getConversionCacheStatistics();
+/** Get a converter between two units, using the conversion cache if it is enabled
+@details the result is identical to unit_converter(start, result)*/
+unit_converter cached_converter(precise_unit start, precise_unit result);
+/** Convert a value between two units, using the conversion cache if it is enabled
+@details the result is identical to convert(val, start, result)*/
+double cached_convert(double val, precise_unit start, precise_unit result);
+
+namespace detail {
+    struct unitContextData;
+    struct commodityContextData;
+} // namespace detail
+
+/** A set of user defined units, custom commodities, and unit string caches separate from the process
+wide ones
+@details conversions given a context use only the state of that context, so contexts used on different
+threads share no mutable state.  A context can be used from multiple threads at once in the same way as the
+process wide state.  The member functions mirror the free functions which act on the process wide state
+*/
+class context {
+  public:
+    context();
+    ~context();
+    context(const context&) = delete;
+    context& operator=(const context&) = delete;
+
+    /// Add a custom unit to be included in string processing with this context
+    void addUserDefinedUnit(std::string name, precise_unit un);
+    /// Add a set of custom units to be included in string processing with this context
+    void addUserDefinedUnits(const std::vector<std::pair<std::string, precise_unit>>& units);
+    /// Clear all user defined units of this context
+    void clearUserDefinedUnits();
+    /// Turn off the ability to add custom units to this context
+    void disableUserDefinedUnits();
+    /// Enable the ability to add custom units to this context
+    void enableUserDefinedUnits();
+
+    /// add a custom commodity to this context
+    void addCustomCommodity(std::string comm, uint32_t code);
+    /// clear all custom commodities of this context
+    void clearCustomCommodities();
+    /// Turn off the ability to add custom commodities to this context
+    void disableCustomCommodities();
+    /// Enable the ability to add custom commodities to this context
+    void enableCustomCommodities();
+    /// Set the maximum number of names of unrecognized commodity strings stored in this context
+    void setCommodityNameCapacity(size_t capacity);
+    /// Get the number of custom commodities and stored names of this context
+    commodity_statistics getCommodityStatistics() const;
+
+    /// Turn on the unit string cache of this context
+    void enableUnitStringCache(size_t capacity = 4096);
+    /// Turn off the unit string cache of this context and release its memory
+    void disableUnitStringCache();
+    /// Remove all entries in the unit string cache of this context
+    void clearUnitStringCache();
+    /// Get the hit and miss counts and size of the unit string cache of this context
+    cache_statistics getUnitStringCacheStatistics() const;
+
+    /// Turn on the unit format cache of this context
+    void enableUnitFormatCache(size_t capacity = 1024);
+    /// Turn off the unit format cache of this context and release its memory
+    void disableUnitFormatCache();
+    /// Remove all entries in the unit format cache of this context
+    void clearUnitFormatCache();
+    /// Get the hit and miss counts and size of the unit format cache of this context
+    cache_statistics getUnitFormatCacheStatistics() const;
+
+    /** use a context for all the conversions on the calling thread while the scope exists
+    @details scopes can be nested,  the previously active context is restored when a scope ends.  The
+    context must outlive the scope*/
+    class scope {
+      public:
+        explicit scope(const context& ctx);
+        ~scope();
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+
+      private:
+        const context* previous;
+    };
+    /// get the context in use on the calling thread,  nullptr if the process wide state is in use
+    static const context* current();
+
+  private:
+    static std::shared_ptr<detail::commodityContextData> newCommodityData();
+
+    std::shared_ptr<detail::unitContextData> unitData;
+    std::shared_ptr<detail::commodityContextData> commodityData;
+
+    friend uint32_t getCommodity(std::string comm);
+    friend std::string getCommodityName(uint32_t commodity);
+};
+
+/// Generate a precise unit object from a string representation of it using the state of a context
+inline precise_unit
+    unit_from_string(std::string unit_string, const context& ctx, uint32_t match_flags = 0)
+{
+    context::scope active(ctx);
+    return unit_from_string(std::move(unit_string), match_flags);
+}
+
+/// Generate a measurement from a string using the state of a context
+inline precision_measurement measurement_from_string(
+    std::string measurement_string,
+    const context& ctx,
+    uint32_t match_flags = 0)
+{
+    context::scope active(ctx);
+    return measurement_from_string(std::move(measurement_string), match_flags);
+}
+
+/// Generate a string representation of the unit using the state of a context
+inline std::string to_string(precise_unit units, const context& ctx, uint32_t match_flags = 0)
+{
+    context::scope active(ctx);
+    return to_string(units, match_flags);
+}
+
+/// Convert a precision measurement to a string using the state of a context
+inline std::string
+    to_string(precision_measurement measure, const context& ctx, uint32_t match_flags = 0)
+{
+    context::scope active(ctx);
+    return to_string(measure, match_flags);
+}
+
+/// get the code to use for a particular commodity using the state of a context
+inline uint32_t getCommodity(std::string comm, const context& ctx)
+{
+    context::scope active(ctx);
+    return getCommodity(std::move(comm));
+}
+
+/// get the name of a commodity code using the state of a context
+inline std::string getCommodityName(uint32_t commodity, const context& ctx)
+{
+    context::scope active(ctx);
+    return getCommodityName(commodity);
+}
+
+/// the stages of unit_from_string that can produce a unit
+enum class parse_stage : uint8_t {
+    unmatched = 0, //!< no stage produced a valid unit
+    cached, //!< the result came from the unit string cache
+    quick_match, //!< the string matched a unit directly
+    clean_string, //!< the string matched after cleaning
+    custom_unit, //!< a custom unit or commodity in braces
+    leading_number, //!< a number leading the unit
+    operator_split, //!< a sequence of units separated by '*' and '/'
+    power, //!< a unit raised to a power
+    commodity, //!< a unit with a commodity
+    si_prefix, //!< an SI prefix character on a unit
+    capitalization, //!< a unit with the first letter changed to lower case
+    word_prefix, //!< an SI prefix word on a unit
+    alternate_spelling, //!< brackets, dashes, plurals, or case changes
+    per_rewrite, //!< "per" replaced with a division
+    word_modifiers, //!< modifier words such as square or cubic
+    locality_modifiers, //!< international or regional modifiers
+    partitioning, //!< the string split into several units,  this must stay the last stage
+};
+/// the number of entries in parse_stage
+constexpr size_t parse_stage_count{static_cast<size_t>(parse_stage::partitioning) + 1};
+
+/// the outcome and cost of one call to unit_from_string
+struct parse_trace {
+    std::string unit_string; //!< the string that was converted
+    parse_stage stage{parse_stage::unmatched}; //!< the stage that produced the result
+    uint32_t calls{0}; //!< the number of passes through the conversion process
+    uint32_t max_depth{0}; //!< the deepest nesting of the conversion process
+    uint64_t probes{0}; //!< the number of lookups in the unit tables
+    uint64_t nanoseconds{0}; //!< the elapsed time of the call
+    bool budget_exceeded{false}; //!< the call was cut off by the parse budget
+};
+
+/// totals for all the calls resolved by one stage
+struct parse_stage_statistics {
+    uint64_t count{0}; //!< the number of calls
+    uint64_t probes{0}; //!< the number of lookups in the unit tables
+    uint64_t nanoseconds{0}; //!< the total elapsed time
+    uint64_t max_nanoseconds{0}; //!< the elapsed time of the slowest call
+};
+
+/// aggregated instrumentation of unit_from_string
+struct parse_statistics {
+    uint64_t calls{0}; //!< the number of calls recorded
+    std::vector<parse_stage_statistics> stages; //!< totals indexed by parse_stage
+    std::vector<parse_trace> slowest; //!< the slowest calls, slowest first
+};
+
+/** Turn on instrumentation of unit_from_string
+@details each call records the stage that produced the result, the depth of the conversion, the number
+of lookups in the unit tables and the elapsed time.  Enabling the instrumentation clears any previous
+data
+@param slowestCount the number of the slowest calls to keep
+*/
+void enableParseInstrumentation(size_t slowestCount = 16);
+/// Turn off instrumentation of unit_from_string,  the data gathered so far is kept
+void disableParseInstrumentation();
+/// Clear all the instrumentation data
+void clearParseInstrumentation();
+/// Get the trace of the most recent instrumented call to unit_from_string on the calling thread
+parse_trace getLastParseTrace();
+/// Get the aggregated instrumentation data
+parse_statistics getParseStatistics();
+/// Get the name of a parse stage
+const char* parseStageName(parse_stage stage);
+/// Generate a readable report of the instrumentation data
+std::string parseInstrumentationReport();
+
+/// limits on the work done by a single call to unit_from_string or measurement_from_string,  0 is no limit
+struct parse_budget {
+    uint64_t max_steps{0}; //!< the number of passes through the conversion process
+    uint64_t max_probes{0}; //!< the number of lookups in the unit tables
+    uint64_t max_nanoseconds{0}; //!< the elapsed time
+};
+
+/** Set the default budget applied to calls to unit_from_string and measurement_from_string
+@details a call that exhausts the budget stops and returns precise::invalid,  the step and probe limits
+are deterministic for a given string and set of flags.  Results cut off by the budget are not cached.
+The budget is process wide,  the overloads taking a parse_budget use their own budget instead
+*/
+void setParseBudget(const parse_budget& budget);
+/// Get the current parse budget
+parse_budget getParseBudget();
+/// Remove all limits on the work done by a conversion
+void clearParseBudget();
+/** Check if the most recent conversion on the calling thread was cut off by the parse budget
+@details a conversion is also cut off after a number of passes proportional to the length of its string
+whether or not a budget is set,  that limit is reported here as well
+*/
+bool parseBudgetExceeded();
+
+/** Generate a precise unit object from a string with a budget for this call only
+@details the budget replaces the one set with setParseBudget for this call,  so calls on different
+threads or from different parts of a program can use different limits
+@param unit_string the string to convert
+@param budget the limits on the work done by the conversion,  a default budget has no limits
+@param match_flags see /ref unit_conversion_flags to control the matching process somewhat
+@return a precise unit corresponding to the string,  an error unit if no match was found or the budget
+was exhausted
+*/
+precise_unit
+    unit_from_string(std::string unit_string, const parse_budget& budget, uint32_t match_flags = 0);
+
+/// Generate a measurement from a string with a budget for this call only
+precision_measurement measurement_from_string(
+    std::string measurement_string,
+    const parse_budget& budget,
+    uint32_t match_flags = 0);
+
 #define EXTRA_UNIT_STANDARDS
 // Some specific unit code standards
 #ifdef EXTRA_UNIT_STANDARDS
@@ -1042,6 +2010,8 @@ namespace detail {
     namespace testing {
         // generate a number from a number sequence
         double testLeadingNumber(const std::string& test, size_t& index);
+        // check that the code replacements made in a single pass match making them one after another
+        bool testCodeReplacements(const std::string& test);
     } // namespace testing
 } // namespace detail
 